@@ -0,0 +1,221 @@
+/* Frontend throughput benchmark
+ * Emits quads, lines and triangles at increasing counts per frame through the
+ * null backend and prints the cost of the frontend alone as CSV.
+ * The bulk rows (quads, lines, triangles) draw the same primitives with one call,
+ * so their checksum matches the one of the single primitive rows.
+ * The sprites row draws the quads as instances, a sprite counts as 4 vertices.
+ * The circles row draws small markers, their vertices depend on the radius.
+ * The beziers row draws node graph wires (uvDrawLineBezier) between the same points.
+ * The polyline row draws a single polyline through all the points.
+ * Build every file with UV_BACKEND_NULL defined, e.g.
+ *     cc -O2 -DUV_BACKEND_NULL -Isrc -Ilibs/sokol bench/uv_bench.c src/ulivo.c src/backend/uv_backend_null.c -lm
+ * With unchanged every frame after the first is skipped by the backend, so only the
+ * cost of hashing is left and the checksum stays empty.
+ * With transform everything is drawn rotated around the centre of the window.
+ * With sdf the circles are a single instance each (uv_options_t.sdf_shapes).
+ * usage: uv_bench [frames] [arena] [deferred] [unchanged] [transform] [sdf]
+ */
+
+// sokol_time needs clock_gettime
+#define _POSIX_C_SOURCE 199309L
+
+#include "ulivo.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define SOKOL_TIME_IMPL
+#include <sokol_time.h>
+
+#ifndef UV_BACKEND_NULL
+#error "the benchmark needs the null backend, build with UV_BACKEND_NULL defined"
+#endif
+
+typedef enum {
+    BENCH_QUAD,
+    BENCH_LINE,
+    BENCH_TRIANGLE,
+    BENCH_QUADS,
+    BENCH_LINES,
+    BENCH_TRIANGLES,
+    BENCH_SPRITES,
+    BENCH_CIRCLES,
+    BENCH_BEZIERS,
+    BENCH_POLYLINE,
+    BENCH__COUNT,
+} bench_prim_e;
+
+typedef struct {
+    vec2 a, b, c;
+    colour_t colour;
+} bench_params_t;
+
+static const char *prim_names[BENCH__COUNT] = { "quad", "line", "triangle", "quads", "lines", "triangles", "sprites", "circles", "beziers", "polyline" };
+static const u32 prim_counts[] = { 10000, 100000, 1000000 };
+
+static uv_quad_t *bulk_quads = NULL;
+static uv_line_t *bulk_lines = NULL;
+static uv_triangle_t *bulk_triangles = NULL;
+static uv_sprite_t *bulk_sprites = NULL;
+static vec2 *bulk_points = NULL;
+static bool bench_transform = false;
+
+static u32 rng_state = 0x2545f491;
+
+static float benchRandom(float max) {
+    rng_state ^= rng_state << 13;
+    rng_state ^= rng_state >> 17;
+    rng_state ^= rng_state << 5;
+    return (float)(rng_state & 0xffffff) / (float)0xffffff * max;
+}
+
+static void benchEmit(bench_prim_e prim, const bench_params_t *params, u32 count) {
+    if (bench_transform) {
+        uvTranslate(v2(640.f, 360.f));
+        uvRotate(0.1f);
+        uvTranslate(v2(-640.f, -360.f));
+    }
+
+    switch (prim) {
+        case BENCH_QUAD:
+            for (u32 i = 0; i < count; ++i) {
+                uvDrawQuad(params[i].a, params[i].b, params[i].colour);
+            }
+            break;
+        case BENCH_LINE:
+            for (u32 i = 0; i < count; ++i) {
+                uvDrawLine(params[i].a, params[i].b, params[i].c.x, params[i].colour);
+            }
+            break;
+        case BENCH_TRIANGLE:
+            for (u32 i = 0; i < count; ++i) {
+                uvDrawTriangle(params[i].a, params[i].b, params[i].c, params[i].colour);
+            }
+            break;
+        case BENCH_QUADS:
+            uvDrawQuads(bulk_quads, count);
+            break;
+        case BENCH_LINES:
+            uvDrawLines(bulk_lines, count);
+            break;
+        case BENCH_TRIANGLES:
+            uvDrawTriangles(bulk_triangles, count);
+            break;
+        case BENCH_SPRITES:
+            uvDrawSprites(bulk_sprites, count);
+            break;
+        case BENCH_CIRCLES:
+            for (u32 i = 0; i < count; ++i) {
+                uvDrawCircle(params[i].a, params[i].c.x - params[i].a.x, params[i].colour);
+            }
+            break;
+        case BENCH_BEZIERS:
+            for (u32 i = 0; i < count; ++i) {
+                uvDrawLineBezier(params[i].a, params[i].b, 2.f, params[i].colour);
+            }
+            break;
+        case BENCH_POLYLINE:
+            uvDrawPolyline(bulk_points, count, 2.f, params[0].colour, UV_LINE_JOIN_MITER, UV_LINE_CAP_BUTT);
+            break;
+        default:
+            break;
+    }
+}
+
+int main(int argc, char **argv) {
+    int frames = argc > 1 ? atoi(argv[1]) : 10;
+    if (frames <= 0) frames = 10;
+
+    uv_options_t options = {0};
+    for (int i = 2; i < argc; ++i) {
+        if (strcmp(argv[i], "arena") == 0)    options.frame_arena = true;
+        if (strcmp(argv[i], "deferred") == 0) options.deferred = true;
+        if (strcmp(argv[i], "unchanged") == 0) options.skip_unchanged = true;
+        if (strcmp(argv[i], "transform") == 0) bench_transform = true;
+        if (strcmp(argv[i], "sdf") == 0)       options.sdf_shapes = true;
+    }
+
+    stm_setup();
+    uvCreateWindow("ulivo bench", 1280, 720, &options);
+
+    u32 max_count = prim_counts[sizeof(prim_counts) / sizeof(*prim_counts) - 1];
+    bench_params_t *params = malloc(sizeof(bench_params_t) * max_count);
+    bulk_quads = malloc(sizeof(uv_quad_t) * max_count);
+    bulk_lines = malloc(sizeof(uv_line_t) * max_count);
+    bulk_triangles = malloc(sizeof(uv_triangle_t) * max_count);
+    bulk_sprites = malloc(sizeof(uv_sprite_t) * max_count);
+    bulk_points = malloc(sizeof(vec2) * max_count);
+    if (!params || !bulk_quads || !bulk_lines || !bulk_triangles || !bulk_sprites || !bulk_points) {
+        fprintf(stderr, "couldn't allocate parameters for %u primitives\n", max_count);
+        return 1;
+    }
+
+    for (u32 i = 0; i < max_count; ++i) {
+        vec2 p = v2(benchRandom(1280.f), benchRandom(720.f));
+        params[i] = (bench_params_t){
+            .a = p,
+            .b = v2(p.x + 1.f + benchRandom(32.f), p.y + 1.f + benchRandom(32.f)),
+            .c = v2(p.x + 1.f + benchRandom(32.f), p.y),
+            .colour = v4(benchRandom(1.f), benchRandom(1.f), benchRandom(1.f), 1.f),
+        };
+
+        const bench_params_t *pr = &params[i];
+        bulk_quads[i] = (uv_quad_t){ pr->a, pr->b, pr->colour };
+        bulk_lines[i] = (uv_line_t){ pr->a, pr->b, pr->c.x, pr->colour };
+        bulk_triangles[i] = (uv_triangle_t){ pr->a, pr->b, pr->c, pr->colour };
+        bulk_sprites[i] = (uv_sprite_t){ pr->a, pr->b, 0.f, v4(0, 0, 1, 1), pr->colour };
+        bulk_points[i] = pr->a;
+    }
+
+    printf("primitive,count,frames,ns_per_prim,vertices_per_sec,bytes_per_frame,checksum\n");
+
+    for (int prim = 0; prim < BENCH__COUNT; ++prim) {
+        for (u32 c = 0; c < sizeof(prim_counts) / sizeof(*prim_counts); ++c) {
+            u32 count = prim_counts[c];
+
+            // warm up, so the draw list has already grown to its final size
+            uvNullResetStats();
+            uvIsOpen();
+            benchEmit(prim, params, count);
+            uvEndFrame();
+            uv_null_stats_t warm = uvNullGetStats();
+
+            uvNullResetStats();
+            u64 emit_ticks = 0;
+
+            for (int f = 0; f < frames; ++f) {
+                uvIsOpen();
+                u64 start = stm_now();
+                benchEmit(prim, params, count);
+                emit_ticks += stm_since(start);
+                uvEndFrame();
+            }
+
+            uv_null_stats_t stats = uvNullGetStats();
+            // every frame is the same as the warm up one, which is never skipped
+            u64 vertices = (warm.vertices + warm.instances * 4) * stats.frames;
+            double emit_ns = stm_ns(emit_ticks);
+            double emit_sec = stm_sec(emit_ticks);
+
+            printf(
+                "%s,%u,%d,%.3f,%.0f,%llu,%016llx\n",
+                prim_names[prim],
+                count,
+                frames,
+                emit_ns / ((double)count * frames),
+                emit_sec > 0.0 ? (double)vertices / emit_sec : 0.0,
+                (unsigned long long)warm.bytes,
+                (unsigned long long)stats.checksum
+            );
+        }
+    }
+
+    free(params);
+    free(bulk_quads);
+    free(bulk_lines);
+    free(bulk_triangles);
+    free(bulk_sprites);
+    free(bulk_points);
+    uvCleanup();
+}
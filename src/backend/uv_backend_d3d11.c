@@ -1,10 +1,14 @@
 #define ULIVO_BACKEND_DATA
 #include "../ulivo.h"
 
+#ifdef UV_BACKEND_D3D11
+
 #include <initguid.h>
 #include <d3d11.h>
+#include <d3dcompiler.h>
 
 #include <string.h>
+#include <stdlib.h>
 #include <assert.h>
 
 #ifndef DONT_USE_TLOG
@@ -27,94 +31,179 @@ static void traceSetFatalCallback(on_fatal_cb_f cb, void *userdata);
 #endif
 
 #pragma comment(lib, "d3d11.lib")
+#pragma comment(lib, "d3dcompiler.lib")
 
 #define SAFE_RELEASE(p) if(p) { (p)->lpVtbl->Release(p); (p) = NULL; }
 
 static void fatalCallBack(const char *msg, void *udata) {}
 
-static void d3d11LogMessages(void);
-static bool d3d11Init(void);
-static void d3d11UpdateVtxBuf(uv_vertex_t *vertices, uint32_t count);
-static void d3d11UpdateIdxBuf(uv_index_t *indices, uint32_t count);
-
-static vec2i win_size = { 0, 0 };
-
-static ID3D11Device           *device = NULL;
-static ID3D11DeviceContext    *context = NULL;
-static ID3D11Debug            *debugdev = NULL;
-static ID3D11InfoQueue        *infodev = NULL;
-static IDXGISwapChain         *swapchain = NULL;
-static ID3D11RasterizerState  *rasterizer_state = NULL;
-static ID3D11RenderTargetView *back_buffer_rtv = NULL;
-
-static ID3D11Buffer *vertex_buf = NULL;
-static ID3D11Buffer *index_buf = NULL;
-static uint32_t vertex_count = 0;
-static uint32_t index_count = 0;
-
-static ID3D11VertexShader *vertex_shader = NULL;
-static ID3D11PixelShader *pixel_shader = NULL;
-static ID3D11InputLayout *input_layout = NULL;
-static ID3D11SamplerState *sampler_state = NULL;
-static ID3D11Buffer *vertex_cbuf = NULL;
-static ID3D11Texture2D *default_texture = NULL;
-static ID3D11ShaderResourceView *default_texture_srv = NULL;
-static const uint8_t vs_data[1040];
-static const uint8_t ps_data[744];
-
-void uv__backend_init_gfx(void) {
+
+enum {
+    D3D11_BATCH_VERTICES,
+    D3D11_BATCH_INSTANCES,
+    D3D11_BATCH_MESHES,
+};
+
+typedef struct {
+    ID3D11Buffer *vertices;
+    ID3D11Buffer *indices;
+    DXGI_FORMAT idx_format;
+    UINT idx_count;
+} d3d11_mesh_t;
+
+static const uv_mesh_draw_t identity_draw = {
+    .transform = { 1, 0, 0, 0, 1, 0 },
+    .uv = { 0, 0, 1, 1 },
+    .tint = { 1, 1, 1, 1 },
+};
+
+// everything of one gfx, every context has its own device and swapchain
+typedef struct {
+    vec2i win_size;
+
+    ID3D11Device *device;
+    ID3D11DeviceContext *context;
+    ID3D11Debug *debugdev;
+    ID3D11InfoQueue *infodev;
+    IDXGISwapChain *swapchain;
+    ID3D11RasterizerState *rasterizer_state;
+    ID3D11BlendState *blend_state;
+    ID3D11RenderTargetView *back_buffer_rtv;
+    // render texture set with uv__backend_set_target and its view, otherwise the back buffer
+    bool has_target;
+    ID3D11RenderTargetView *target_rtv;
+    vec2i target_size;
+
+    // staging copies of the back buffer for uv__backend_read_pixels, made right before it's
+    // presented. readback_next is the slot + 1 of the next copy, or 0
+    ID3D11Texture2D *readback[UV_READBACK_SLOTS];
+    D3D11_MAPPED_SUBRESOURCE readback_map[UV_READBACK_SLOTS];
+    bool readback_mapped[UV_READBACK_SLOTS];
+    u32 readback_next;
+
+    ID3D11Buffer *vertex_buf;
+    ID3D11Buffer *index_buf;
+    ID3D11Buffer *instance_buf;
+    uint32_t vertex_count;
+    uint32_t index_bytes;
+    uint32_t instance_count;
+
+    ID3D11VertexShader *vertex_shader;
+    ID3D11PixelShader *pixel_shader;
+    ID3D11InputLayout *input_layout;
+    ID3D11VertexShader *sprite_shader;
+    ID3D11PixelShader *sprite_pixel_shader;
+    ID3D11InputLayout *sprite_layout;
+    ID3D11SamplerState *sampler_state;
+    ID3D11Buffer *vertex_cbuf;
+    ID3D11Buffer *draw_cbuf;
+    ID3D11Texture2D *default_texture;
+    ID3D11ShaderResourceView *default_texture_srv;
+} d3d11_gfx_t;
+
+static void d3d11LogMessages(d3d11_gfx_t *gfx);
+static bool d3d11Init(d3d11_gfx_t *gfx, HWND hwnd);
+static void d3d11UpdateVtxBuf(d3d11_gfx_t *gfx, uv_vertex_t *vertices, uint32_t count);
+static void d3d11UpdateIdxBuf(d3d11_gfx_t *gfx, void *indices, uint32_t bytes);
+static void d3d11UpdateInstBuf(d3d11_gfx_t *gfx, uv_instance_t *instances, uint32_t count);
+static ID3DBlob *d3d11CompileShader(const char *entry, const char *target);
+static void d3d11SetDrawConstants(d3d11_gfx_t *gfx, const uv_mesh_draw_t *draw);
+static void d3d11CopyBackBuffer(d3d11_gfx_t *gfx, u32 slot);
+
+// from the win32 backend
+extern HWND uv__win32_get_hwnd(void *win_data);
+
+void *uv__backend_init_gfx(void *win_data, int width, int height) {
 	traceSetFatalCallback(fatalCallBack, NULL);
 
-    if (!d3d11Init()) {
-        d3d11LogMessages();
+    d3d11_gfx_t *gfx = calloc(1, sizeof(d3d11_gfx_t));
+    if (!gfx) {
+        fatal("couldn't allocate DirectX renderer");
+        return NULL;
+    }
+    gfx->win_size = (vec2i){ width, height };
+
+    if (!d3d11Init(gfx, uv__win32_get_hwnd(win_data))) {
+        d3d11LogMessages(gfx);
         fatal("couldn't init DirectX");
     }
+
+    return gfx;
+}
+
+u32 uv__backend_get_caps(void *gfx) {
+    return UV_CAP_INDEX_U16 | UV_CAP_INDEX_U32 | UV_CAP_INSTANCES | UV_CAP_SCISSOR | UV_CAP_SHAPES | UV_CAP_RENDER_TEXTURES | UV_CAP_READBACK;
 }
 
-void uv__backend_cleanup_gfx(void) {
+void uv__backend_cleanup_gfx(void *gfx_data) {
+    d3d11_gfx_t *gfx = gfx_data;
+    if (!gfx) return;
+
 #ifndef NDEBUG
 		// we need this as it doesn't report memory leak otherwise
-		infodev->lpVtbl->PushEmptyStorageFilter(infodev);
+		gfx->infodev->lpVtbl->PushEmptyStorageFilter(gfx->infodev);
 #endif
-        SAFE_RELEASE(default_texture_srv);
-        SAFE_RELEASE(default_texture);
-        SAFE_RELEASE(back_buffer_rtv);
-        SAFE_RELEASE(vertex_cbuf);
-        SAFE_RELEASE(input_layout);
-        SAFE_RELEASE(vertex_shader);
-        SAFE_RELEASE(pixel_shader);
-        SAFE_RELEASE(input_layout);
-        SAFE_RELEASE(sampler_state);
-        SAFE_RELEASE(vertex_cbuf);
+        SAFE_RELEASE(gfx->default_texture_srv);
+        SAFE_RELEASE(gfx->default_texture);
+        SAFE_RELEASE(gfx->back_buffer_rtv);
+        SAFE_RELEASE(gfx->target_rtv);
+        for (u32 i = 0; i < UV_READBACK_SLOTS; ++i) {
+            if (gfx->readback_mapped[i]) {
+                gfx->context->lpVtbl->Unmap(gfx->context, (ID3D11Resource *)gfx->readback[i], 0);
+            }
+            SAFE_RELEASE(gfx->readback[i]);
+        }
+        SAFE_RELEASE(gfx->vertex_cbuf);
+        SAFE_RELEASE(gfx->input_layout);
+        SAFE_RELEASE(gfx->vertex_shader);
+        SAFE_RELEASE(gfx->pixel_shader);
+        SAFE_RELEASE(gfx->sprite_shader);
+        SAFE_RELEASE(gfx->sprite_pixel_shader);
+        SAFE_RELEASE(gfx->sprite_layout);
+        SAFE_RELEASE(gfx->vertex_buf);
+        SAFE_RELEASE(gfx->index_buf);
+        SAFE_RELEASE(gfx->instance_buf);
+        SAFE_RELEASE(gfx->input_layout);
+        SAFE_RELEASE(gfx->sampler_state);
+        SAFE_RELEASE(gfx->vertex_cbuf);
+        SAFE_RELEASE(gfx->draw_cbuf);
 
 		// SAFE_RELEASE(depth_stencil_state);
-		SAFE_RELEASE(rasterizer_state);
-		SAFE_RELEASE(swapchain);
-		SAFE_RELEASE(context);
-		SAFE_RELEASE(device);
+		SAFE_RELEASE(gfx->rasterizer_state);
+		SAFE_RELEASE(gfx->blend_state);
+		SAFE_RELEASE(gfx->swapchain);
+		SAFE_RELEASE(gfx->context);
+		SAFE_RELEASE(gfx->device);
 #ifndef NDEBUG
-		SAFE_RELEASE(infodev);
-		debugdev->lpVtbl->ReportLiveDeviceObjects(debugdev, D3D11_RLDO_DETAIL | D3D11_RLDO_IGNORE_INTERNAL);
-		SAFE_RELEASE(debugdev);
+		SAFE_RELEASE(gfx->infodev);
+		gfx->debugdev->lpVtbl->ReportLiveDeviceObjects(gfx->debugdev, D3D11_RLDO_DETAIL | D3D11_RLDO_IGNORE_INTERNAL);
+		SAFE_RELEASE(gfx->debugdev);
 #endif
+        free(gfx);
 }
 
-void uv__backend_draw(colour_t clear_colour, uv_drawdata_t *data) {
+void uv__backend_draw(void *gfx_data, colour_t clear_colour, uv_drawdata_t *data) {
+	d3d11_gfx_t *gfx = gfx_data;
 	if (!data) return;
+    // the render texture's view couldn't be made
+    if (gfx->has_target && !gfx->target_rtv) return;
+
+    ID3D11RenderTargetView *rtv = gfx->has_target ? gfx->target_rtv : gfx->back_buffer_rtv;
+    vec2i size = gfx->has_target ? gfx->target_size : gfx->win_size;
 
 	// update projection matrix
 	
 	D3D11_MAPPED_SUBRESOURCE mapped_resource;
-	HRESULT hr = context->lpVtbl->Map(context, (ID3D11Resource *)vertex_cbuf, 0, D3D11_MAP_WRITE_DISCARD, 0, &mapped_resource);
+	HRESULT hr = gfx->context->lpVtbl->Map(gfx->context, (ID3D11Resource *)gfx->vertex_cbuf, 0, D3D11_MAP_WRITE_DISCARD, 0, &mapped_resource);
 	if (FAILED(hr)) {
 		err("couldn't bind vertex constant buffer");
 		return;
 	}
 
 	float l = 0.f;               // left
-	float r = (float)win_size.x; // right
+	float r = (float)size.x;     // right
 	float t = 0.f;               // top
-	float b = (float)win_size.y; // bottom
+	float b = (float)size.y;     // bottom
 	float n = 0.f;               // z near
 	float f = 100.f;             // z far
 
@@ -127,88 +216,168 @@ void uv__backend_draw(colour_t clear_colour, uv_drawdata_t *data) {
 
     memcpy(mapped_resource.pData, proj_mat, sizeof(proj_mat));
 
-	context->lpVtbl->Unmap(context, (ID3D11Resource *)vertex_cbuf, 0);
+	gfx->context->lpVtbl->Unmap(gfx->context, (ID3D11Resource *)gfx->vertex_cbuf, 0);
 
-    // update vertex and index buffers
-    
-    d3d11UpdateVtxBuf(data->vertices, data->vtx_count);
-    d3d11UpdateIdxBuf(data->indices, data->idx_count);
+    // everything but meshes is drawn as is
+    d3d11SetDrawConstants(gfx, &identity_draw);
 
     // setup
 
 	D3D11_VIEWPORT viewport = {
-		.Width    = (float)win_size.x,
-		.Height   = (float)win_size.y,
+		.Width    = (float)size.x,
+		.Height   = (float)size.y,
 		.TopLeftX = 0.f,
 		.TopLeftY = 0.f,
 		.MinDepth = 0.f,
 		.MaxDepth = 1.f,
 	};
 
-	context->lpVtbl->RSSetViewports(context, 1, &viewport);
-	context->lpVtbl->RSSetState(context, rasterizer_state);
-	context->lpVtbl->OMSetRenderTargets(context,  1, &back_buffer_rtv, NULL);
-
-    context->lpVtbl->VSSetShader(context, vertex_shader, NULL, 0);
-    context->lpVtbl->PSSetShader(context, pixel_shader,  NULL, 0);
+	gfx->context->lpVtbl->RSSetViewports(gfx->context, 1, &viewport);
+	gfx->context->lpVtbl->RSSetState(gfx->context, gfx->rasterizer_state);
+	gfx->context->lpVtbl->OMSetRenderTargets(gfx->context,  1, &rtv, NULL);
+	gfx->context->lpVtbl->OMSetBlendState(gfx->context, gfx->blend_state, NULL, 0xffffffff);
 
-    context->lpVtbl->VSSetConstantBuffers(context, 0, 1, &vertex_cbuf);
-    context->lpVtbl->PSSetSamplers(context, 0, 1, &sampler_state);
+    ID3D11Buffer *cbufs[] = { gfx->vertex_cbuf, gfx->draw_cbuf };
+    gfx->context->lpVtbl->VSSetConstantBuffers(gfx->context, 0, 2, cbufs);
+    gfx->context->lpVtbl->PSSetSamplers(gfx->context, 0, 1, &gfx->sampler_state);
 
     UINT vtx_stride = sizeof(uv_vertex_t);
+    UINT inst_stride = sizeof(uv_instance_t);
     UINT vtx_offset = 0;
 
-	context->lpVtbl->IASetInputLayout(context, input_layout);
-	context->lpVtbl->IASetVertexBuffers(context, 0, 1, &vertex_buf, &vtx_stride, &vtx_offset);
-    context->lpVtbl->IASetIndexBuffer(context, index_buf, DXGI_FORMAT_R32_UINT, 0);
-    context->lpVtbl->IASetPrimitiveTopology(context, D3D11_PRIMITIVE_TOPOLOGY_TRIANGLELIST);
+    gfx->context->lpVtbl->IASetPrimitiveTopology(gfx->context, D3D11_PRIMITIVE_TOPOLOGY_TRIANGLELIST);
 
-	context->lpVtbl->ClearRenderTargetView(context, back_buffer_rtv, (float*)&clear_colour);
+	gfx->context->lpVtbl->ClearRenderTargetView(gfx->context, rtv, (float*)&clear_colour);
 
-    // draw each batch
-    for (uint32_t i = 0; i < data->batch_count; ++i) {
-        uv_batch_t *batch = &data->batches[i];
-        ID3D11ShaderResourceView *texture = (ID3D11ShaderResourceView *)batch->texture;
-        if (!texture) texture = default_texture_srv;
+    // the buffers only hold one uv_drawdata_t, so they can be kept only when there's a single one.
+    // the frame is still drawn again, the back buffer is undefined after a flip model present
+    bool keep_buffers = data->unchanged && !data->next;
+
+    for (uv_drawdata_t *list = data; list; list = list->next) {
+        // update vertex, index and instance buffers, they might get recreated so they are bound after
+        if (list->vtx_count && !keep_buffers) {
+            d3d11UpdateVtxBuf(gfx, list->vertices, list->vtx_count);
+        }
+        if (list->idx_count && !keep_buffers) {
+            d3d11UpdateIdxBuf(gfx, list->indices, list->index_size * list->idx_count);
+        }
+        if (list->inst_count && !keep_buffers) {
+            d3d11UpdateInstBuf(gfx, list->instances, list->inst_count);
+        }
+
+        DXGI_FORMAT idx_format = list->index_size == sizeof(u16) ? DXGI_FORMAT_R16_UINT : DXGI_FORMAT_R32_UINT;
+
+        // the state is bound by the first batch, then only when the kind of batch changes
+        int bound = -1;
+
+        // draw each batch
+        for (uint32_t i = 0; i < list->batch_count; ++i) {
+            uv_batch_t *batch = &list->batches[i];
+            ID3D11ShaderResourceView *textures[UV_TEXTURE_SLOTS];
+            int kind = batch->inst_count ? D3D11_BATCH_INSTANCES : batch->mesh_count ? D3D11_BATCH_MESHES : D3D11_BATCH_VERTICES;
+
+            // every batch has a clip rect, it's the whole window unless one was pushed
+            D3D11_RECT scissor = { batch->clip.x, batch->clip.y, batch->clip.z, batch->clip.w };
+            gfx->context->lpVtbl->RSSetScissorRects(gfx->context, 1, &scissor);
+
+            if (kind != bound) {
+                bound = kind;
+                switch (kind) {
+                    case D3D11_BATCH_VERTICES:
+                        gfx->context->lpVtbl->IASetInputLayout(gfx->context, gfx->input_layout);
+                        gfx->context->lpVtbl->IASetVertexBuffers(gfx->context, 0, 1, &gfx->vertex_buf, &vtx_stride, &vtx_offset);
+                        gfx->context->lpVtbl->IASetIndexBuffer(gfx->context, gfx->index_buf, idx_format, 0);
+                        gfx->context->lpVtbl->VSSetShader(gfx->context, gfx->vertex_shader, NULL, 0);
+                        gfx->context->lpVtbl->PSSetShader(gfx->context, gfx->pixel_shader, NULL, 0);
+                        break;
+                    case D3D11_BATCH_INSTANCES:
+                        gfx->context->lpVtbl->IASetInputLayout(gfx->context, gfx->sprite_layout);
+                        gfx->context->lpVtbl->IASetVertexBuffers(gfx->context, 0, 1, &gfx->instance_buf, &inst_stride, &vtx_offset);
+                        gfx->context->lpVtbl->VSSetShader(gfx->context, gfx->sprite_shader, NULL, 0);
+                        gfx->context->lpVtbl->PSSetShader(gfx->context, gfx->sprite_pixel_shader, NULL, 0);
+                        break;
+                    case D3D11_BATCH_MESHES:
+                        // the buffers are bound for each draw by uv__backend_draw_mesh
+                        gfx->context->lpVtbl->IASetInputLayout(gfx->context, gfx->input_layout);
+                        gfx->context->lpVtbl->VSSetShader(gfx->context, gfx->vertex_shader, NULL, 0);
+                        gfx->context->lpVtbl->PSSetShader(gfx->context, gfx->pixel_shader, NULL, 0);
+                        break;
+                }
+            }
 
-        context->lpVtbl->PSSetShaderResources(context, 0, 1, &texture);
-        context->lpVtbl->DrawIndexed(context, batch->idx_count, batch->idx_start, 0);
+            // unused slots get the default texture too, so nothing is left bound from before
+            for (uint32_t s = 0; s < UV_TEXTURE_SLOTS; ++s) {
+#if UV_TEXTURE_SLOTS > 1
+                texture_t texture = s < batch->texture_count ? batch->textures[s] : 0;
+#else
+                texture_t texture = batch->texture;
+#endif
+                textures[s] = texture ? (ID3D11ShaderResourceView *)texture : gfx->default_texture_srv;
+            }
+
+            gfx->context->lpVtbl->PSSetShaderResources(gfx->context, 0, UV_TEXTURE_SLOTS, textures);
+            switch (kind) {
+                case D3D11_BATCH_VERTICES:
+                    gfx->context->lpVtbl->DrawIndexed(gfx->context, batch->idx_count, batch->idx_start, batch->vtx_start);
+                    break;
+                case D3D11_BATCH_INSTANCES:
+                    // the quad's corners come from SV_VertexID
+                    gfx->context->lpVtbl->DrawInstanced(gfx->context, 6, batch->inst_count, 0, batch->inst_start);
+                    break;
+                case D3D11_BATCH_MESHES:
+                    uv__backend_draw_mesh(gfx, list, batch);
+                    break;
+            }
+        }
     }
 
     // cleanup
-    ID3D11ShaderResourceView *null_srv = NULL;
-    context->lpVtbl->PSSetShaderResources(context, 0, 1, &null_srv);
-    context->lpVtbl->VSSetShader(context, NULL, NULL, 0);
-    context->lpVtbl->PSSetShader(context, NULL, NULL, 0);
+    ID3D11ShaderResourceView *null_srv[UV_TEXTURE_SLOTS] = {0};
+    gfx->context->lpVtbl->PSSetShaderResources(gfx->context, 0, UV_TEXTURE_SLOTS, null_srv);
+    gfx->context->lpVtbl->VSSetShader(gfx->context, NULL, NULL, 0);
+    gfx->context->lpVtbl->PSSetShader(gfx->context, NULL, NULL, 0);
+
+    // a render texture is sampled by the next draws, so it can't stay bound as a target
+    if (gfx->has_target) {
+        gfx->context->lpVtbl->OMSetRenderTargets(gfx->context, 0, NULL, NULL);
+        return;
+    }
 
-	swapchain->lpVtbl->Present(swapchain, 1, 0);
+    // with a flip model swapchain the back buffer can't be read after it's presented
+    if (gfx->readback_next) {
+        d3d11CopyBackBuffer(gfx, gfx->readback_next - 1);
+        gfx->readback_next = 0;
+    }
+
+	gfx->swapchain->lpVtbl->Present(gfx->swapchain, 1, 0);
 }
 
-void uv__backend_resize_gfx(int new_width, int new_height) {
-    win_size = (vec2i){ new_width, new_height };
+void uv__backend_resize_gfx(void *gfx_data, int new_width, int new_height) {
+    d3d11_gfx_t *gfx = gfx_data;
+    gfx->win_size = (vec2i){ new_width, new_height };
 	
-	if (swapchain) {
+	if (gfx->swapchain) {
 		//swapchain->lpVtbl->ResizeBuffers(swapchain, 0, (UINT)new_width, (UINT)new_height, DXGI_FORMAT_UNKNOWN, 0);
 	}
 }
 
 // == STATIC FUNCTIONS ========================================================
 
-static bool d3d11Init(void) {
+static bool d3d11Init(d3d11_gfx_t *gfx, HWND hwnd) {
     // -- create device, context, and swap chain --
 
     DXGI_SWAP_CHAIN_DESC sd = {
         .BufferCount = 2,
         .BufferDesc = {
-            .Width  = (UINT)win_size.x,
-            .Height = (UINT)win_size.y,
+            .Width  = (UINT)gfx->win_size.x,
+            .Height = (UINT)gfx->win_size.y,
             .Format = DXGI_FORMAT_R8G8B8A8_UNORM,
             .RefreshRate.Numerator = 60,
             .RefreshRate.Denominator = 1,
         },
         .Flags = DXGI_SWAP_CHAIN_FLAG_ALLOW_MODE_SWITCH,
         .BufferUsage = DXGI_USAGE_RENDER_TARGET_OUTPUT,
-        .OutputWindow = GetActiveWindow(),
+        .OutputWindow = hwnd,
         .SampleDesc = {
             .Count = 1,
             .Quality = 0
@@ -232,10 +401,10 @@ static bool d3d11Init(void) {
         2,
         D3D11_SDK_VERSION,
         &sd,
-        &swapchain,
-        &device,
+        &gfx->swapchain,
+        &gfx->device,
         &featureLevel,
-        &context
+        &gfx->context
     );
     if (FAILED(hr)) {
         err("couldn't create device");
@@ -246,9 +415,9 @@ static bool d3d11Init(void) {
 
 #ifndef NDEBUG
     
-    hr = device->lpVtbl->QueryInterface(device, &IID_ID3D11Debug, &debugdev);
+    hr = gfx->device->lpVtbl->QueryInterface(gfx->device, &IID_ID3D11Debug, &gfx->debugdev);
     assert(SUCCEEDED(hr));
-    hr = device->lpVtbl->QueryInterface(device, &IID_ID3D11InfoQueue, &infodev);
+    hr = gfx->device->lpVtbl->QueryInterface(gfx->device, &IID_ID3D11InfoQueue, &gfx->infodev);
     assert(SUCCEEDED(hr));
 #endif
 
@@ -256,38 +425,145 @@ static bool d3d11Init(void) {
 
 	D3D11_RASTERIZER_DESC rast_desc = {
 		.FillMode = D3D11_FILL_SOLID,
-		.CullMode = D3D11_CULL_BACK,
-		.FrontCounterClockwise = TRUE
+		// mirroring transforms flip the winding
+		.CullMode = D3D11_CULL_NONE,
+		.FrontCounterClockwise = TRUE,
+		.ScissorEnable = TRUE,
 	};
-	device->lpVtbl->CreateRasterizerState(device, &rast_desc, &rasterizer_state);
+	gfx->device->lpVtbl->CreateRasterizerState(gfx->device, &rast_desc, &gfx->rasterizer_state);
+
+    // -- create blend state --
+
+    // alpha blending, the same as softBlend. the edges of the shapes need it
+    D3D11_BLEND_DESC blend_desc = {
+        .RenderTarget[0] = {
+            .BlendEnable = TRUE,
+            .SrcBlend = D3D11_BLEND_SRC_ALPHA,
+            .DestBlend = D3D11_BLEND_INV_SRC_ALPHA,
+            .BlendOp = D3D11_BLEND_OP_ADD,
+            .SrcBlendAlpha = D3D11_BLEND_ONE,
+            .DestBlendAlpha = D3D11_BLEND_INV_SRC_ALPHA,
+            .BlendOpAlpha = D3D11_BLEND_OP_ADD,
+            .RenderTargetWriteMask = D3D11_COLOR_WRITE_ENABLE_ALL,
+        },
+    };
+    hr = gfx->device->lpVtbl->CreateBlendState(gfx->device, &blend_desc, &gfx->blend_state);
+    if (FAILED(hr)) {
+        err("couldn't create blend state");
+        return false;
+    }
 
     // -- create shaders --
 
-    hr = device->lpVtbl->CreateVertexShader(device, vs_data, sizeof(vs_data), NULL, &vertex_shader);
+    // shader model 4 so they also run on the 10_0 feature level
+    ID3DBlob *vs_code = d3d11CompileShader("VS", "vs_4_0");
+    ID3DBlob *ps_code = d3d11CompileShader("PS", "ps_4_0");
+    if (!vs_code || !ps_code) {
+        SAFE_RELEASE(vs_code);
+        SAFE_RELEASE(ps_code);
+        return false;
+    }
+
+    const void *vs_data = vs_code->lpVtbl->GetBufferPointer(vs_code);
+    SIZE_T vs_size = vs_code->lpVtbl->GetBufferSize(vs_code);
+
+    hr = gfx->device->lpVtbl->CreateVertexShader(gfx->device, vs_data, vs_size, NULL, &gfx->vertex_shader);
     if (FAILED(hr)) {
         err("couldn't create vertex shader: %d", hr);
+        SAFE_RELEASE(vs_code);
+        SAFE_RELEASE(ps_code);
         return false;
     }
 
-    hr = device->lpVtbl->CreatePixelShader(device, ps_data, sizeof(ps_data), NULL, &pixel_shader);
+    hr = gfx->device->lpVtbl->CreatePixelShader(gfx->device, ps_code->lpVtbl->GetBufferPointer(ps_code), ps_code->lpVtbl->GetBufferSize(ps_code), NULL, &gfx->pixel_shader);
+    SAFE_RELEASE(ps_code);
     if (FAILED(hr)) {
         err("couldn't create pixel shader");
+        SAFE_RELEASE(vs_code);
         return false;
     }
 
     // -- create input layout --
 
+    // packed formats are unpacked to floats by the input assembler, the shader doesn't change
+#ifdef UV_PACKED_UV
+    DXGI_FORMAT uv_format = DXGI_FORMAT_R16G16_UNORM;
+#else
+    DXGI_FORMAT uv_format = DXGI_FORMAT_R32G32_FLOAT;
+#endif
+#ifdef UV_PACKED_VERTEX
+    DXGI_FORMAT col_format = DXGI_FORMAT_R8G8B8A8_UNORM;
+#else
+    DXGI_FORMAT col_format = DXGI_FORMAT_R32G32B32A32_FLOAT;
+#endif
+
     D3D11_INPUT_ELEMENT_DESC in_layout[] = {
-        { "POSITION", 0, DXGI_FORMAT_R32G32_FLOAT,       0, D3D11_APPEND_ALIGNED_ELEMENT, D3D11_INPUT_PER_VERTEX_DATA, 0 },
-        { "TEXCOORD", 0, DXGI_FORMAT_R32G32_FLOAT,       0, D3D11_APPEND_ALIGNED_ELEMENT, D3D11_INPUT_PER_VERTEX_DATA, 0 },
-        { "COLOR",    0, DXGI_FORMAT_R32G32B32A32_FLOAT, 0, D3D11_APPEND_ALIGNED_ELEMENT, D3D11_INPUT_PER_VERTEX_DATA, 0 },
+        { "POSITION", 0, DXGI_FORMAT_R32G32_FLOAT, 0, D3D11_APPEND_ALIGNED_ELEMENT, D3D11_INPUT_PER_VERTEX_DATA, 0 },
+        { "TEXCOORD", 0, uv_format,                0, D3D11_APPEND_ALIGNED_ELEMENT, D3D11_INPUT_PER_VERTEX_DATA, 0 },
+        { "COLOR",    0, col_format,               0, D3D11_APPEND_ALIGNED_ELEMENT, D3D11_INPUT_PER_VERTEX_DATA, 0 },
+#if UV_TEXTURE_SLOTS > 1
+        { "SLOT",     0, DXGI_FORMAT_R32_UINT,     0, D3D11_APPEND_ALIGNED_ELEMENT, D3D11_INPUT_PER_VERTEX_DATA, 0 },
+#endif
     };
 
-    hr = device->lpVtbl->CreateInputLayout(device, in_layout, sizeof(in_layout)/sizeof(*in_layout), vs_data, sizeof(vs_data), &input_layout);
+    hr = gfx->device->lpVtbl->CreateInputLayout(gfx->device, in_layout, sizeof(in_layout)/sizeof(*in_layout), vs_data, vs_size, &gfx->input_layout);
+    SAFE_RELEASE(vs_code);
     if (FAILED(hr)) {
         err("couldn't create input layout");
         return false;
     }
+
+    // -- create sprite shader and layout --
+
+    ID3DBlob *sprite_code = d3d11CompileShader("VS_Sprite", "vs_4_0");
+    if (!sprite_code) {
+        return false;
+    }
+
+    const void *sprite_data = sprite_code->lpVtbl->GetBufferPointer(sprite_code);
+    SIZE_T sprite_size = sprite_code->lpVtbl->GetBufferSize(sprite_code);
+
+    hr = gfx->device->lpVtbl->CreateVertexShader(gfx->device, sprite_data, sprite_size, NULL, &gfx->sprite_shader);
+    if (FAILED(hr)) {
+        err("couldn't create sprite shader: %d", hr);
+        SAFE_RELEASE(sprite_code);
+        return false;
+    }
+
+    ID3DBlob *sprite_ps_code = d3d11CompileShader("PS_Sprite", "ps_4_0");
+    if (!sprite_ps_code) {
+        SAFE_RELEASE(sprite_code);
+        return false;
+    }
+
+    hr = gfx->device->lpVtbl->CreatePixelShader(gfx->device, sprite_ps_code->lpVtbl->GetBufferPointer(sprite_ps_code), sprite_ps_code->lpVtbl->GetBufferSize(sprite_ps_code), NULL, &gfx->sprite_pixel_shader);
+    SAFE_RELEASE(sprite_ps_code);
+    if (FAILED(hr)) {
+        err("couldn't create sprite pixel shader");
+        SAFE_RELEASE(sprite_code);
+        return false;
+    }
+
+    // one uv_instance_t per instance, there is no per vertex data
+    D3D11_INPUT_ELEMENT_DESC sprite_in_layout[] = {
+        { "POSITION", 0, DXGI_FORMAT_R32G32_FLOAT,       0, D3D11_APPEND_ALIGNED_ELEMENT, D3D11_INPUT_PER_INSTANCE_DATA, 1 },
+        { "SIZE",     0, DXGI_FORMAT_R32G32_FLOAT,       0, D3D11_APPEND_ALIGNED_ELEMENT, D3D11_INPUT_PER_INSTANCE_DATA, 1 },
+        { "ROTATION", 0, DXGI_FORMAT_R32_FLOAT,          0, D3D11_APPEND_ALIGNED_ELEMENT, D3D11_INPUT_PER_INSTANCE_DATA, 1 },
+        { "SHAPE",    0, DXGI_FORMAT_R32G32_FLOAT,       0, D3D11_APPEND_ALIGNED_ELEMENT, D3D11_INPUT_PER_INSTANCE_DATA, 1 },
+        { "TEXCOORD", 0, DXGI_FORMAT_R32G32B32A32_FLOAT, 0, D3D11_APPEND_ALIGNED_ELEMENT, D3D11_INPUT_PER_INSTANCE_DATA, 1 },
+        { "COLOR",    0, col_format,                     0, D3D11_APPEND_ALIGNED_ELEMENT, D3D11_INPUT_PER_INSTANCE_DATA, 1 },
+#if UV_TEXTURE_SLOTS > 1
+        { "SLOT",     0, DXGI_FORMAT_R32_UINT,           0, D3D11_APPEND_ALIGNED_ELEMENT, D3D11_INPUT_PER_INSTANCE_DATA, 1 },
+#endif
+    };
+
+    hr = gfx->device->lpVtbl->CreateInputLayout(gfx->device, sprite_in_layout, sizeof(sprite_in_layout)/sizeof(*sprite_in_layout), sprite_data, sprite_size, &gfx->sprite_layout);
+    SAFE_RELEASE(sprite_code);
+    if (FAILED(hr)) {
+        err("couldn't create sprite input layout");
+        return false;
+    }
+
     // -- create texture sampler --
 
     D3D11_SAMPLER_DESC sampler_desc = {
@@ -297,7 +573,7 @@ static bool d3d11Init(void) {
         .AddressW = D3D11_TEXTURE_ADDRESS_WRAP
     };
 
-    hr = device->lpVtbl->CreateSamplerState(device, &sampler_desc, &sampler_state);
+    hr = gfx->device->lpVtbl->CreateSamplerState(gfx->device, &sampler_desc, &gfx->sampler_state);
     if (FAILED(hr)) {
         err("couldn't create sampler state");
         return false;
@@ -312,22 +588,30 @@ static bool d3d11Init(void) {
         .CPUAccessFlags = D3D11_CPU_ACCESS_WRITE,
     };
 
-    hr = device->lpVtbl->CreateBuffer(device, &cbuf_desc, NULL, &vertex_cbuf);
+    hr = gfx->device->lpVtbl->CreateBuffer(gfx->device, &cbuf_desc, NULL, &gfx->vertex_cbuf);
     if (FAILED(hr)) {
         err("couldn't create vertex's constant buffer");
         return false;
     }
 
+    // transform, uv rectangle and tint of the mesh being drawn, same size as the matrix
+
+    hr = gfx->device->lpVtbl->CreateBuffer(gfx->device, &cbuf_desc, NULL, &gfx->draw_cbuf);
+    if (FAILED(hr)) {
+        err("couldn't create draw constant buffer");
+        return false;
+    }
+
 	// -- create render target view --
 
 	ID3D11Texture2D *back_buffer = NULL;
-	hr = swapchain->lpVtbl->GetBuffer(swapchain, 0, &IID_ID3D11Texture2D, (void**)(&back_buffer)); 
+	hr = gfx->swapchain->lpVtbl->GetBuffer(gfx->swapchain, 0, &IID_ID3D11Texture2D, (void**)(&back_buffer)); 
 	if (FAILED(hr)) {
 		err("failed to get the backbuffer");
 		return false;
 	}
 
-	hr = device->lpVtbl->CreateRenderTargetView(device, (ID3D11Resource *)back_buffer, NULL, &back_buffer_rtv); 
+	hr = gfx->device->lpVtbl->CreateRenderTargetView(gfx->device, (ID3D11Resource *)back_buffer, NULL, &gfx->back_buffer_rtv); 
 	if (FAILED(hr)) {
 		err("failed to get render target view of the backbuffer");
 		return false;
@@ -353,7 +637,7 @@ static bool d3d11Init(void) {
 		.SysMemPitch = sizeof(default_pixel) 
 	};
 
-	hr = device->lpVtbl->CreateTexture2D(device, &default_desc, &default_data, &default_texture);
+	hr = gfx->device->lpVtbl->CreateTexture2D(gfx->device, &default_desc, &default_data, &gfx->default_texture);
 	if (FAILED(hr)) {
 		err("failed to create default white texture");
 		return false;
@@ -365,7 +649,7 @@ static bool d3d11Init(void) {
 		.Texture2D.MipLevels = 1,
 	};
 
-	hr = device->lpVtbl->CreateShaderResourceView(device, (ID3D11Resource*)default_texture, &srv_desc, &default_texture_srv);
+	hr = gfx->device->lpVtbl->CreateShaderResourceView(gfx->device, (ID3D11Resource*)gfx->default_texture, &srv_desc, &gfx->default_texture_srv);
 	if (FAILED(hr)) {
 		err("failed to create default shader resource view");
 		return false;
@@ -374,7 +658,8 @@ static bool d3d11Init(void) {
     return true;
 }
 
-texture_t uv__backend_load_texture(const image_t *image) {
+texture_t uv__backend_load_texture(void *gfx_data, const image_t *image) {
+	d3d11_gfx_t *gfx = gfx_data;
 	if (!image || !image->data) return 0;
 
 	ID3D11Texture2D *texture = NULL;
@@ -398,7 +683,7 @@ texture_t uv__backend_load_texture(const image_t *image) {
 		.SysMemPitch = image->width * 4
 	};
 
-	HRESULT hr = device->lpVtbl->CreateTexture2D(device, &tex_desc, &data_desc, &texture);
+	HRESULT hr = gfx->device->lpVtbl->CreateTexture2D(gfx->device, &tex_desc, &data_desc, &texture);
 	// HRESULT hr = device->lpVtbl->CreateTexture2D(device, &tex_desc, NULL, &texture);
 	if (FAILED(hr)) {
 		err("failed to create texture");
@@ -411,7 +696,9 @@ texture_t uv__backend_load_texture(const image_t *image) {
 		.Texture2D.MipLevels = 1,
 	};
 
-	hr = device->lpVtbl->CreateShaderResourceView(device, (ID3D11Resource*)texture, &srv_desc, &srv);
+	hr = gfx->device->lpVtbl->CreateShaderResourceView(gfx->device, (ID3D11Resource*)texture, &srv_desc, &srv);
+	// the view keeps its own reference to the texture
+	SAFE_RELEASE(texture);
 	if (FAILED(hr)) {
 		err("failed to create texture's shader resource view");
 		return 0;
@@ -420,21 +707,291 @@ texture_t uv__backend_load_texture(const image_t *image) {
 	return (uintptr_t)srv;
 }
 
-void uv__backend_free_texture(texture_t texture) {
-	// TODO
+texture_t uv__backend_create_render_texture(void *gfx_data, u32 width, u32 height) {
+	d3d11_gfx_t *gfx = gfx_data;
+
+	ID3D11Texture2D *texture = NULL;
+	ID3D11ShaderResourceView *srv = NULL;
+	ID3D11RenderTargetView *rtv = NULL;
+
+	D3D11_TEXTURE2D_DESC tex_desc = {
+		.Width            = width,
+		.Height           = height,
+		.MipLevels        = 1,
+		.ArraySize        = 1,
+		.Format           = DXGI_FORMAT_R8G8B8A8_UNORM,
+		.Usage            = D3D11_USAGE_DEFAULT,
+		.BindFlags        = D3D11_BIND_SHADER_RESOURCE | D3D11_BIND_RENDER_TARGET,
+		.SampleDesc.Count = 1,
+	};
+
+	HRESULT hr = gfx->device->lpVtbl->CreateTexture2D(gfx->device, &tex_desc, NULL, &texture);
+	if (FAILED(hr)) {
+		err("failed to create render texture");
+		return 0;
+	}
+
+	D3D11_SHADER_RESOURCE_VIEW_DESC srv_desc = {
+		.Format = tex_desc.Format,
+		.ViewDimension = D3D11_SRV_DIMENSION_TEXTURE2D,
+		.Texture2D.MipLevels = 1,
+	};
+
+	hr = gfx->device->lpVtbl->CreateShaderResourceView(gfx->device, (ID3D11Resource*)texture, &srv_desc, &srv);
+	if (FAILED(hr)) {
+		err("failed to create render texture's shader resource view");
+		SAFE_RELEASE(texture);
+		return 0;
+	}
+
+	// it starts transparent like the soft backend's, the contents of a new texture are undefined
+	hr = gfx->device->lpVtbl->CreateRenderTargetView(gfx->device, (ID3D11Resource*)texture, NULL, &rtv);
+	if (SUCCEEDED(hr)) {
+		float transparent[4] = { 0, 0, 0, 0 };
+		gfx->context->lpVtbl->ClearRenderTargetView(gfx->context, rtv, transparent);
+		SAFE_RELEASE(rtv);
+	}
+
+	// the view keeps its own reference to the texture
+	SAFE_RELEASE(texture);
+	return (uintptr_t)srv;
+}
+
+// the target view is made from the texture of the shader resource view every time, so render
+// textures are freed like the others
+void uv__backend_set_target(void *gfx_data, texture_t target) {
+	d3d11_gfx_t *gfx = gfx_data;
+	SAFE_RELEASE(gfx->target_rtv);
+
+	ID3D11ShaderResourceView *srv = (ID3D11ShaderResourceView *)target;
+	gfx->has_target = srv != NULL;
+	if (!srv) return;
+
+	ID3D11Resource *resource = NULL;
+	srv->lpVtbl->GetResource(srv, &resource);
+
+	D3D11_TEXTURE2D_DESC desc;
+	((ID3D11Texture2D *)resource)->lpVtbl->GetDesc((ID3D11Texture2D *)resource, &desc);
+	gfx->target_size = (vec2i){ (int)desc.Width, (int)desc.Height };
+
+	HRESULT hr = gfx->device->lpVtbl->CreateRenderTargetView(gfx->device, resource, NULL, &gfx->target_rtv);
+	if (FAILED(hr)) {
+		err("failed to create render texture's target view");
+	}
+	SAFE_RELEASE(resource);
+}
+
+void uv__backend_read_pixels(void *gfx_data, u32 slot) {
+	d3d11_gfx_t *gfx = gfx_data;
+	gfx->readback_next = slot + 1;
+}
+
+bool uv__backend_poll_pixels(void *gfx_data, u32 slot, u32 *width, u32 *height) {
+	d3d11_gfx_t *gfx = gfx_data;
+	ID3D11Texture2D *staging = gfx->readback[slot];
+	if (!staging) return false;
+
+	if (!gfx->readback_mapped[slot]) {
+		// only maps it once the gpu is done with the copy, instead of waiting for it
+		HRESULT hr = gfx->context->lpVtbl->Map(gfx->context, (ID3D11Resource *)staging, 0, D3D11_MAP_READ, D3D11_MAP_FLAG_DO_NOT_WAIT, &gfx->readback_map[slot]);
+		if (hr == DXGI_ERROR_WAS_STILL_DRAWING) return false;
+		if (FAILED(hr)) {
+			err("couldn't map readback buffer");
+			return false;
+		}
+		gfx->readback_mapped[slot] = true;
+	}
+
+	D3D11_TEXTURE2D_DESC desc;
+	staging->lpVtbl->GetDesc(staging, &desc);
+	*width = desc.Width;
+	*height = desc.Height;
+	return true;
+}
+
+void uv__backend_get_pixels(void *gfx_data, u32 slot, u8 *pixels) {
+	d3d11_gfx_t *gfx = gfx_data;
+	ID3D11Texture2D *staging = gfx->readback[slot];
+	if (!staging || !gfx->readback_mapped[slot]) return;
+
+	D3D11_TEXTURE2D_DESC desc;
+	staging->lpVtbl->GetDesc(staging, &desc);
+
+	// the rows of the mapped texture can be padded
+	const D3D11_MAPPED_SUBRESOURCE *map = &gfx->readback_map[slot];
+	for (UINT y = 0; y < desc.Height; ++y) {
+		memcpy(pixels + y * desc.Width * 4, (const u8 *)map->pData + y * map->RowPitch, desc.Width * 4);
+	}
+
+	gfx->context->lpVtbl->Unmap(gfx->context, (ID3D11Resource *)staging, 0);
+	gfx->readback_mapped[slot] = false;
+}
+
+void uv__backend_free_texture(void *gfx, texture_t texture) {
+	ID3D11ShaderResourceView *srv = (ID3D11ShaderResourceView *)texture;
+	SAFE_RELEASE(srv);
+}
+
+void uv__backend_update_texture(void *gfx_data, texture_t texture, const image_t *image, u32 x, u32 y) {
+	d3d11_gfx_t *gfx = gfx_data;
+	ID3D11ShaderResourceView *srv = (ID3D11ShaderResourceView *)texture;
+	if (!srv || !image || !image->data) return;
+
+	ID3D11Resource *resource = NULL;
+	srv->lpVtbl->GetResource(srv, &resource);
+
+	D3D11_BOX box = {
+		.left   = x,
+		.top    = y,
+		.front  = 0,
+		.right  = x + image->width,
+		.bottom = y + image->height,
+		.back   = 1,
+	};
+
+	gfx->context->lpVtbl->UpdateSubresource(gfx->context, resource, 0, &box, image->data, image->width * 4, 0);
+	SAFE_RELEASE(resource);
+}
+
+mesh_t uv__backend_create_mesh(void *gfx_data, const uv_vertex_t *vertices, u32 vtx_count, const void *indices, u32 index_size, u32 idx_count) {
+    d3d11_gfx_t *gfx = gfx_data;
+    d3d11_mesh_t *mesh = calloc(1, sizeof(d3d11_mesh_t));
+    if (!mesh) {
+        err("failed to allocate mesh");
+        return 0;
+    }
+
+    D3D11_BUFFER_DESC vtx_desc = {
+        .Usage = D3D11_USAGE_IMMUTABLE,
+        .ByteWidth = sizeof(uv_vertex_t) * vtx_count,
+        .BindFlags = D3D11_BIND_VERTEX_BUFFER,
+    };
+    D3D11_SUBRESOURCE_DATA vtx_data = { .pSysMem = vertices };
+
+    D3D11_BUFFER_DESC idx_desc = {
+        .Usage = D3D11_USAGE_IMMUTABLE,
+        .ByteWidth = index_size * idx_count,
+        .BindFlags = D3D11_BIND_INDEX_BUFFER,
+    };
+    D3D11_SUBRESOURCE_DATA idx_data = { .pSysMem = indices };
+
+    HRESULT hr = gfx->device->lpVtbl->CreateBuffer(gfx->device, &vtx_desc, &vtx_data, &mesh->vertices);
+    if (SUCCEEDED(hr)) {
+        hr = gfx->device->lpVtbl->CreateBuffer(gfx->device, &idx_desc, &idx_data, &mesh->indices);
+    }
+    if (FAILED(hr)) {
+        err("failed to create mesh buffers");
+        uv__backend_free_mesh(gfx, (mesh_t)mesh);
+        return 0;
+    }
+
+    mesh->idx_format = index_size == sizeof(u16) ? DXGI_FORMAT_R16_UINT : DXGI_FORMAT_R32_UINT;
+    mesh->idx_count = idx_count;
+
+    return (mesh_t)mesh;
+}
+
+void uv__backend_draw_mesh(void *gfx_data, const uv_drawdata_t *list, const uv_batch_t *batch) {
+    d3d11_gfx_t *gfx = gfx_data;
+    UINT stride = sizeof(uv_vertex_t);
+    UINT offset = 0;
+
+    for (u32 i = 0; i < batch->mesh_count; ++i) {
+        const uv_mesh_draw_t *draw = &list->meshes[batch->mesh_start + i];
+        d3d11_mesh_t *mesh = (d3d11_mesh_t *)draw->mesh;
+
+        d3d11SetDrawConstants(gfx, draw);
+        gfx->context->lpVtbl->IASetVertexBuffers(gfx->context, 0, 1, &mesh->vertices, &stride, &offset);
+        gfx->context->lpVtbl->IASetIndexBuffer(gfx->context, mesh->indices, mesh->idx_format, 0);
+        gfx->context->lpVtbl->DrawIndexed(gfx->context, mesh->idx_count, 0, 0);
+    }
+
+    d3d11SetDrawConstants(gfx, &identity_draw);
+}
+
+void uv__backend_free_mesh(void *gfx, mesh_t mesh) {
+    d3d11_mesh_t *m = (d3d11_mesh_t *)mesh;
+    if (!m) return;
+    SAFE_RELEASE(m->vertices);
+    SAFE_RELEASE(m->indices);
+    free(m);
 }
 
 // == STATIC FUNCTIONS ========================================================
 
-static void d3d11LogMessages(void) {
-    UINT64 message_count = infodev->lpVtbl->GetNumStoredMessages(infodev);
+static void d3d11SetDrawConstants(d3d11_gfx_t *gfx, const uv_mesh_draw_t *draw) {
+    D3D11_MAPPED_SUBRESOURCE mapped = {0};
+    HRESULT hr = gfx->context->lpVtbl->Map(gfx->context, (ID3D11Resource *)gfx->draw_cbuf, 0, D3D11_MAP_WRITE_DISCARD, 0, &mapped);
+    if (FAILED(hr)) {
+        err("couldn't map draw constant buffer");
+        return;
+    }
+
+    const float *m = draw->transform;
+    float constants[16] = {
+        m[0], m[1], m[2], 0,
+        m[3], m[4], m[5], 0,
+        draw->uv.x, draw->uv.y, draw->uv.z, draw->uv.w,
+        draw->tint.r, draw->tint.g, draw->tint.b, draw->tint.a,
+    };
+
+    memcpy(mapped.pData, constants, sizeof(constants));
+    gfx->context->lpVtbl->Unmap(gfx->context, (ID3D11Resource *)gfx->draw_cbuf, 0);
+}
+
+// the staging texture of the slot is made again when the back buffer's size changes
+static void d3d11CopyBackBuffer(d3d11_gfx_t *gfx, u32 slot) {
+	ID3D11Resource *back_buffer = NULL;
+	gfx->back_buffer_rtv->lpVtbl->GetResource(gfx->back_buffer_rtv, &back_buffer);
+
+	D3D11_TEXTURE2D_DESC desc;
+	((ID3D11Texture2D *)back_buffer)->lpVtbl->GetDesc((ID3D11Texture2D *)back_buffer, &desc);
+
+	ID3D11Texture2D *staging = gfx->readback[slot];
+	if (staging) {
+		D3D11_TEXTURE2D_DESC old;
+		staging->lpVtbl->GetDesc(staging, &old);
+		if (old.Width != desc.Width || old.Height != desc.Height) {
+			if (gfx->readback_mapped[slot]) {
+				gfx->context->lpVtbl->Unmap(gfx->context, (ID3D11Resource *)staging, 0);
+				gfx->readback_mapped[slot] = false;
+			}
+			SAFE_RELEASE(gfx->readback[slot]);
+		}
+	}
+
+	if (!gfx->readback[slot]) {
+		D3D11_TEXTURE2D_DESC staging_desc = {
+			.Width            = desc.Width,
+			.Height           = desc.Height,
+			.MipLevels        = 1,
+			.ArraySize        = 1,
+			.Format           = desc.Format,
+			.Usage            = D3D11_USAGE_STAGING,
+			.CPUAccessFlags   = D3D11_CPU_ACCESS_READ,
+			.SampleDesc.Count = 1,
+		};
+		HRESULT hr = gfx->device->lpVtbl->CreateTexture2D(gfx->device, &staging_desc, NULL, &gfx->readback[slot]);
+		if (FAILED(hr)) {
+			err("failed to create readback buffer");
+			SAFE_RELEASE(back_buffer);
+			return;
+		}
+	}
+
+	gfx->context->lpVtbl->CopyResource(gfx->context, (ID3D11Resource *)gfx->readback[slot], back_buffer);
+	SAFE_RELEASE(back_buffer);
+}
+
+static void d3d11LogMessages(d3d11_gfx_t *gfx) {
+    UINT64 message_count = gfx->infodev->lpVtbl->GetNumStoredMessages(gfx->infodev);
 
     D3D11_MESSAGE* msg = NULL;
     SIZE_T old_size = 0;
 
     for (UINT64 i = 0; i < message_count; ++i) {
         SIZE_T msg_size = 0;
-        infodev->lpVtbl->GetMessage(infodev, i, NULL, &msg_size);
+        gfx->infodev->lpVtbl->GetMessage(gfx->infodev, i, NULL, &msg_size);
         
         if (msg_size > old_size) {
             D3D11_MESSAGE *new_msg = realloc(msg, msg_size);
@@ -443,7 +1000,7 @@ static void d3d11LogMessages(void) {
             }
             msg = new_msg;
         }
-        infodev->lpVtbl->GetMessage(infodev, i, msg, &msg_size);
+        gfx->infodev->lpVtbl->GetMessage(gfx->infodev, i, msg, &msg_size);
         assert(msg);
         
         switch (msg->Severity) {
@@ -456,13 +1013,13 @@ static void d3d11LogMessages(void) {
     }
 
     free(msg);
-    infodev->lpVtbl->ClearStoredMessages(infodev);
+    gfx->infodev->lpVtbl->ClearStoredMessages(gfx->infodev);
 }
 
-static void d3d11UpdateVtxBuf(uv_vertex_t *vertices, uint32_t count) {
-    if (!vertex_buf || vertex_count < count) {
-        SAFE_RELEASE(vertex_buf);
-        vertex_count = count;
+static void d3d11UpdateVtxBuf(d3d11_gfx_t *gfx, uv_vertex_t *vertices, uint32_t count) {
+    if (!gfx->vertex_buf || gfx->vertex_count < count) {
+        SAFE_RELEASE(gfx->vertex_buf);
+        gfx->vertex_count = count;
 
         D3D11_BUFFER_DESC desc = {
             .Usage = D3D11_USAGE_DYNAMIC,
@@ -477,10 +1034,10 @@ static void d3d11UpdateVtxBuf(uv_vertex_t *vertices, uint32_t count) {
             D3D11_SUBRESOURCE_DATA init_data = {
                 .pSysMem = vertices
             };
-            hr = device->lpVtbl->CreateBuffer(device, &desc, &init_data, &vertex_buf);
+            hr = gfx->device->lpVtbl->CreateBuffer(gfx->device, &desc, &init_data, &gfx->vertex_buf);
         }
         else {
-            hr = device->lpVtbl->CreateBuffer(device, &desc, NULL, &vertex_buf);
+            hr = gfx->device->lpVtbl->CreateBuffer(gfx->device, &desc, NULL, &gfx->vertex_buf);
         }
 
         if (FAILED(hr)) {
@@ -489,10 +1046,10 @@ static void d3d11UpdateVtxBuf(uv_vertex_t *vertices, uint32_t count) {
     }
     else {
         D3D11_MAPPED_SUBRESOURCE mapped = {0};
-        HRESULT hr = context->lpVtbl->Map(context, (ID3D11Resource *)vertex_buf, 0, D3D11_MAP_WRITE_DISCARD, 0, &mapped);
+        HRESULT hr = gfx->context->lpVtbl->Map(gfx->context, (ID3D11Resource *)gfx->vertex_buf, 0, D3D11_MAP_WRITE_DISCARD, 0, &mapped);
         if (SUCCEEDED(hr)) {
             memcpy(mapped.pData, vertices, sizeof(uv_vertex_t) * count);
-            context->lpVtbl->Unmap(context, (ID3D11Resource *)vertex_buf, 0);
+            gfx->context->lpVtbl->Unmap(gfx->context, (ID3D11Resource *)gfx->vertex_buf, 0);
         }
         else {
             fatal("couldn't map vertex buffer");
@@ -500,14 +1057,15 @@ static void d3d11UpdateVtxBuf(uv_vertex_t *vertices, uint32_t count) {
     }
 }
 
-static void d3d11UpdateIdxBuf(uv_index_t *indices, uint32_t count) {
-    if (!index_buf || index_count < count) {
-        SAFE_RELEASE(index_buf);
-        index_count = count;
+// the buffer is sized in bytes, so the same one is reused for u16 and u32 indices
+static void d3d11UpdateIdxBuf(d3d11_gfx_t *gfx, void *indices, uint32_t bytes) {
+    if (!gfx->index_buf || gfx->index_bytes < bytes) {
+        SAFE_RELEASE(gfx->index_buf);
+        gfx->index_bytes = bytes;
 
         D3D11_BUFFER_DESC desc = {
             .Usage = D3D11_USAGE_DYNAMIC,
-            .ByteWidth = sizeof(uv_index_t) * count,
+            .ByteWidth = bytes,
             .BindFlags = D3D11_BIND_INDEX_BUFFER,
             .CPUAccessFlags = D3D11_CPU_ACCESS_WRITE
         };
@@ -516,17 +1074,17 @@ static void d3d11UpdateIdxBuf(uv_index_t *indices, uint32_t count) {
             .pSysMem = indices
         };
 
-        HRESULT hr = device->lpVtbl->CreateBuffer(device, &desc, &init_data, &index_buf);
+        HRESULT hr = gfx->device->lpVtbl->CreateBuffer(gfx->device, &desc, &init_data, &gfx->index_buf);
         if (FAILED(hr)) {
             fatal("couldn't update index buffer");
         }
     }
     else {
         D3D11_MAPPED_SUBRESOURCE mapped = {0};
-        HRESULT hr = context->lpVtbl->Map(context, (ID3D11Resource *)index_buf, 0, D3D11_MAP_WRITE_DISCARD, 0, &mapped);
+        HRESULT hr = gfx->context->lpVtbl->Map(gfx->context, (ID3D11Resource *)gfx->index_buf, 0, D3D11_MAP_WRITE_DISCARD, 0, &mapped);
         if (SUCCEEDED(hr)) {
-            memcpy(mapped.pData, indices, sizeof(uv_index_t) * count);
-            context->lpVtbl->Unmap(context, (ID3D11Resource *)index_buf, 0);
+            memcpy(mapped.pData, indices, bytes);
+            gfx->context->lpVtbl->Unmap(gfx->context, (ID3D11Resource *)gfx->index_buf, 0);
         }
         else {
             fatal("couldn't map index buffer");
@@ -534,275 +1092,218 @@ static void d3d11UpdateIdxBuf(uv_index_t *indices, uint32_t count) {
     }
 }
 
-/***********************************************************
-struct VertexInput {
-    float2 pos : POSITION;
-    float2 uv : TEXCOORD;
-    float4 col : COLOR;
-};
+static void d3d11UpdateInstBuf(d3d11_gfx_t *gfx, uv_instance_t *instances, uint32_t count) {
+    if (!gfx->instance_buf || gfx->instance_count < count) {
+        SAFE_RELEASE(gfx->instance_buf);
+        gfx->instance_count = count;
 
-struct PixelInput {
-    float4 pos : SV_POSITION;
-    float2 uv : TEXCOORD;
-    float4 col : COLOR;
-};
+        D3D11_BUFFER_DESC desc = {
+            .Usage = D3D11_USAGE_DYNAMIC,
+            .ByteWidth = sizeof(uv_instance_t) * count,
+            .BindFlags = D3D11_BIND_VERTEX_BUFFER,
+            .CPUAccessFlags = D3D11_CPU_ACCESS_WRITE
+        };
 
-cbuffer MatrixBuffer : register(b0) {
-    matrix proj;
-};
+        D3D11_SUBRESOURCE_DATA init_data = {
+            .pSysMem = instances
+        };
 
-PixelInput VS(VertexInput input) {
-    PixelInput output;
-    output.pos = mul(float4(input.pos, 0.0, 1.0), proj);
-    output.uv  = input.uv;
-    output.col = input.col;
-    return output;
+        HRESULT hr = gfx->device->lpVtbl->CreateBuffer(gfx->device, &desc, &init_data, &gfx->instance_buf);
+        if (FAILED(hr)) {
+            fatal("couldn't update instance buffer");
+        }
+    }
+    else {
+        D3D11_MAPPED_SUBRESOURCE mapped = {0};
+        HRESULT hr = gfx->context->lpVtbl->Map(gfx->context, (ID3D11Resource *)gfx->instance_buf, 0, D3D11_MAP_WRITE_DISCARD, 0, &mapped);
+        if (SUCCEEDED(hr)) {
+            memcpy(mapped.pData, instances, sizeof(uv_instance_t) * count);
+            gfx->context->lpVtbl->Unmap(gfx->context, (ID3D11Resource *)gfx->instance_buf, 0);
+        }
+        else {
+            fatal("couldn't map instance buffer");
+        }
+    }
 }
-***********************************************************/
-static const u8 vs_data[] = { 
-	0x44, 0x58, 0x42, 0x43,   0xc9, 0x70, 0xb4, 0xd3,   
-	0x14, 0xc4, 0xef, 0x37,   0xc8, 0xc0, 0xdf, 0xa3,   
-	0x97, 0x65, 0xb7, 0xc6,   0x01, 0x00, 0x00, 0x00,   
-	0x10, 0x04, 0x00, 0x00,   0x05, 0x00, 0x00, 0x00,   
-	0x34, 0x00, 0x00, 0x00,   0x44, 0x01, 0x00, 0x00,   
-	0xb4, 0x01, 0x00, 0x00,   0x28, 0x02, 0x00, 0x00,   
-	0x74, 0x03, 0x00, 0x00,   0x52, 0x44, 0x45, 0x46,   
-	0x08, 0x01, 0x00, 0x00,   0x01, 0x00, 0x00, 0x00,   
-	0x6c, 0x00, 0x00, 0x00,   0x01, 0x00, 0x00, 0x00,   
-	0x3c, 0x00, 0x00, 0x00,   0x00, 0x05, 0xfe, 0xff,   
-	0x00, 0x01, 0x00, 0x00,   0xe0, 0x00, 0x00, 0x00,   
-	0x52, 0x44, 0x31, 0x31,   0x3c, 0x00, 0x00, 0x00,   
-	0x18, 0x00, 0x00, 0x00,   0x20, 0x00, 0x00, 0x00,   
-	0x28, 0x00, 0x00, 0x00,   0x24, 0x00, 0x00, 0x00,   
-	0x0c, 0x00, 0x00, 0x00,   0x00, 0x00, 0x00, 0x00,   
-	0x5c, 0x00, 0x00, 0x00,   0x00, 0x00, 0x00, 0x00,   
-	0x00, 0x00, 0x00, 0x00,   0x00, 0x00, 0x00, 0x00,   
-	0x00, 0x00, 0x00, 0x00,   0x00, 0x00, 0x00, 0x00,   
-	0x01, 0x00, 0x00, 0x00,   0x01, 0x00, 0x00, 0x00,   
-	0x4d, 0x61, 0x74, 0x72,   0x69, 0x78, 0x42, 0x75,   
-	0x66, 0x66, 0x65, 0x72,   0x00, 0xab, 0xab, 0xab,   
-	0x5c, 0x00, 0x00, 0x00,   0x01, 0x00, 0x00, 0x00,   
-	0x84, 0x00, 0x00, 0x00,   0x40, 0x00, 0x00, 0x00,   
-	0x00, 0x00, 0x00, 0x00,   0x00, 0x00, 0x00, 0x00,   
-	0xac, 0x00, 0x00, 0x00,   0x00, 0x00, 0x00, 0x00,   
-	0x40, 0x00, 0x00, 0x00,   0x02, 0x00, 0x00, 0x00,   
-	0xbc, 0x00, 0x00, 0x00,   0x00, 0x00, 0x00, 0x00,   
-	0xff, 0xff, 0xff, 0xff,   0x00, 0x00, 0x00, 0x00,   
-	0xff, 0xff, 0xff, 0xff,   0x00, 0x00, 0x00, 0x00,   
-	0x70, 0x72, 0x6f, 0x6a,   0x00, 0x66, 0x6c, 0x6f,   
-	0x61, 0x74, 0x34, 0x78,   0x34, 0x00, 0xab, 0xab,   
-	0x03, 0x00, 0x03, 0x00,   0x04, 0x00, 0x04, 0x00,   
-	0x00, 0x00, 0x00, 0x00,   0x00, 0x00, 0x00, 0x00,   
-	0x00, 0x00, 0x00, 0x00,   0x00, 0x00, 0x00, 0x00,   
-	0x00, 0x00, 0x00, 0x00,   0x00, 0x00, 0x00, 0x00,   
-	0xb1, 0x00, 0x00, 0x00,   0x4d, 0x69, 0x63, 0x72,   
-	0x6f, 0x73, 0x6f, 0x66,   0x74, 0x20, 0x28, 0x52,   
-	0x29, 0x20, 0x48, 0x4c,   0x53, 0x4c, 0x20, 0x53,   
-	0x68, 0x61, 0x64, 0x65,   0x72, 0x20, 0x43, 0x6f,   
-	0x6d, 0x70, 0x69, 0x6c,   0x65, 0x72, 0x20, 0x31,   
-	0x30, 0x2e, 0x31, 0x00,   0x49, 0x53, 0x47, 0x4e,   
-	0x68, 0x00, 0x00, 0x00,   0x03, 0x00, 0x00, 0x00,   
-	0x08, 0x00, 0x00, 0x00,   0x50, 0x00, 0x00, 0x00,   
-	0x00, 0x00, 0x00, 0x00,   0x00, 0x00, 0x00, 0x00,   
-	0x03, 0x00, 0x00, 0x00,   0x00, 0x00, 0x00, 0x00,   
-	0x03, 0x03, 0x00, 0x00,   0x59, 0x00, 0x00, 0x00,   
-	0x00, 0x00, 0x00, 0x00,   0x00, 0x00, 0x00, 0x00,   
-	0x03, 0x00, 0x00, 0x00,   0x01, 0x00, 0x00, 0x00,   
-	0x03, 0x03, 0x00, 0x00,   0x62, 0x00, 0x00, 0x00,   
-	0x00, 0x00, 0x00, 0x00,   0x00, 0x00, 0x00, 0x00,   
-	0x03, 0x00, 0x00, 0x00,   0x02, 0x00, 0x00, 0x00,   
-	0x0f, 0x0f, 0x00, 0x00,   0x50, 0x4f, 0x53, 0x49,   
-	0x54, 0x49, 0x4f, 0x4e,   0x00, 0x54, 0x45, 0x58,   
-	0x43, 0x4f, 0x4f, 0x52,   0x44, 0x00, 0x43, 0x4f,   
-	0x4c, 0x4f, 0x52, 0x00,   0x4f, 0x53, 0x47, 0x4e,   
-	0x6c, 0x00, 0x00, 0x00,   0x03, 0x00, 0x00, 0x00,   
-	0x08, 0x00, 0x00, 0x00,   0x50, 0x00, 0x00, 0x00,   
-	0x00, 0x00, 0x00, 0x00,   0x01, 0x00, 0x00, 0x00,   
-	0x03, 0x00, 0x00, 0x00,   0x00, 0x00, 0x00, 0x00,   
-	0x0f, 0x00, 0x00, 0x00,   0x5c, 0x00, 0x00, 0x00,   
-	0x00, 0x00, 0x00, 0x00,   0x00, 0x00, 0x00, 0x00,   
-	0x03, 0x00, 0x00, 0x00,   0x01, 0x00, 0x00, 0x00,   
-	0x03, 0x0c, 0x00, 0x00,   0x65, 0x00, 0x00, 0x00,   
-	0x00, 0x00, 0x00, 0x00,   0x00, 0x00, 0x00, 0x00,   
-	0x03, 0x00, 0x00, 0x00,   0x02, 0x00, 0x00, 0x00,   
-	0x0f, 0x00, 0x00, 0x00,   0x53, 0x56, 0x5f, 0x50,   
-	0x4f, 0x53, 0x49, 0x54,   0x49, 0x4f, 0x4e, 0x00,   
-	0x54, 0x45, 0x58, 0x43,   0x4f, 0x4f, 0x52, 0x44,   
-	0x00, 0x43, 0x4f, 0x4c,   0x4f, 0x52, 0x00, 0xab,   
-	0x53, 0x48, 0x45, 0x58,   0x44, 0x01, 0x00, 0x00,   
-	0x50, 0x00, 0x01, 0x00,   0x51, 0x00, 0x00, 0x00,   
-	0x6a, 0x08, 0x00, 0x01,   0x59, 0x00, 0x00, 0x04,   
-	0x46, 0x8e, 0x20, 0x00,   0x00, 0x00, 0x00, 0x00,   
-	0x04, 0x00, 0x00, 0x00,   0x5f, 0x00, 0x00, 0x03,   
-	0x32, 0x10, 0x10, 0x00,   0x00, 0x00, 0x00, 0x00,   
-	0x5f, 0x00, 0x00, 0x03,   0x32, 0x10, 0x10, 0x00,   
-	0x01, 0x00, 0x00, 0x00,   0x5f, 0x00, 0x00, 0x03,   
-	0xf2, 0x10, 0x10, 0x00,   0x02, 0x00, 0x00, 0x00,   
-	0x67, 0x00, 0x00, 0x04,   0xf2, 0x20, 0x10, 0x00,   
-	0x00, 0x00, 0x00, 0x00,   0x01, 0x00, 0x00, 0x00,   
-	0x65, 0x00, 0x00, 0x03,   0x32, 0x20, 0x10, 0x00,   
-	0x01, 0x00, 0x00, 0x00,   0x65, 0x00, 0x00, 0x03,   
-	0xf2, 0x20, 0x10, 0x00,   0x02, 0x00, 0x00, 0x00,   
-	0x68, 0x00, 0x00, 0x02,   0x01, 0x00, 0x00, 0x00,   
-	0x36, 0x00, 0x00, 0x05,   0x32, 0x00, 0x10, 0x00,   
-	0x00, 0x00, 0x00, 0x00,   0x46, 0x10, 0x10, 0x00,   
-	0x00, 0x00, 0x00, 0x00,   0x36, 0x00, 0x00, 0x05,   
-	0x42, 0x00, 0x10, 0x00,   0x00, 0x00, 0x00, 0x00,   
-	0x01, 0x40, 0x00, 0x00,   0x00, 0x00, 0x80, 0x3f,   
-	0x10, 0x00, 0x00, 0x08,   0x12, 0x20, 0x10, 0x00,   
-	0x00, 0x00, 0x00, 0x00,   0x46, 0x02, 0x10, 0x00,   
-	0x00, 0x00, 0x00, 0x00,   0x46, 0x83, 0x20, 0x00,   
-	0x00, 0x00, 0x00, 0x00,   0x00, 0x00, 0x00, 0x00,   
-	0x10, 0x00, 0x00, 0x08,   0x22, 0x20, 0x10, 0x00,   
-	0x00, 0x00, 0x00, 0x00,   0x46, 0x02, 0x10, 0x00,   
-	0x00, 0x00, 0x00, 0x00,   0x46, 0x83, 0x20, 0x00,   
-	0x00, 0x00, 0x00, 0x00,   0x01, 0x00, 0x00, 0x00,   
-	0x10, 0x00, 0x00, 0x08,   0x42, 0x20, 0x10, 0x00,   
-	0x00, 0x00, 0x00, 0x00,   0x46, 0x02, 0x10, 0x00,   
-	0x00, 0x00, 0x00, 0x00,   0x46, 0x83, 0x20, 0x00,   
-	0x00, 0x00, 0x00, 0x00,   0x02, 0x00, 0x00, 0x00,   
-	0x10, 0x00, 0x00, 0x08,   0x82, 0x20, 0x10, 0x00,   
-	0x00, 0x00, 0x00, 0x00,   0x46, 0x02, 0x10, 0x00,   
-	0x00, 0x00, 0x00, 0x00,   0x46, 0x83, 0x20, 0x00,   
-	0x00, 0x00, 0x00, 0x00,   0x03, 0x00, 0x00, 0x00,   
-	0x36, 0x00, 0x00, 0x05,   0x32, 0x20, 0x10, 0x00,   
-	0x01, 0x00, 0x00, 0x00,   0x46, 0x10, 0x10, 0x00,   
-	0x01, 0x00, 0x00, 0x00,   0x36, 0x00, 0x00, 0x05,   
-	0xf2, 0x20, 0x10, 0x00,   0x02, 0x00, 0x00, 0x00,   
-	0x46, 0x1e, 0x10, 0x00,   0x02, 0x00, 0x00, 0x00,   
-	0x3e, 0x00, 0x00, 0x01,   0x53, 0x54, 0x41, 0x54,   
-	0x94, 0x00, 0x00, 0x00,   0x09, 0x00, 0x00, 0x00,   
-	0x01, 0x00, 0x00, 0x00,   0x00, 0x00, 0x00, 0x00,   
-	0x06, 0x00, 0x00, 0x00,   0x04, 0x00, 0x00, 0x00,   
-	0x00, 0x00, 0x00, 0x00,   0x00, 0x00, 0x00, 0x00,   
-	0x01, 0x00, 0x00, 0x00,   0x00, 0x00, 0x00, 0x00,   
-	0x00, 0x00, 0x00, 0x00,   0x00, 0x00, 0x00, 0x00,   
-	0x00, 0x00, 0x00, 0x00,   0x00, 0x00, 0x00, 0x00,   
-	0x00, 0x00, 0x00, 0x00,   0x00, 0x00, 0x00, 0x00,   
-	0x00, 0x00, 0x00, 0x00,   0x00, 0x00, 0x00, 0x00,   
-	0x00, 0x00, 0x00, 0x00,   0x00, 0x00, 0x00, 0x00,   
-	0x04, 0x00, 0x00, 0x00,   0x00, 0x00, 0x00, 0x00,   
-	0x00, 0x00, 0x00, 0x00,   0x00, 0x00, 0x00, 0x00,   
-	0x00, 0x00, 0x00, 0x00,   0x00, 0x00, 0x00, 0x00,   
-	0x00, 0x00, 0x00, 0x00,   0x00, 0x00, 0x00, 0x00,   
-	0x00, 0x00, 0x00, 0x00,   0x00, 0x00, 0x00, 0x00,   
-	0x00, 0x00, 0x00, 0x00,   0x00, 0x00, 0x00, 0x00,   
-	0x00, 0x00, 0x00, 0x00,   0x00, 0x00, 0x00, 0x00,   
-	0x00, 0x00, 0x00, 0x00,   0x00, 0x00, 0x00, 0x00,   
-	0x00, 0x00, 0x00, 0x00,   0x00, 0x00, 0x00, 0x00,   
-};
-
 
-/***********************************************************
-struct PixelInput {
-    float4 pos : SV_POSITION;
-    float2 uv : TEXCOORD;
-    float4 col : COLOR;
-};
+// == SHADERS =================================================================
+
+// the only copy of the shaders, compiled when the device is created with UV_TEXTURE_SLOTS
+// passed as a define
+static const char shader_src[] =
+"struct VertexInput {\n"
+"    float2 pos : POSITION;\n"
+"    float2 uv : TEXCOORD;\n"
+"    float4 col : COLOR;\n"
+"#if UV_TEXTURE_SLOTS > 1\n"
+"    uint slot : SLOT;\n"
+"#endif\n"
+"};\n"
+"\n"
+"struct PixelInput {\n"
+"    float4 pos : SV_POSITION;\n"
+"    float2 uv : TEXCOORD;\n"
+"    float4 col : COLOR;\n"
+"#if UV_TEXTURE_SLOTS > 1\n"
+"    nointerpolation uint slot : SLOT;\n"
+"#endif\n"
+"};\n"
+"\n"
+"cbuffer MatrixBuffer : register(b0) {\n"
+"    matrix proj;\n"
+"};\n"
+"\n"
+// only used by meshes, identity for everything else
+"cbuffer DrawBuffer : register(b1) {\n"
+"    float4 transform_x;\n"
+"    float4 transform_y;\n"
+"    float4 uv_rect;\n"
+"    float4 tint;\n"
+"};\n"
+"\n"
+"Texture2D textures[UV_TEXTURE_SLOTS] : register(t0);\n"
+"SamplerState Sampler0 : register(s0);\n"
+"\n"
+"PixelInput VS(VertexInput input) {\n"
+"    float3 local = float3(input.pos, 1.0);\n"
+"    float2 pos = float2(dot(transform_x.xyz, local), dot(transform_y.xyz, local));\n"
+"\n"
+"    PixelInput output;\n"
+"    output.pos = mul(float4(pos, 0.0, 1.0), proj);\n"
+"    output.uv  = lerp(uv_rect.xy, uv_rect.zw, input.uv);\n"
+"    output.col = input.col * tint;\n"
+"#if UV_TEXTURE_SLOTS > 1\n"
+"    output.slot = input.slot;\n"
+"#endif\n"
+"    return output;\n"
+"}\n"
+"\n"
+"struct SpriteInput {\n"
+"    float2 pos : POSITION;\n"
+"    float2 size : SIZE;\n"
+"    float rotation : ROTATION;\n"
+"    float2 shape : SHAPE;\n"
+"    float4 uv : TEXCOORD;\n"
+"    float4 col : COLOR;\n"
+"#if UV_TEXTURE_SLOTS > 1\n"
+"    uint slot : SLOT;\n"
+"#endif\n"
+"    uint id : SV_VertexID;\n"
+"};\n"
+"\n"
+// same corners and winding as the quads made by the frontend
+"static const uint sprite_corners[6] = { 0, 1, 2, 2, 1, 3 };\n"
+"\n"
+"struct SpriteOutput {\n"
+"    float4 pos : SV_POSITION;\n"
+"    float2 uv : TEXCOORD;\n"
+"    float4 col : COLOR;\n"
+"#if UV_TEXTURE_SLOTS > 1\n"
+"    nointerpolation uint slot : SLOT;\n"
+"#endif\n"
+// position from the centre before the rotation, and half the size, radius and thickness
+"    float2 local : LOCAL;\n"
+"    nointerpolation float4 shape : SHAPE;\n"
+"};\n"
+"\n"
+"SpriteOutput VS_Sprite(SpriteInput input) {\n"
+"    uint corner = sprite_corners[input.id];\n"
+"    float2 t = float2(corner >> 1, corner & 1);\n"
+// shapes are a pixel bigger on every side for their edge, the uvs go on past size
+"    bool is_shape = input.shape.x >= 0.0;\n"
+"    float pad = is_shape ? 1.0 : 0.0;\n"
+"    float2 local = (t - 0.5) * input.size + (t * 2.0 - 1.0) * pad;\n"
+"    float s, c;\n"
+"    sincos(input.rotation, s, c);\n"
+"    float2 pos = input.pos + input.size * 0.5 + float2(local.x * c - local.y * s, local.x * s + local.y * c);\n"
+"\n"
+"    SpriteOutput output;\n"
+"    output.pos = mul(float4(pos, 0.0, 1.0), proj);\n"
+"    output.uv  = lerp(input.uv.xy, input.uv.zw, is_shape ? local / input.size + 0.5 : t);\n"
+"    output.col = input.col;\n"
+"#if UV_TEXTURE_SLOTS > 1\n"
+"    output.slot = input.slot;\n"
+"#endif\n"
+"    output.local = local;\n"
+"    output.shape = float4(abs(input.size) * 0.5, input.shape);\n"
+"    return output;\n"
+"}\n"
+"\n"
+// shader model 4 can only index texture arrays with literals, the gradients are taken
+// before branching as they are undefined inside of it
+"#define SLOT(i) case i: return textures[i].SampleGrad(Sampler0, uv, dx, dy);\n"
+"\n"
+"float4 sampleSlot(uint slot, float2 uv) {\n"
+"#if UV_TEXTURE_SLOTS > 1\n"
+"    float2 dx = ddx(uv);\n"
+"    float2 dy = ddy(uv);\n"
+"    [branch] switch (slot) {\n"
+"    SLOT(1) SLOT(2) SLOT(3) SLOT(4) SLOT(5) SLOT(6) SLOT(7)\n"
+"#if UV_TEXTURE_SLOTS > 8\n"
+"    SLOT(8) SLOT(9) SLOT(10) SLOT(11) SLOT(12) SLOT(13) SLOT(14) SLOT(15)\n"
+"#endif\n"
+"    default: return textures[0].SampleGrad(Sampler0, uv, dx, dy);\n"
+"    }\n"
+"#else\n"
+"    return textures[0].Sample(Sampler0, uv);\n"
+"#endif\n"
+"}\n"
+"\n"
+"float4 PS(PixelInput input) : SV_Target {\n"
+"#if UV_TEXTURE_SLOTS > 1\n"
+"    return input.col * sampleSlot(input.slot, input.uv);\n"
+"#else\n"
+"    return input.col * sampleSlot(0, input.uv);\n"
+"#endif\n"
+"}\n"
+"\n"
+// signed distance to the rounded box, or to the band inside of its border, as coverage.
+// the same as softShapeCoverage
+"float4 PS_Sprite(SpriteOutput input) : SV_Target {\n"
+"#if UV_TEXTURE_SLOTS > 1\n"
+"    float4 col = input.col * sampleSlot(input.slot, input.uv);\n"
+"#else\n"
+"    float4 col = input.col * sampleSlot(0, input.uv);\n"
+"#endif\n"
+"    if (input.shape.z >= 0.0) {\n"
+"        float radius = min(input.shape.z, min(input.shape.x, input.shape.y));\n"
+"        float2 q = abs(input.local) - input.shape.xy + radius;\n"
+"        float d = length(max(q, 0.0)) + min(max(q.x, q.y), 0.0) - radius;\n"
+"        if (input.shape.w > 0.0) {\n"
+"            d = abs(d + input.shape.w * 0.5) - input.shape.w * 0.5;\n"
+"        }\n"
+"        col.a *= saturate(0.5 - d);\n"
+"    }\n"
+"    return col;\n"
+"}\n";
+
+#define D3D11_STR_(x) #x
+#define D3D11_STR(x) D3D11_STR_(x)
+
+static ID3DBlob *d3d11CompileShader(const char *entry, const char *target) {
+    const D3D_SHADER_MACRO defines[] = {
+        { "UV_TEXTURE_SLOTS", D3D11_STR(UV_TEXTURE_SLOTS) },
+        { NULL, NULL },
+    };
 
-Texture2D diffuse_texture;
-SamplerState Sampler0;
+    UINT flags = D3DCOMPILE_ENABLE_STRICTNESS;
+#ifndef NDEBUG
+    flags |= D3DCOMPILE_DEBUG;
+#else
+    flags |= D3DCOMPILE_OPTIMIZATION_LEVEL3;
+#endif
 
-float4 PS(PixelInput input) : SV_Target {
-    float4 colour = input.col * diffuse_texture.Sample(Sampler0, input.uv);
-    return colour;
+    ID3DBlob *code = NULL;
+    ID3DBlob *errors = NULL;
+    HRESULT hr = D3DCompile(shader_src, sizeof(shader_src) - 1, "ulivo", defines, NULL, entry, target, flags, 0, &code, &errors);
+    if (FAILED(hr)) {
+        const char *msg = errors ? (const char *)errors->lpVtbl->GetBufferPointer(errors) : "unknown error";
+        err("couldn't compile %s: %s", entry, msg);
+        SAFE_RELEASE(code);
+    }
+    SAFE_RELEASE(errors);
+    return code;
 }
-***********************************************************/
-static const u8 ps_data[] ={ 
-	0x44, 0x58, 0x42, 0x43,   0xa1, 0xb7, 0x7f, 0x07,   
-	0xb0, 0xf3, 0x81, 0xac,   0xa5, 0x4a, 0xa8, 0x9e,   
-	0x08, 0x29, 0x16, 0x1f,   0x01, 0x00, 0x00, 0x00,   
-	0xe8, 0x02, 0x00, 0x00,   0x05, 0x00, 0x00, 0x00,   
-	0x34, 0x00, 0x00, 0x00,   0xfc, 0x00, 0x00, 0x00,   
-	0x70, 0x01, 0x00, 0x00,   0xa4, 0x01, 0x00, 0x00,   
-	0x4c, 0x02, 0x00, 0x00,   0x52, 0x44, 0x45, 0x46,   
-	0xc0, 0x00, 0x00, 0x00,   0x00, 0x00, 0x00, 0x00,   
-	0x00, 0x00, 0x00, 0x00,   0x02, 0x00, 0x00, 0x00,   
-	0x3c, 0x00, 0x00, 0x00,   0x00, 0x05, 0xff, 0xff,   
-	0x00, 0x01, 0x00, 0x00,   0x95, 0x00, 0x00, 0x00,   
-	0x52, 0x44, 0x31, 0x31,   0x3c, 0x00, 0x00, 0x00,   
-	0x18, 0x00, 0x00, 0x00,   0x20, 0x00, 0x00, 0x00,   
-	0x28, 0x00, 0x00, 0x00,   0x24, 0x00, 0x00, 0x00,   
-	0x0c, 0x00, 0x00, 0x00,   0x00, 0x00, 0x00, 0x00,   
-	0x7c, 0x00, 0x00, 0x00,   0x03, 0x00, 0x00, 0x00,   
-	0x00, 0x00, 0x00, 0x00,   0x00, 0x00, 0x00, 0x00,   
-	0x00, 0x00, 0x00, 0x00,   0x00, 0x00, 0x00, 0x00,   
-	0x01, 0x00, 0x00, 0x00,   0x00, 0x00, 0x00, 0x00,   
-	0x85, 0x00, 0x00, 0x00,   0x02, 0x00, 0x00, 0x00,   
-	0x05, 0x00, 0x00, 0x00,   0x04, 0x00, 0x00, 0x00,   
-	0xff, 0xff, 0xff, 0xff,   0x00, 0x00, 0x00, 0x00,   
-	0x01, 0x00, 0x00, 0x00,   0x0c, 0x00, 0x00, 0x00,   
-	0x53, 0x61, 0x6d, 0x70,   0x6c, 0x65, 0x72, 0x30,   
-	0x00, 0x64, 0x69, 0x66,   0x66, 0x75, 0x73, 0x65,   
-	0x5f, 0x74, 0x65, 0x78,   0x74, 0x75, 0x72, 0x65,   
-	0x00, 0x4d, 0x69, 0x63,   0x72, 0x6f, 0x73, 0x6f,   
-	0x66, 0x74, 0x20, 0x28,   0x52, 0x29, 0x20, 0x48,   
-	0x4c, 0x53, 0x4c, 0x20,   0x53, 0x68, 0x61, 0x64,   
-	0x65, 0x72, 0x20, 0x43,   0x6f, 0x6d, 0x70, 0x69,   
-	0x6c, 0x65, 0x72, 0x20,   0x31, 0x30, 0x2e, 0x31,   
-	0x00, 0xab, 0xab, 0xab,   0x49, 0x53, 0x47, 0x4e,   
-	0x6c, 0x00, 0x00, 0x00,   0x03, 0x00, 0x00, 0x00,   
-	0x08, 0x00, 0x00, 0x00,   0x50, 0x00, 0x00, 0x00,   
-	0x00, 0x00, 0x00, 0x00,   0x01, 0x00, 0x00, 0x00,   
-	0x03, 0x00, 0x00, 0x00,   0x00, 0x00, 0x00, 0x00,   
-	0x0f, 0x00, 0x00, 0x00,   0x5c, 0x00, 0x00, 0x00,   
-	0x00, 0x00, 0x00, 0x00,   0x00, 0x00, 0x00, 0x00,   
-	0x03, 0x00, 0x00, 0x00,   0x01, 0x00, 0x00, 0x00,   
-	0x03, 0x03, 0x00, 0x00,   0x65, 0x00, 0x00, 0x00,   
-	0x00, 0x00, 0x00, 0x00,   0x00, 0x00, 0x00, 0x00,   
-	0x03, 0x00, 0x00, 0x00,   0x02, 0x00, 0x00, 0x00,   
-	0x0f, 0x0f, 0x00, 0x00,   0x53, 0x56, 0x5f, 0x50,   
-	0x4f, 0x53, 0x49, 0x54,   0x49, 0x4f, 0x4e, 0x00,   
-	0x54, 0x45, 0x58, 0x43,   0x4f, 0x4f, 0x52, 0x44,   
-	0x00, 0x43, 0x4f, 0x4c,   0x4f, 0x52, 0x00, 0xab,   
-	0x4f, 0x53, 0x47, 0x4e,   0x2c, 0x00, 0x00, 0x00,   
-	0x01, 0x00, 0x00, 0x00,   0x08, 0x00, 0x00, 0x00,   
-	0x20, 0x00, 0x00, 0x00,   0x00, 0x00, 0x00, 0x00,   
-	0x00, 0x00, 0x00, 0x00,   0x03, 0x00, 0x00, 0x00,   
-	0x00, 0x00, 0x00, 0x00,   0x0f, 0x00, 0x00, 0x00,   
-	0x53, 0x56, 0x5f, 0x54,   0x61, 0x72, 0x67, 0x65,   
-	0x74, 0x00, 0xab, 0xab,   0x53, 0x48, 0x45, 0x58,   
-	0xa0, 0x00, 0x00, 0x00,   0x50, 0x00, 0x00, 0x00,   
-	0x28, 0x00, 0x00, 0x00,   0x6a, 0x08, 0x00, 0x01,   
-	0x5a, 0x00, 0x00, 0x03,   0x00, 0x60, 0x10, 0x00,   
-	0x00, 0x00, 0x00, 0x00,   0x58, 0x18, 0x00, 0x04,   
-	0x00, 0x70, 0x10, 0x00,   0x00, 0x00, 0x00, 0x00,   
-	0x55, 0x55, 0x00, 0x00,   0x62, 0x10, 0x00, 0x03,   
-	0x32, 0x10, 0x10, 0x00,   0x01, 0x00, 0x00, 0x00,   
-	0x62, 0x10, 0x00, 0x03,   0xf2, 0x10, 0x10, 0x00,   
-	0x02, 0x00, 0x00, 0x00,   0x65, 0x00, 0x00, 0x03,   
-	0xf2, 0x20, 0x10, 0x00,   0x00, 0x00, 0x00, 0x00,   
-	0x68, 0x00, 0x00, 0x02,   0x01, 0x00, 0x00, 0x00,   
-	0x45, 0x00, 0x00, 0x8b,   0xc2, 0x00, 0x00, 0x80,   
-	0x43, 0x55, 0x15, 0x00,   0xf2, 0x00, 0x10, 0x00,   
-	0x00, 0x00, 0x00, 0x00,   0x46, 0x10, 0x10, 0x00,   
-	0x01, 0x00, 0x00, 0x00,   0x46, 0x7e, 0x10, 0x00,   
-	0x00, 0x00, 0x00, 0x00,   0x00, 0x60, 0x10, 0x00,   
-	0x00, 0x00, 0x00, 0x00,   0x38, 0x00, 0x00, 0x07,   
-	0xf2, 0x20, 0x10, 0x00,   0x00, 0x00, 0x00, 0x00,   
-	0x46, 0x0e, 0x10, 0x00,   0x00, 0x00, 0x00, 0x00,   
-	0x46, 0x1e, 0x10, 0x00,   0x02, 0x00, 0x00, 0x00,   
-	0x3e, 0x00, 0x00, 0x01,   0x53, 0x54, 0x41, 0x54,   
-	0x94, 0x00, 0x00, 0x00,   0x03, 0x00, 0x00, 0x00,   
-	0x01, 0x00, 0x00, 0x00,   0x00, 0x00, 0x00, 0x00,   
-	0x03, 0x00, 0x00, 0x00,   0x01, 0x00, 0x00, 0x00,   
-	0x00, 0x00, 0x00, 0x00,   0x00, 0x00, 0x00, 0x00,   
-	0x01, 0x00, 0x00, 0x00,   0x00, 0x00, 0x00, 0x00,   
-	0x00, 0x00, 0x00, 0x00,   0x00, 0x00, 0x00, 0x00,   
-	0x00, 0x00, 0x00, 0x00,   0x00, 0x00, 0x00, 0x00,   
-	0x00, 0x00, 0x00, 0x00,   0x01, 0x00, 0x00, 0x00,   
-	0x00, 0x00, 0x00, 0x00,   0x00, 0x00, 0x00, 0x00,   
-	0x00, 0x00, 0x00, 0x00,   0x00, 0x00, 0x00, 0x00,   
-	0x00, 0x00, 0x00, 0x00,   0x00, 0x00, 0x00, 0x00,   
-	0x00, 0x00, 0x00, 0x00,   0x00, 0x00, 0x00, 0x00,   
-	0x00, 0x00, 0x00, 0x00,   0x00, 0x00, 0x00, 0x00,   
-	0x00, 0x00, 0x00, 0x00,   0x00, 0x00, 0x00, 0x00,   
-	0x00, 0x00, 0x00, 0x00,   0x00, 0x00, 0x00, 0x00,   
-	0x00, 0x00, 0x00, 0x00,   0x00, 0x00, 0x00, 0x00,   
-	0x00, 0x00, 0x00, 0x00,   0x00, 0x00, 0x00, 0x00,   
-	0x00, 0x00, 0x00, 0x00,   0x00, 0x00, 0x00, 0x00,   
-	0x00, 0x00, 0x00, 0x00,   0x00, 0x00, 0x00, 0x00,   
-};
 
 #ifndef DONT_USE_TLOG
 
@@ -885,4 +1386,6 @@ static void traceSetFatalCallback(on_fatal_cb_f cb, void *userdata) {
     fatal_cb_userdata = userdata;
 }
 
-#endif
\ No newline at end of file
+#endif
+
+#endif // UV_BACKEND_D3D11
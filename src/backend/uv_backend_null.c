@@ -0,0 +1,239 @@
+#define ULIVO_BACKEND_DATA
+#include "../ulivo.h"
+
+#ifdef UV_BACKEND_NULL
+
+/* Null backend
+ * Doesn't open a window nor draw anything, every uv_drawdata_t is only
+ * counted and checksummed so the frontend can be measured on its own.
+ * Read the totals with uvNullGetStats, reset them with uvNullResetStats.
+ * Every context has its own stats (uvCtxNullGetStats).
+ * There is no scissor, so clip rects are applied by the frontend.
+ * Draws to a render texture are counted in target_draws instead of frames.
+ */
+
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+static u64 nullHash(u64 hash, const void *data, usize len);
+static u64 nullNow(void);
+
+typedef struct {
+    u64 timer_last;
+    float frame_time;
+} null_window_t;
+
+typedef struct {
+    uv_null_stats_t stats;
+    texture_t target;
+} null_gfx_t;
+
+static void nullResetStats(null_gfx_t *gfx);
+
+// == WINDOW ==================================================================
+
+void *uv__backend_create_window(uv_context_t *ctx, const char *name, int width, int height) {
+    null_window_t *win = malloc(sizeof(null_window_t));
+    if (win) {
+        *win = (null_window_t){ .timer_last = nullNow(), .frame_time = 1.f / 60.f };
+    }
+    return win;
+}
+
+void uv__backend_destroy_window(void *win_data) {
+    free(win_data);
+}
+
+bool uv__backend_poll_input(void *win_data) {
+    null_window_t *win = win_data;
+    u64 now = nullNow();
+    u64 dt = now > win->timer_last ? now - win->timer_last : 1;
+    win->timer_last = now;
+    win->frame_time = (float)((double)dt / 1e9);
+    return true;
+}
+
+float uv__backend_get_delta_time(void *win_data) {
+    null_window_t *win = win_data;
+    return win->frame_time;
+}
+
+// == GFX =====================================================================
+
+void *uv__backend_init_gfx(void *win_data, int width, int height) {
+    null_gfx_t *gfx = malloc(sizeof(null_gfx_t));
+    if (gfx) {
+        nullResetStats(gfx);
+    }
+    return gfx;
+}
+
+u32 uv__backend_get_caps(void *gfx) {
+    return UV_CAP_INDEX_U16 | UV_CAP_INDEX_U32 | UV_CAP_INSTANCES | UV_CAP_SHAPES | UV_CAP_RENDER_TEXTURES;
+}
+
+void uv__backend_cleanup_gfx(void *gfx) {
+    free(gfx);
+}
+
+void uv__backend_resize_gfx(void *gfx, int new_width, int new_height) {
+}
+
+void uv__backend_draw(void *gfx_data, colour_t clear_colour, uv_drawdata_t *data) {
+    if (!data) return;
+
+    null_gfx_t *gfx = gfx_data;
+    uv_null_stats_t *stats = &gfx->stats;
+
+    if (data->unchanged) {
+        stats->frames  += 1;
+        stats->skipped += 1;
+        return;
+    }
+
+    u64 hash = nullHash(stats->checksum, &clear_colour, sizeof(clear_colour));
+
+    for (uv_drawdata_t *list = data; list; list = list->next) {
+        usize vtx_bytes   = sizeof(uv_vertex_t) * list->vtx_count;
+        usize idx_bytes   = list->index_size    * list->idx_count;
+        usize batch_bytes = sizeof(uv_batch_t)  * list->batch_count;
+        usize inst_bytes  = sizeof(uv_instance_t) * list->inst_count;
+        usize mesh_bytes  = sizeof(uv_mesh_draw_t) * list->mesh_count;
+
+        hash = nullHash(hash, list->vertices, vtx_bytes);
+        hash = nullHash(hash, list->indices, idx_bytes);
+        hash = nullHash(hash, list->batches, batch_bytes);
+        hash = nullHash(hash, list->instances, inst_bytes);
+        hash = nullHash(hash, list->meshes, mesh_bytes);
+
+        for (u32 i = 0; i < list->batch_count; ++i) {
+            if (list->batches[i].mesh_count) {
+                uv__backend_draw_mesh(gfx, list, &list->batches[i]);
+            }
+        }
+
+        stats->batches   += list->batch_count;
+        stats->vertices  += list->vtx_count;
+        stats->indices   += list->idx_count;
+        stats->instances += list->inst_count;
+        stats->bytes     += vtx_bytes + idx_bytes + batch_bytes + inst_bytes + mesh_bytes;
+    }
+
+    if (gfx->target) stats->target_draws += 1;
+    else             stats->frames += 1;
+    stats->checksum = hash;
+}
+
+texture_t uv__backend_load_texture(void *gfx, const image_t *image) {
+    if (!image || !image->data) return 0;
+
+    // only used as a unique handle
+    image_t *texture = malloc(sizeof(image_t));
+    if (texture) {
+        *texture = (image_t){ .width = image->width, .height = image->height };
+    }
+    return (texture_t)texture;
+}
+
+void uv__backend_free_texture(void *gfx, texture_t texture) {
+    free((image_t *)texture);
+}
+
+void uv__backend_update_texture(void *gfx, texture_t texture, const image_t *image, u32 x, u32 y) {
+}
+
+texture_t uv__backend_create_render_texture(void *gfx, u32 width, u32 height) {
+    image_t *texture = malloc(sizeof(image_t));
+    if (texture) {
+        *texture = (image_t){ .width = width, .height = height };
+    }
+    return (texture_t)texture;
+}
+
+void uv__backend_set_target(void *gfx_data, texture_t target) {
+    null_gfx_t *gfx = gfx_data;
+    gfx->target = target;
+}
+
+// there are no pixels to read, so there's no UV_CAP_READBACK
+void uv__backend_read_pixels(void *gfx, u32 slot) {
+}
+
+bool uv__backend_poll_pixels(void *gfx, u32 slot, u32 *width, u32 *height) {
+    return false;
+}
+
+void uv__backend_get_pixels(void *gfx, u32 slot, u8 *pixels) {
+}
+
+mesh_t uv__backend_create_mesh(void *gfx, const uv_vertex_t *vertices, u32 vtx_count, const void *indices, u32 index_size, u32 idx_count) {
+    // only used as a unique handle, the data is never read again
+    u32 *mesh = malloc(sizeof(u32) * 2);
+    if (mesh) {
+        mesh[0] = vtx_count;
+        mesh[1] = idx_count;
+    }
+    return (mesh_t)mesh;
+}
+
+void uv__backend_draw_mesh(void *gfx_data, const uv_drawdata_t *list, const uv_batch_t *batch) {
+    null_gfx_t *gfx = gfx_data;
+    gfx->stats.mesh_draws += batch->mesh_count;
+}
+
+void uv__backend_free_mesh(void *gfx, mesh_t mesh) {
+    free((u32 *)mesh);
+}
+
+uv_null_stats_t uvCtxNullGetStats(uv_context_t *ctx) {
+    null_gfx_t *gfx = uv__context_gfx(ctx);
+    return gfx ? gfx->stats : (uv_null_stats_t){0};
+}
+
+void uvCtxNullResetStats(uv_context_t *ctx) {
+    null_gfx_t *gfx = uv__context_gfx(ctx);
+    if (gfx) {
+        nullResetStats(gfx);
+    }
+}
+
+uv_null_stats_t uvNullGetStats(void) {
+    return uvCtxNullGetStats(uvGetDefaultContext());
+}
+
+void uvNullResetStats(void) {
+    uvCtxNullResetStats(uvGetDefaultContext());
+}
+
+// == STATIC FUNCTIONS ========================================================
+
+static void nullResetStats(null_gfx_t *gfx) {
+    gfx->stats = (uv_null_stats_t){ .checksum = 14695981039346656037ull };
+}
+
+// fnv-1a over 8 bytes at a time, cheap enough not to hide the cost of the frontend
+static u64 nullHash(u64 hash, const void *data, usize len) {
+    const u8 *bytes = data;
+    usize i = 0;
+
+    for (; i + 8 <= len; i += 8) {
+        u64 word;
+        memcpy(&word, bytes + i, sizeof(word));
+        hash = (hash ^ word) * 1099511628211ull;
+    }
+
+    for (; i < len; ++i) {
+        hash = (hash ^ bytes[i]) * 1099511628211ull;
+    }
+
+    return hash;
+}
+
+static u64 nullNow(void) {
+    struct timespec ts;
+    timespec_get(&ts, TIME_UTC);
+    return (u64)ts.tv_sec * 1000000000ull + (u64)ts.tv_nsec;
+}
+
+#endif // UV_BACKEND_NULL
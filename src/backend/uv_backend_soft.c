@@ -0,0 +1,965 @@
+#define ULIVO_BACKEND_DATA
+#include "../ulivo.h"
+
+#ifdef UV_BACKEND_SOFT
+
+/* Headless software backend
+ * Triangles are set up and binned into UV_SOFT_TILE_SIZE square screen tiles,
+ * then every tile is cleared and shaded independently on colla's jobpool.
+ * Instances are two triangles each, the ones with a shape carry its signed distance.
+ * Pixels with an alpha under 1 are blended over the framebuffer.
+ * The result is kept in an RGBA8 framebuffer, which can be read with uvSoftGetFramebuffer.
+ * Render textures are textures with the same layout, drawn into instead of the framebuffer.
+ * Readback is synchronous: the framebuffer is copied at the end of uv__backend_draw.
+ * Every context has its own framebuffer and threads (uvCtxSoftGetFramebuffer).
+ * Define UV_SOFT_THREADS to force the number of threads used for shading.
+ */
+
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#ifdef _WIN32
+#define WIN32_LEAN_AND_MEAN
+#include <Windows.h>
+#else
+#include <unistd.h>
+#endif
+
+#include <tracelog.h>
+#include <jobpool.h>
+#include <vec.h>
+
+#ifndef UV_SOFT_TILE_SIZE
+#define UV_SOFT_TILE_SIZE 64
+#endif
+
+typedef struct {
+    u32 width, height;
+    u32 *pixels;
+} soft_texture_t;
+
+// meshes keep their own copy of the vertices, transformed again for every draw
+typedef struct {
+    uv_vertex_t *vertices;
+    u32 *indices;
+    u32 vtx_count;
+    u32 idx_count;
+} soft_mesh_t;
+
+// rounded box of a uv_instance_t, in pixels
+typedef struct {
+    float cx, cy;
+    // cos and sin of the rotation
+    float c, s;
+    float hx, hy;
+    float radius;
+    float thickness;
+} soft_shape_t;
+
+typedef struct {
+    // edge functions (a*x + b*y + c), positive inside the triangle
+    float ea[3], eb[3], ec[3];
+    bool top_left[3];
+    // u, v, r, g, b, a as planes (dx*x + dy*y + c)
+    float dx[6], dy[6], c[6];
+    const soft_texture_t *texture;
+    bool is_flat;
+    u32 flat_colour;
+    // coverage is multiplied in the alpha
+    bool is_shape;
+    soft_shape_t shape;
+    int minx, miny, maxx, maxy;
+} soft_tri_t;
+
+typedef struct {
+    u64 timer_last;
+    float frame_time;
+} soft_window_t;
+
+typedef struct {
+    // the pixels being drawn to: the window's or the ones of a render texture
+    u32 *framebuffer;
+    vec2i fb_size;
+    u32 *window_fb;
+    vec2i window_size;
+    u32 clear_value;
+    // clip rect of the batch being set up, triangles are cut to it in softSetupTriangle
+    vec4i scissor;
+
+    vec2i tile_count;
+    vec(soft_tri_t) triangles;
+    vec(uv_vertex_t) mesh_vertices;
+    vec(u32) *bins;
+    u32 bin_count;
+    u32 bin_cap;
+
+    // copies of the window for uv__backend_read_pixels, slot + 1 of the next one or 0
+    u32 *readback[UV_READBACK_SLOTS];
+    vec2i readback_size[UV_READBACK_SLOTS];
+    bool readback_ready[UV_READBACK_SLOTS];
+    u32 readback_next;
+
+    jobpool_t pool;
+    u32 worker_count;
+    cmutex_t tile_mtx;
+    condvar_t tile_cond;
+    u32 next_tile;
+    u32 workers_running;
+} soft_gfx_t;
+
+static void softInitThreads(soft_gfx_t *gfx);
+static void softSetTarget(soft_gfx_t *gfx, u32 *pixels, vec2i size);
+static void softReadback(soft_gfx_t *gfx);
+static u32 softGetCoreCount(void);
+static void softBatchTextures(const uv_batch_t *batch, const soft_texture_t **textures);
+static void softSetupTriangle(soft_gfx_t *gfx, const uv_vertex_t *v0, const uv_vertex_t *v1, const uv_vertex_t *v2, const soft_texture_t *const *textures);
+static void softSetupInstance(soft_gfx_t *gfx, const uv_instance_t *inst, const soft_texture_t *const *textures);
+static uv_vertex_t softMeshVertex(const uv_vertex_t *in, const uv_mesh_draw_t *draw);
+static void softBinTriangle(soft_gfx_t *gfx, u32 tri_index);
+static int softShadeWorker(void *arg);
+static void softShadeTiles(soft_gfx_t *gfx);
+static void softShadeTile(soft_gfx_t *gfx, u32 tile);
+static float softShapeCoverage(const soft_shape_t *shape, float x, float y);
+static u32 softPackColour(float r, float g, float b, float a);
+static u32 softBlend(u32 dst, float r, float g, float b, float a);
+static u64 softNow(void);
+
+static u32 default_pixel = 0xffffffff;
+static soft_texture_t default_texture = { 1, 1, &default_pixel };
+
+// == WINDOW ==================================================================
+
+void *uv__backend_create_window(uv_context_t *ctx, const char *name, int width, int height) {
+    soft_window_t *win = malloc(sizeof(soft_window_t));
+    if (!win) {
+        fatal("couldn't allocate window");
+        return NULL;
+    }
+    *win = (soft_window_t){ .timer_last = softNow(), .frame_time = 1.f / 60.f };
+    return win;
+}
+
+void uv__backend_destroy_window(void *win_data) {
+    free(win_data);
+}
+
+bool uv__backend_poll_input(void *win_data) {
+    soft_window_t *win = win_data;
+    u64 now = softNow();
+    u64 dt = now > win->timer_last ? now - win->timer_last : 1;
+    win->timer_last = now;
+    win->frame_time = (float)((double)dt / 1e9);
+    return true;
+}
+
+float uv__backend_get_delta_time(void *win_data) {
+    soft_window_t *win = win_data;
+    return win->frame_time;
+}
+
+// == GFX =====================================================================
+
+void *uv__backend_init_gfx(void *win_data, int width, int height) {
+    soft_gfx_t *gfx = calloc(1, sizeof(soft_gfx_t));
+    if (!gfx) {
+        fatal("couldn't allocate software renderer");
+        return NULL;
+    }
+    uv__backend_resize_gfx(gfx, width, height);
+    softInitThreads(gfx);
+    return gfx;
+}
+
+u32 uv__backend_get_caps(void *gfx) {
+    return UV_CAP_INDEX_U16 | UV_CAP_INDEX_U32 | UV_CAP_INSTANCES | UV_CAP_SCISSOR | UV_CAP_SHAPES | UV_CAP_RENDER_TEXTURES | UV_CAP_READBACK;
+}
+
+void uv__backend_cleanup_gfx(void *gfx_data) {
+    soft_gfx_t *gfx = gfx_data;
+    if (!gfx) return;
+
+    if (gfx->pool) {
+        poolFree(gfx->pool);
+        mtxFree(gfx->tile_mtx);
+        condFree(gfx->tile_cond);
+    }
+
+    for (u32 i = 0; i < gfx->bin_cap; ++i) {
+        vecFree(gfx->bins[i]);
+    }
+    free(gfx->bins);
+
+    vecFree(gfx->triangles);
+    vecFree(gfx->mesh_vertices);
+
+    for (u32 i = 0; i < UV_READBACK_SLOTS; ++i) {
+        free(gfx->readback[i]);
+    }
+
+    free(gfx->window_fb);
+    free(gfx);
+}
+
+void uv__backend_resize_gfx(void *gfx_data, int new_width, int new_height) {
+    soft_gfx_t *gfx = gfx_data;
+
+    if (new_width <= 0 || new_height <= 0) {
+        return;
+    }
+
+    u32 *new_fb = realloc(gfx->window_fb, sizeof(u32) * new_width * new_height);
+    if (!new_fb) {
+        fatal("couldn't allocate %dx%d framebuffer", new_width, new_height);
+        return;
+    }
+    gfx->window_fb = new_fb;
+    gfx->window_size = (vec2i){ new_width, new_height };
+    softSetTarget(gfx, gfx->window_fb, gfx->window_size);
+}
+
+void uv__backend_draw(void *gfx_data, colour_t clear_colour, uv_drawdata_t *data) {
+    soft_gfx_t *gfx = gfx_data;
+    if (!data || !gfx->framebuffer) return;
+
+    // the framebuffer still has the last frame in it, resizing always changes the frame hash
+    if (data->unchanged) {
+        softReadback(gfx);
+        return;
+    }
+
+    gfx->clear_value = softPackColour(clear_colour.r, clear_colour.g, clear_colour.b, clear_colour.a);
+
+    // -- setup and bin triangles --
+
+    vecClear(gfx->triangles);
+    for (u32 i = 0; i < gfx->bin_count; ++i) {
+        vecClear(gfx->bins[i]);
+    }
+
+    for (uv_drawdata_t *list = data; list; list = list->next) {
+        for (u32 b = 0; b < list->batch_count; ++b) {
+            uv_batch_t *batch = &list->batches[b];
+            gfx->scissor = batch->clip;
+            if (batch->mesh_count) {
+                uv__backend_draw_mesh(gfx, list, batch);
+                continue;
+            }
+
+            const soft_texture_t *textures[UV_TEXTURE_SLOTS];
+            softBatchTextures(batch, textures);
+
+            for (u32 i = 0; i < batch->inst_count; ++i) {
+                softSetupInstance(gfx, &list->instances[batch->inst_start + i], textures);
+            }
+
+            const uv_vertex_t *vertices = list->vertices + batch->vtx_start;
+
+            if (list->index_size == sizeof(u16)) {
+                const u16 *indices = (const u16 *)list->indices + batch->idx_start;
+                for (u32 i = 0; i + 2 < batch->idx_count; i += 3) {
+                    softSetupTriangle(
+                        gfx,
+                        &vertices[indices[i + 0]],
+                        &vertices[indices[i + 1]],
+                        &vertices[indices[i + 2]],
+                        textures
+                    );
+                }
+            }
+            else {
+                const u32 *indices = (const u32 *)list->indices + batch->idx_start;
+                for (u32 i = 0; i + 2 < batch->idx_count; i += 3) {
+                    softSetupTriangle(
+                        gfx,
+                        &vertices[indices[i + 0]],
+                        &vertices[indices[i + 1]],
+                        &vertices[indices[i + 2]],
+                        textures
+                    );
+                }
+            }
+        }
+    }
+
+    for (u32 i = 0; i < vecLen(gfx->triangles); ++i) {
+        softBinTriangle(gfx, i);
+    }
+
+    // -- shade tiles in parallel --
+
+    gfx->next_tile = 0;
+
+    if (gfx->pool) {
+        mtxLock(gfx->tile_mtx);
+        gfx->workers_running = gfx->worker_count;
+        mtxUnlock(gfx->tile_mtx);
+
+        for (u32 i = 0; i < gfx->worker_count; ++i) {
+            poolAdd(gfx->pool, softShadeWorker, gfx);
+        }
+    }
+
+    // the calling thread shades tiles too
+    softShadeTiles(gfx);
+
+    if (gfx->pool) {
+        mtxLock(gfx->tile_mtx);
+        while (gfx->workers_running > 0) {
+            condWait(gfx->tile_cond, gfx->tile_mtx);
+        }
+        mtxUnlock(gfx->tile_mtx);
+    }
+
+    softReadback(gfx);
+}
+
+texture_t uv__backend_create_render_texture(void *gfx, u32 width, u32 height) {
+    soft_texture_t *texture = malloc(sizeof(soft_texture_t));
+    if (!texture) {
+        err("failed to allocate render texture");
+        return 0;
+    }
+
+    texture->width  = width;
+    texture->height = height;
+    texture->pixels = calloc((usize)width * height, sizeof(u32));
+    if (!texture->pixels) {
+        err("failed to allocate %ux%u render texture", width, height);
+        free(texture);
+        return 0;
+    }
+
+    return (texture_t)texture;
+}
+
+void uv__backend_set_target(void *gfx_data, texture_t target) {
+    soft_gfx_t *gfx = gfx_data;
+    soft_texture_t *tex = (soft_texture_t *)target;
+    if (tex) softSetTarget(gfx, tex->pixels, (vec2i){ (int)tex->width, (int)tex->height });
+    else     softSetTarget(gfx, gfx->window_fb, gfx->window_size);
+}
+
+void uv__backend_read_pixels(void *gfx_data, u32 slot) {
+    soft_gfx_t *gfx = gfx_data;
+    gfx->readback_next = slot + 1;
+}
+
+bool uv__backend_poll_pixels(void *gfx_data, u32 slot, u32 *width, u32 *height) {
+    soft_gfx_t *gfx = gfx_data;
+    if (!gfx->readback_ready[slot]) return false;
+    *width  = (u32)gfx->readback_size[slot].x;
+    *height = (u32)gfx->readback_size[slot].y;
+    return true;
+}
+
+void uv__backend_get_pixels(void *gfx_data, u32 slot, u8 *pixels) {
+    soft_gfx_t *gfx = gfx_data;
+    vec2i size = gfx->readback_size[slot];
+    memcpy(pixels, gfx->readback[slot], sizeof(u32) * size.x * size.y);
+    gfx->readback_ready[slot] = false;
+}
+
+texture_t uv__backend_load_texture(void *gfx, const image_t *image) {
+    if (!image || !image->data) return 0;
+
+    soft_texture_t *texture = malloc(sizeof(soft_texture_t));
+    if (!texture) {
+        err("failed to allocate texture");
+        return 0;
+    }
+
+    usize size = sizeof(u32) * image->width * image->height;
+    texture->width  = image->width;
+    texture->height = image->height;
+    texture->pixels = malloc(size);
+    if (!texture->pixels) {
+        err("failed to allocate %ux%u texture", image->width, image->height);
+        free(texture);
+        return 0;
+    }
+
+    memcpy(texture->pixels, image->data, size);
+
+    return (texture_t)texture;
+}
+
+void uv__backend_free_texture(void *gfx, texture_t texture) {
+    soft_texture_t *tex = (soft_texture_t *)texture;
+    if (!tex) return;
+    free(tex->pixels);
+    free(tex);
+}
+
+void uv__backend_update_texture(void *gfx, texture_t texture, const image_t *image, u32 x, u32 y) {
+    soft_texture_t *tex = (soft_texture_t *)texture;
+    if (!tex || !image || !image->data) return;
+    if (x + image->width > tex->width || y + image->height > tex->height) return;
+
+    for (u32 row = 0; row < image->height; ++row) {
+        memcpy(
+            &tex->pixels[(y + row) * tex->width + x],
+            image->data + row * image->width * 4,
+            sizeof(u32) * image->width
+        );
+    }
+}
+
+mesh_t uv__backend_create_mesh(void *gfx, const uv_vertex_t *vertices, u32 vtx_count, const void *indices, u32 index_size, u32 idx_count) {
+    soft_mesh_t *mesh = calloc(1, sizeof(soft_mesh_t));
+    if (!mesh) {
+        err("failed to allocate mesh");
+        return 0;
+    }
+
+    mesh->vertices = malloc(sizeof(uv_vertex_t) * vtx_count);
+    mesh->indices = malloc(sizeof(u32) * idx_count);
+    if (!mesh->vertices || !mesh->indices) {
+        err("failed to allocate mesh with %u vertices and %u indices", vtx_count, idx_count);
+        uv__backend_free_mesh(gfx, (mesh_t)mesh);
+        return 0;
+    }
+
+    memcpy(mesh->vertices, vertices, sizeof(uv_vertex_t) * vtx_count);
+    for (u32 i = 0; i < idx_count; ++i) {
+        mesh->indices[i] = index_size == sizeof(u16) ? ((const u16 *)indices)[i] : ((const u32 *)indices)[i];
+    }
+    mesh->vtx_count = vtx_count;
+    mesh->idx_count = idx_count;
+
+    return (mesh_t)mesh;
+}
+
+void uv__backend_draw_mesh(void *gfx_data, const uv_drawdata_t *list, const uv_batch_t *batch) {
+    soft_gfx_t *gfx = gfx_data;
+    const soft_texture_t *textures[UV_TEXTURE_SLOTS];
+    softBatchTextures(batch, textures);
+
+    for (u32 d = 0; d < batch->mesh_count; ++d) {
+        const uv_mesh_draw_t *draw = &list->meshes[batch->mesh_start + d];
+        const soft_mesh_t *mesh = (const soft_mesh_t *)draw->mesh;
+
+        vecClear(gfx->mesh_vertices);
+        uv_vertex_t *vertices = vecAdd(gfx->mesh_vertices, mesh->vtx_count);
+        for (u32 i = 0; i < mesh->vtx_count; ++i) {
+            vertices[i] = softMeshVertex(&mesh->vertices[i], draw);
+        }
+
+        for (u32 i = 0; i + 2 < mesh->idx_count; i += 3) {
+            softSetupTriangle(
+                gfx,
+                &vertices[mesh->indices[i + 0]],
+                &vertices[mesh->indices[i + 1]],
+                &vertices[mesh->indices[i + 2]],
+                textures
+            );
+        }
+    }
+}
+
+void uv__backend_free_mesh(void *gfx, mesh_t mesh) {
+    soft_mesh_t *m = (soft_mesh_t *)mesh;
+    if (!m) return;
+    free(m->vertices);
+    free(m->indices);
+    free(m);
+}
+
+image_t uvCtxSoftGetFramebuffer(uv_context_t *ctx) {
+    soft_gfx_t *gfx = uv__context_gfx(ctx);
+    if (!gfx) return (image_t){0};
+    return (image_t){
+        .data = (u8 *)gfx->window_fb,
+        .width = (u32)gfx->window_size.x,
+        .height = (u32)gfx->window_size.y,
+    };
+}
+
+image_t uvSoftGetFramebuffer(void) {
+    return uvCtxSoftGetFramebuffer(uvGetDefaultContext());
+}
+
+// == STATIC FUNCTIONS ========================================================
+
+// copies the window to the slot of uv__backend_read_pixels, draws to render textures don't count
+static void softReadback(soft_gfx_t *gfx) {
+    if (!gfx->readback_next || gfx->framebuffer != gfx->window_fb) return;
+
+    u32 slot = gfx->readback_next - 1;
+    gfx->readback_next = 0;
+
+    usize size = sizeof(u32) * gfx->window_size.x * gfx->window_size.y;
+    vec2i old = gfx->readback_size[slot];
+    if (!gfx->readback[slot] || old.x != gfx->window_size.x || old.y != gfx->window_size.y) {
+        u32 *pixels = realloc(gfx->readback[slot], size);
+        if (!pixels) {
+            err("failed to allocate %dx%d readback", gfx->window_size.x, gfx->window_size.y);
+            return;
+        }
+        gfx->readback[slot] = pixels;
+        gfx->readback_size[slot] = gfx->window_size;
+    }
+
+    memcpy(gfx->readback[slot], gfx->window_fb, size);
+    gfx->readback_ready[slot] = true;
+}
+
+// the tile bins only grow, so switching between the window and a render texture keeps them
+static void softSetTarget(soft_gfx_t *gfx, u32 *pixels, vec2i size) {
+    gfx->framebuffer = pixels;
+    gfx->fb_size = size;
+    gfx->tile_count = (vec2i){
+        (size.x + UV_SOFT_TILE_SIZE - 1) / UV_SOFT_TILE_SIZE,
+        (size.y + UV_SOFT_TILE_SIZE - 1) / UV_SOFT_TILE_SIZE,
+    };
+    gfx->bin_count = (u32)(gfx->tile_count.x * gfx->tile_count.y);
+
+    if (gfx->bin_count > gfx->bin_cap) {
+        vec(u32) *bins = realloc(gfx->bins, sizeof(*bins) * gfx->bin_count);
+        if (!bins) {
+            fatal("couldn't allocate %u tile bins", gfx->bin_count);
+            return;
+        }
+        memset(bins + gfx->bin_cap, 0, sizeof(*bins) * (gfx->bin_count - gfx->bin_cap));
+        gfx->bins = bins;
+        gfx->bin_cap = gfx->bin_count;
+    }
+}
+
+static void softInitThreads(soft_gfx_t *gfx) {
+#ifdef UV_SOFT_THREADS
+    u32 thread_count = UV_SOFT_THREADS;
+#else
+    u32 thread_count = softGetCoreCount();
+#endif
+
+    // the calling thread is also used for shading
+    gfx->worker_count = thread_count > 1 ? thread_count - 1 : 0;
+    if (!gfx->worker_count) {
+        return;
+    }
+
+    gfx->tile_mtx = mtxInit();
+    gfx->tile_cond = condInit();
+    gfx->pool = poolInit(gfx->worker_count);
+    info("software renderer using %u threads", thread_count);
+}
+
+static u32 softGetCoreCount(void) {
+#ifdef _WIN32
+    SYSTEM_INFO sys_info;
+    GetSystemInfo(&sys_info);
+    return (u32)sys_info.dwNumberOfProcessors;
+#else
+    long count = sysconf(_SC_NPROCESSORS_ONLN);
+    return count > 0 ? (u32)count : 1;
+#endif
+}
+
+// unused slots get the default texture too
+static void softBatchTextures(const uv_batch_t *batch, const soft_texture_t **textures) {
+    for (u32 s = 0; s < UV_TEXTURE_SLOTS; ++s) {
+#if UV_TEXTURE_SLOTS > 1
+        texture_t texture = s < batch->texture_count ? batch->textures[s] : 0;
+#else
+        texture_t texture = batch->texture;
+#endif
+        textures[s] = texture ? (const soft_texture_t *)texture : &default_texture;
+    }
+}
+
+// textures are the batch's texture slots
+static void softSetupTriangle(soft_gfx_t *gfx, const uv_vertex_t *v0, const uv_vertex_t *v1, const uv_vertex_t *v2, const soft_texture_t *const *textures) {
+    // both windings are drawn (same as the d3d11 rasterizer state): a transform or a size
+    // can mirror the primitives, the setup below wants them counter-clockwise on screen
+    float area = (v1->pos.x - v0->pos.x) * (v2->pos.y - v0->pos.y) -
+                 (v1->pos.y - v0->pos.y) * (v2->pos.x - v0->pos.x);
+    if (area > 0.f) {
+        const uv_vertex_t *tmp = v1;
+        v1 = v2;
+        v2 = tmp;
+        area = -area;
+    }
+    if (!(area < 0.f)) {
+        return;
+    }
+
+    const uv_vertex_t *v[3] = { v0, v1, v2 };
+
+    float minx = v0->pos.x, maxx = v0->pos.x;
+    float miny = v0->pos.y, maxy = v0->pos.y;
+    for (int i = 1; i < 3; ++i) {
+        if (v[i]->pos.x < minx) minx = v[i]->pos.x;
+        if (v[i]->pos.x > maxx) maxx = v[i]->pos.x;
+        if (v[i]->pos.y < miny) miny = v[i]->pos.y;
+        if (v[i]->pos.y > maxy) maxy = v[i]->pos.y;
+    }
+
+    // pixels are sampled at their centre
+    int x0 = (int)ceilf(minx - 0.5f);
+    int y0 = (int)ceilf(miny - 0.5f);
+    int x1 = (int)floorf(maxx - 0.5f);
+    int y1 = (int)floorf(maxy - 0.5f);
+    if (x0 < gfx->scissor.x) x0 = gfx->scissor.x;
+    if (y0 < gfx->scissor.y) y0 = gfx->scissor.y;
+    if (x1 >= gfx->scissor.z) x1 = gfx->scissor.z - 1;
+    if (y1 >= gfx->scissor.w) y1 = gfx->scissor.w - 1;
+    if (x1 >= gfx->fb_size.x) x1 = gfx->fb_size.x - 1;
+    if (y1 >= gfx->fb_size.y) y1 = gfx->fb_size.y - 1;
+    if (x0 > x1 || y0 > y1) {
+        return;
+    }
+
+#if UV_TEXTURE_SLOTS > 1
+    // the slot isn't interpolated, the first vertex decides (like nointerpolation in hlsl)
+    const soft_texture_t *texture = v0->slot < UV_TEXTURE_SLOTS ? textures[v0->slot] : &default_texture;
+#else
+    const soft_texture_t *texture = textures[0];
+#endif
+
+    soft_tri_t *tri = vecAdd(gfx->triangles, 1);
+    tri->minx = x0; tri->miny = y0;
+    tri->maxx = x1; tri->maxy = y1;
+    tri->texture = texture;
+
+    // edge i is opposite to vertex i, so its value divided by the area is the barycentric weight
+    float inv_area = 1.f / -area;
+    for (int i = 0; i < 3; ++i) {
+        const vec2 a = v[(i + 1) % 3]->pos;
+        const vec2 b = v[(i + 2) % 3]->pos;
+        tri->ea[i] = b.y - a.y;
+        tri->eb[i] = a.x - b.x;
+        tri->ec[i] = -(tri->ea[i] * a.x + tri->eb[i] * a.y);
+        tri->top_left[i] = tri->ea[i] > 0.f || (tri->ea[i] == 0.f && tri->eb[i] > 0.f);
+    }
+
+    float attr[3][6];
+    for (int i = 0; i < 3; ++i) {
+#ifdef UV_PACKED_UV
+        attr[i][0] = v[i]->uv[0] / 65535.f;
+        attr[i][1] = v[i]->uv[1] / 65535.f;
+#else
+        attr[i][0] = v[i]->uv.u;
+        attr[i][1] = v[i]->uv.v;
+#endif
+#ifdef UV_PACKED_VERTEX
+        for (int k = 0; k < 4; ++k) {
+            attr[i][2 + k] = ((v[i]->col >> (k * 8)) & 0xff) / 255.f;
+        }
+#else
+        attr[i][2] = v[i]->col.r;
+        attr[i][3] = v[i]->col.g;
+        attr[i][4] = v[i]->col.b;
+        attr[i][5] = v[i]->col.a;
+#endif
+    }
+
+    for (int k = 0; k < 6; ++k) {
+        tri->dx[k] = tri->dy[k] = tri->c[k] = 0.f;
+        for (int i = 0; i < 3; ++i) {
+            float w = attr[i][k] * inv_area;
+            tri->dx[k] += tri->ea[i] * w;
+            tri->dy[k] += tri->eb[i] * w;
+            tri->c[k]  += tri->ec[i] * w;
+        }
+    }
+
+    tri->is_shape = false;
+    // a flat triangle is written without blending
+    tri->is_flat =
+        texture == &default_texture &&
+        attr[0][5] >= 1.f &&
+        memcmp(&v0->col, &v1->col, sizeof(v0->col)) == 0 &&
+        memcmp(&v0->col, &v2->col, sizeof(v0->col)) == 0;
+#ifdef UV_PACKED_VERTEX
+    // same byte order as the framebuffer
+    tri->flat_colour = v0->col;
+#else
+    tri->flat_colour = softPackColour(v0->col.r, v0->col.g, v0->col.b, v0->col.a);
+#endif
+}
+
+// the same quad as the sprites expanded by the frontend. shapes are a pixel bigger on every
+// side for their edge, with the uvs carried on past size
+static void softSetupInstance(soft_gfx_t *gfx, const uv_instance_t *inst, const soft_texture_t *const *textures) {
+    bool is_shape = inst->radius >= 0.f;
+    float pad = is_shape ? 1.f : 0.f;
+
+    vec2 half = { inst->size.x * 0.5f, inst->size.y * 0.5f };
+    vec2 centre = { inst->pos.x + half.x, inst->pos.y + half.y };
+    vec2 quad = { half.x + pad, half.y + pad };
+
+    float c = 1.f, s = 0.f;
+    if (inst->rotation != 0.f) {
+        c = cosf(inst->rotation);
+        s = sinf(inst->rotation);
+    }
+
+    // uvs of the corners, past the uv rectangle by as much as the quad is past size
+    float fu = is_shape && half.x != 0.f ? quad.x / half.x : 1.f;
+    float fv = is_shape && half.y != 0.f ? quad.y / half.y : 1.f;
+    float mu = (inst->uv.x + inst->uv.z) * 0.5f, hu = (inst->uv.z - inst->uv.x) * 0.5f * fu;
+    float mv = (inst->uv.y + inst->uv.w) * 0.5f, hv = (inst->uv.w - inst->uv.y) * 0.5f * fv;
+
+    uv_vertex_t corners[4];
+    for (int k = 0; k < 4; ++k) {
+        // 0: top left, 1: bottom left, 2: top right, 3: bottom right
+        float tx = k & 2 ? 1.f : -1.f;
+        float ty = k & 1 ? 1.f : -1.f;
+        float lx = tx * quad.x, ly = ty * quad.y;
+        uv_vertex_t *v = &corners[k];
+        v->pos = (vec2){ centre.x + lx * c - ly * s, centre.y + lx * s + ly * c };
+#ifdef UV_PACKED_UV
+        float u = mu + tx * hu, w = mv + ty * hv;
+        u = u > 0.f ? (u < 1.f ? u : 1.f) : 0.f;
+        w = w > 0.f ? (w < 1.f ? w : 1.f) : 0.f;
+        v->uv[0] = (u16)(u * 65535.f + 0.5f);
+        v->uv[1] = (u16)(w * 65535.f + 0.5f);
+#else
+        v->uv = (vec2){ mu + tx * hu, mv + ty * hv };
+#endif
+        v->col = inst->col;
+#if UV_TEXTURE_SLOTS > 1
+        v->slot = inst->slot;
+#endif
+    }
+
+    u32 first = vecLen(gfx->triangles);
+    softSetupTriangle(gfx, &corners[0], &corners[1], &corners[2], textures);
+    softSetupTriangle(gfx, &corners[2], &corners[1], &corners[3], textures);
+    if (!is_shape) {
+        return;
+    }
+
+    float min_half = fabsf(half.x) < fabsf(half.y) ? fabsf(half.x) : fabsf(half.y);
+    soft_shape_t shape = {
+        .cx = centre.x, .cy = centre.y,
+        .c = c, .s = s,
+        .hx = fabsf(half.x), .hy = fabsf(half.y),
+        .radius = inst->radius < min_half ? inst->radius : min_half,
+        .thickness = inst->thickness,
+    };
+    for (u32 i = first; i < vecLen(gfx->triangles); ++i) {
+        gfx->triangles[i].is_shape = true;
+        gfx->triangles[i].is_flat = false;
+        gfx->triangles[i].shape = shape;
+    }
+}
+
+static uv_vertex_t softMeshVertex(const uv_vertex_t *in, const uv_mesh_draw_t *draw) {
+    const float *m = draw->transform;
+    uv_vertex_t out = *in;
+
+    out.pos.x = m[0] * in->pos.x + m[1] * in->pos.y + m[2];
+    out.pos.y = m[3] * in->pos.x + m[4] * in->pos.y + m[5];
+
+#ifdef UV_PACKED_UV
+    for (int k = 0; k < 2; ++k) {
+        float lo = k ? draw->uv.y : draw->uv.x;
+        float hi = k ? draw->uv.w : draw->uv.z;
+        float t = lo + (in->uv[k] / 65535.f) * (hi - lo);
+        out.uv[k] = (u16)(t * 65535.f + 0.5f);
+    }
+#else
+    out.uv.u = draw->uv.x + in->uv.u * (draw->uv.z - draw->uv.x);
+    out.uv.v = draw->uv.y + in->uv.v * (draw->uv.w - draw->uv.y);
+#endif
+
+#ifdef UV_PACKED_VERTEX
+    const float tint[4] = { draw->tint.r, draw->tint.g, draw->tint.b, draw->tint.a };
+    out.col = 0;
+    for (int k = 0; k < 4; ++k) {
+        float c = ((in->col >> (k * 8)) & 0xff) * tint[k];
+        c = c < 255.f ? c : 255.f;
+        out.col |= (u32)(c > 0.f ? c + 0.5f : 0.f) << (k * 8);
+    }
+#else
+    out.col = v4mul(in->col, draw->tint);
+#endif
+
+    return out;
+}
+
+static void softBinTriangle(soft_gfx_t *gfx, u32 tri_index) {
+    const soft_tri_t *tri = &gfx->triangles[tri_index];
+    int tx0 = tri->minx / UV_SOFT_TILE_SIZE;
+    int ty0 = tri->miny / UV_SOFT_TILE_SIZE;
+    int tx1 = tri->maxx / UV_SOFT_TILE_SIZE;
+    int ty1 = tri->maxy / UV_SOFT_TILE_SIZE;
+
+    for (int ty = ty0; ty <= ty1; ++ty) {
+        for (int tx = tx0; tx <= tx1; ++tx) {
+            vecAppend(gfx->bins[ty * gfx->tile_count.x + tx], tri_index);
+        }
+    }
+}
+
+// job on the pool, the calling thread waits for all of them in uv__backend_draw
+static int softShadeWorker(void *arg) {
+    soft_gfx_t *gfx = arg;
+
+    softShadeTiles(gfx);
+
+    mtxLock(gfx->tile_mtx);
+    if (--gfx->workers_running == 0) {
+        condWake(gfx->tile_cond);
+    }
+    mtxUnlock(gfx->tile_mtx);
+
+    return 0;
+}
+
+static void softShadeTiles(soft_gfx_t *gfx) {
+    u32 tile_total = (u32)(gfx->tile_count.x * gfx->tile_count.y);
+
+    while (true) {
+        if (gfx->pool) mtxLock(gfx->tile_mtx);
+        u32 tile = gfx->next_tile++;
+        if (gfx->pool) mtxUnlock(gfx->tile_mtx);
+
+        if (tile >= tile_total) {
+            break;
+        }
+
+        softShadeTile(gfx, tile);
+    }
+}
+
+static void softShadeTile(soft_gfx_t *gfx, u32 tile) {
+    int tx = (int)(tile % (u32)gfx->tile_count.x);
+    int ty = (int)(tile / (u32)gfx->tile_count.x);
+    int x0 = tx * UV_SOFT_TILE_SIZE;
+    int y0 = ty * UV_SOFT_TILE_SIZE;
+    int x1 = x0 + UV_SOFT_TILE_SIZE - 1;
+    int y1 = y0 + UV_SOFT_TILE_SIZE - 1;
+    if (x1 >= gfx->fb_size.x) x1 = gfx->fb_size.x - 1;
+    if (y1 >= gfx->fb_size.y) y1 = gfx->fb_size.y - 1;
+
+    u32 *framebuffer = gfx->framebuffer;
+    int stride = gfx->fb_size.x;
+
+    for (int y = y0; y <= y1; ++y) {
+        u32 *row = framebuffer + y * stride;
+        for (int x = x0; x <= x1; ++x) {
+            row[x] = gfx->clear_value;
+        }
+    }
+
+    vec(u32) bin = gfx->bins[tile];
+    u32 count = vecLen(bin);
+
+    for (u32 t = 0; t < count; ++t) {
+        const soft_tri_t *tri = &gfx->triangles[bin[t]];
+
+        int minx = tri->minx > x0 ? tri->minx : x0;
+        int miny = tri->miny > y0 ? tri->miny : y0;
+        int maxx = tri->maxx < x1 ? tri->maxx : x1;
+        int maxy = tri->maxy < y1 ? tri->maxy : y1;
+
+        const soft_texture_t *tex = tri->texture;
+
+        for (int y = miny; y <= maxy; ++y) {
+            float py = (float)y + 0.5f;
+            float px = (float)minx + 0.5f;
+            float e0 = tri->ea[0] * px + tri->eb[0] * py + tri->ec[0];
+            float e1 = tri->ea[1] * px + tri->eb[1] * py + tri->ec[1];
+            float e2 = tri->ea[2] * px + tri->eb[2] * py + tri->ec[2];
+            u32 *row = framebuffer + y * stride;
+
+            for (int x = minx; x <= maxx; ++x, px += 1.f, e0 += tri->ea[0], e1 += tri->ea[1], e2 += tri->ea[2]) {
+                bool inside =
+                    (e0 > 0.f || (e0 == 0.f && tri->top_left[0])) &&
+                    (e1 > 0.f || (e1 == 0.f && tri->top_left[1])) &&
+                    (e2 > 0.f || (e2 == 0.f && tri->top_left[2]));
+                if (!inside) continue;
+
+                if (tri->is_flat) {
+                    row[x] = tri->flat_colour;
+                    continue;
+                }
+
+                float coverage = 1.f;
+                if (tri->is_shape) {
+                    coverage = softShapeCoverage(&tri->shape, px, py);
+                    if (coverage <= 0.f) continue;
+                }
+
+                float a[6];
+                for (int k = 0; k < 6; ++k) {
+                    a[k] = tri->dx[k] * px + tri->dy[k] * py + tri->c[k];
+                }
+
+                // point sampling with wrap addressing, same as the d3d11 sampler
+                int su = (int)floorf(a[0] * (float)tex->width)  % (int)tex->width;
+                int sv = (int)floorf(a[1] * (float)tex->height) % (int)tex->height;
+                if (su < 0) su += tex->width;
+                if (sv < 0) sv += tex->height;
+                u32 texel = tex->pixels[sv * tex->width + su];
+
+                float r  = a[2] * (float)((texel >>  0) & 0xff) / 255.f;
+                float g  = a[3] * (float)((texel >>  8) & 0xff) / 255.f;
+                float b  = a[4] * (float)((texel >> 16) & 0xff) / 255.f;
+                float al = a[5] * (float)((texel >> 24) & 0xff) / 255.f * coverage;
+
+                // same as the d3d11 blend state
+                row[x] = al < 1.f ? softBlend(row[x], r, g, b, al) : softPackColour(r, g, b, al);
+            }
+        }
+    }
+}
+
+// signed distance to the rounded box (or to the band inside of its border) as coverage,
+// the edge is a pixel wide ramp centred on the distance 0
+static float softShapeCoverage(const soft_shape_t *shape, float x, float y) {
+    // back to the axes of the box, which is symmetric on both of them
+    float dx = x - shape->cx, dy = y - shape->cy;
+    float lx = fabsf(shape->c * dx + shape->s * dy);
+    float ly = fabsf(shape->c * dy - shape->s * dx);
+
+    float qx = lx - shape->hx + shape->radius;
+    float qy = ly - shape->hy + shape->radius;
+    float ox = qx > 0.f ? qx : 0.f;
+    float oy = qy > 0.f ? qy : 0.f;
+    float inside = qx > qy ? qx : qy;
+    float d = sqrtf(ox * ox + oy * oy) + (inside < 0.f ? inside : 0.f) - shape->radius;
+
+    if (shape->thickness > 0.f) {
+        float half = shape->thickness * 0.5f;
+        d = fabsf(d + half) - half;
+    }
+
+    float coverage = 0.5f - d;
+    return coverage > 0.f ? (coverage < 1.f ? coverage : 1.f) : 0.f;
+}
+
+static u32 softPackColour(float r, float g, float b, float a) {
+    float ch[4] = { r, g, b, a };
+    u32 out = 0;
+    for (int i = 0; i < 4; ++i) {
+        float c = ch[i];
+        if (!(c > 0.f)) c = 0.f;
+        if (c > 1.f) c = 1.f;
+        out |= (u32)(c * 255.f + 0.5f) << (i * 8);
+    }
+    return out;
+}
+
+// source over: the colour by its alpha, the destination's alpha is kept under it
+static u32 softBlend(u32 dst, float r, float g, float b, float a) {
+    if (!(a > 0.f)) return dst;
+    float src[4] = { r, g, b, 1.f };
+    float ch[4];
+    for (int i = 0; i < 4; ++i) {
+        float d = (float)((dst >> (i * 8)) & 0xff) / 255.f;
+        ch[i] = src[i] * a + d * (1.f - a);
+    }
+    return softPackColour(ch[0], ch[1], ch[2], ch[3]);
+}
+
+static u64 softNow(void) {
+    struct timespec ts;
+    timespec_get(&ts, TIME_UTC);
+    return (u64)ts.tv_sec * 1000000000ull + (u64)ts.tv_nsec;
+}
+
+#endif // UV_BACKEND_SOFT
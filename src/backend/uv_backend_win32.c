@@ -1,9 +1,12 @@
 #define ULIVO_BACKEND_DATA
 #include "../ulivo.h"
 
+#ifdef UV_BACKEND_D3D11
+
 #define WIN32_LEAN_AND_MEAN
 #include <Windows.h>
 #include <windowsx.h> // GET_X_LPARAM(), GET_Y_LPARAM()
+#include <stdlib.h>
 
 #ifndef DONT_USE_TLOG
 typedef void (*on_fatal_cb_f)(const char *msg, void *userdata);
@@ -35,23 +38,40 @@ static int win32ToMouse(uintptr_t virtual_key);
 static int win32ToKeys(uintptr_t virtual_key);
 static LONGLONG timer_muldiv(LONGLONG value, LONGLONG numer, LONGLONG denom);
 
+// every window reports its messages to its own context
+typedef struct {
+    HWND hwnd;
+    uv_context_t *ctx;
+    bool closed;
+    float frame_time;
+    LARGE_INTEGER timer_start;
+    LARGE_INTEGER timer_freq;
+    uint64_t timer_last;
+} win32_window_t;
+
 static HINSTANCE hinstance = NULL;
-static HWND hwnd = NULL;
-static float frame_time = 1.f / 60.f;
-static LARGE_INTEGER timer_start = {0};
-static LARGE_INTEGER timer_freq = {0};
-static uint64_t timer_last = 0;
-
-void *uv__backend_create_window(const char *name, int width, int height) {
-    hinstance = GetModuleHandle(NULL);
-
-    RegisterClassEx(&(WNDCLASSEX){
-        .cbSize = sizeof(WNDCLASSEX),
-        .style = CS_CLASSDC,
-        .lpfnWndProc = wndProc,
-        .hInstance = hinstance,
-        .lpszClassName = WINDOW_CLASS_NAME
-    });
+static u32 window_count = 0;
+
+void *uv__backend_create_window(uv_context_t *ctx, const char *name, int width, int height) {
+    win32_window_t *win = calloc(1, sizeof(win32_window_t));
+    if (!win) {
+        fatal("couldn't allocate window");
+        return NULL;
+    }
+    win->ctx = ctx;
+    win->frame_time = 1.f / 60.f;
+
+    if (window_count++ == 0) {
+        hinstance = GetModuleHandle(NULL);
+
+        RegisterClassEx(&(WNDCLASSEX){
+            .cbSize = sizeof(WNDCLASSEX),
+            .style = CS_CLASSDC,
+            .lpfnWndProc = wndProc,
+            .hInstance = hinstance,
+            .lpszClassName = WINDOW_CLASS_NAME
+        });
+    }
 
 #if UNICODE
     wchar_t window_name[255] = {0};
@@ -62,7 +82,8 @@ void *uv__backend_create_window(const char *name, int width, int height) {
 	const char *window_name = name;
 #endif
 
-    hwnd = CreateWindow(
+    // wndProc gets win in WM_NCCREATE, before any message that uses it
+    win->hwnd = CreateWindow(
         WINDOW_CLASS_NAME,
         window_name,
         WS_OVERLAPPEDWINDOW,
@@ -70,37 +91,50 @@ void *uv__backend_create_window(const char *name, int width, int height) {
         width, height,
         NULL, NULL,
         hinstance,
-        NULL
+        win
     );
 
-    ShowWindow(hwnd, SW_SHOWDEFAULT);
-    UpdateWindow(hwnd);
+    ShowWindow(win->hwnd, SW_SHOWDEFAULT);
+    UpdateWindow(win->hwnd);
 
 	// initialize timer
 
-	QueryPerformanceFrequency(&timer_freq);
-	QueryPerformanceCounter(&timer_start);
+	QueryPerformanceFrequency(&win->timer_freq);
+	QueryPerformanceCounter(&win->timer_start);
 
-    return hwnd;
+    return win;
 }
 
 void uv__backend_destroy_window(void *win_data) {
-    DestroyWindow(hwnd);
-    UnregisterClass(WINDOW_CLASS_NAME, hinstance);
-    hwnd = NULL;
-    hinstance = NULL;
+    win32_window_t *win = win_data;
+    if (!win) return;
+
+    if (win->hwnd) {
+        SetWindowLongPtr(win->hwnd, GWLP_USERDATA, 0);
+        DestroyWindow(win->hwnd);
+    }
+    free(win);
+
+    if (--window_count == 0) {
+        UnregisterClass(WINDOW_CLASS_NAME, hinstance);
+        hinstance = NULL;
+    }
+}
+
+// used by the d3d11 backend to create the swapchain
+HWND uv__win32_get_hwnd(void *win_data) {
+    win32_window_t *win = win_data;
+    return win->hwnd;
 }
 
 bool uv__backend_poll_input(void *win_data) {
-    bool is_open = true;
+    win32_window_t *win = win_data;
 
+    // messages of all the windows of this thread are dispatched to their own wndProc
     MSG msg;
     while (PeekMessage(&msg, NULL, 0, 0, PM_REMOVE)) {
         TranslateMessage(&msg);
         DispatchMessage(&msg);
-        if (msg.message == WM_QUIT) {
-            is_open = false;
-        }
     }
 
 	// update timer (copied straight from sokol_time.h)
@@ -109,29 +143,42 @@ bool uv__backend_poll_input(void *win_data) {
 	QueryPerformanceCounter(&now);
 
 	LONGLONG dt = 1;
-	if (timer_last && now.QuadPart > timer_last) {
-		dt = now.QuadPart - timer_last;
+	if (win->timer_last && now.QuadPart > win->timer_last) {
+		dt = now.QuadPart - win->timer_last;
 	}
-	timer_last = now.QuadPart;
-	frame_time = (float)((double)dt / (double)timer_freq.QuadPart);
+	win->timer_last = now.QuadPart;
+	win->frame_time = (float)((double)dt / (double)win->timer_freq.QuadPart);
 
-    return is_open;
+    return !win->closed;
 }
 
 float uv__backend_get_delta_time(void *win_data) {
-    return frame_time;
+    win32_window_t *win = win_data;
+    return win->frame_time;
 }
 
 // == STATIC FUNCTIONS ========================================================
 
 static LRESULT wndProc(HWND hwnd, UINT msg, WPARAM wparam, LPARAM lparam) {
+	if (msg == WM_NCCREATE) {
+		CREATESTRUCT *cs = (CREATESTRUCT *)lparam;
+		SetWindowLongPtr(hwnd, GWLP_USERDATA, (LONG_PTR)cs->lpCreateParams);
+	}
+
+	win32_window_t *win = (win32_window_t *)GetWindowLongPtr(hwnd, GWLP_USERDATA);
+	if (!win) {
+		return DefWindowProc(hwnd, msg, wparam, lparam);
+	}
+
 	switch (msg) {
 	case WM_DESTROY:
-		PostQuitMessage(0);
+		// only this window is closed, the others keep going
+		win->closed = true;
+		win->hwnd = NULL;
 		return 0;
 
 	case WM_SIZE:
-        uvOnWindowResize(LOWORD(lparam), HIWORD(lparam));
+        uvCtxOnWindowResize(win->ctx, LOWORD(lparam), HIWORD(lparam));
     #if 0
 		if (gfx::device && wparam != SIZE_MINIMIZED) {
 			win_size = (vec2i){ LOWORD(lparam), HIWORD(lparam) };
@@ -156,13 +203,13 @@ static LRESULT wndProc(HWND hwnd, UINT msg, WPARAM wparam, LPARAM lparam) {
 		if ((wparam == VK_RETURN) && (HIWORD(lparam) & KF_EXTENDED))
 			vk = VK_RETURN + KF_EXTENDED;
 		
-        uvSetKeyState(win32ToKeys(vk), is_key_down);
+        uvCtxSetKeyState(win->ctx, win32ToKeys(vk), is_key_down);
 		return 0;
 	}
 
 	case WM_MOUSEMOVE:
 	{
-        uvSetMousePosition((vec2i){ GET_X_LPARAM(lparam), GET_Y_LPARAM(lparam) });
+        uvCtxSetMousePosition(win->ctx, (vec2i){ GET_X_LPARAM(lparam), GET_Y_LPARAM(lparam) });
 		return 0;
 	}
 
@@ -170,14 +217,14 @@ static LRESULT wndProc(HWND hwnd, UINT msg, WPARAM wparam, LPARAM lparam) {
 	case WM_RBUTTONDOWN: case WM_RBUTTONDBLCLK:
 	case WM_MBUTTONDOWN: case WM_MBUTTONDBLCLK:
 	{
-        uvSetMouseState(win32ToMouse(msg), true);
+        uvCtxSetMouseState(win->ctx, win32ToMouse(msg), true);
 		return 0;
 	}
 	case WM_LBUTTONUP:
 	case WM_RBUTTONUP:
 	case WM_MBUTTONUP:
 	{
-        uvSetMouseState(win32ToMouse(msg), false);
+        uvCtxSetMouseState(win->ctx, win32ToMouse(msg), false);
 		return 0;
 	}
 	case WM_MOUSEWHEEL:
@@ -403,4 +450,6 @@ static void traceSetFatalCallback(on_fatal_cb_f cb, void *userdata) {
     fatal_cb_userdata = userdata;
 }
 
-#endif
\ No newline at end of file
+#endif
+
+#endif // UV_BACKEND_D3D11
@@ -26,6 +26,24 @@
 #define UV_MEMCPY(dst, src, n) memcpy(dst, src, n)
 #endif
 
+#ifndef UV_MEMMOVE
+#include <string.h>
+#define UV_MEMMOVE(dst, src, n) memmove(dst, src, n)
+#endif
+
+// font files are read with stdio
+#include <stdio.h>
+
+// define UV_NO_SIMD to only use the scalar code paths
+#if !defined(UV_NO_SIMD) && (defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2))
+#define UV_SIMD_SSE2
+#include <emmintrin.h>
+#if defined(__AVX2__)
+#define UV_SIMD_AVX2
+#include <immintrin.h>
+#endif
+#endif
+
 #define UV_ARRLEN(arr) (sizeof(arr) / sizeof(*(arr)))
 #define UV_TODO(msg)   UV_ASSERT(false && "TODO: " msg)
 
@@ -39,7 +57,7 @@ static void stbi_image_free(void *retval_from_stbi_load);
 
 #define vec(T)                  T *
 
-#define vecfree(vec)            ((vec) ? UV_FREE(uv__vecheader(vec)), NULL : NULL)
+#define vecfree(vec)            ((vec) ? UV_FREE(uv__vecheader(vec), allocator_udata), NULL : NULL)
 
 #define vecpush(vec, ...)       (uv__vec_maygrow(vec, 1), (vec)[uv__veclen(vec)] = (__VA_ARGS__), uv__veclen(vec)++)
 #define vecrem(vec, ind)        ((vec) ? (vec)[(ind)] = (vec)[--uv__veclen(vec)], NULL : 0)
@@ -90,338 +108,4893 @@ static void uv__vec_growimpl(void **arr, u32 increment, u32 itemsize, void *allo
     }
 }
 
-// ====================================================
+// == vertex packing ==================================
 
-static uv_drawdata_t drawdata = {0};
-static colour_t clear_colour = { 0, 0, 0, 1 };
-static void *allocator_udata = NULL;
-static void *window_data = NULL;
-static vec2i win_size = { 0, 0 };
-static bool is_open = true;
+#ifdef UV_PACKED_VERTEX
+typedef u32 uv__colour_t;
+#else
+typedef colour_t uv__colour_t;
+#endif
+
+static uv__colour_t uv__pack_colour(colour_t colour) {
+#ifdef UV_PACKED_VERTEX
+    float ch[4] = { colour.r, colour.g, colour.b, colour.a };
+    u32 packed = 0;
+    for (int i = 0; i < 4; ++i) {
+        float c = ch[i] > 0.f ? (ch[i] < 1.f ? ch[i] : 1.f) : 0.f;
+        packed |= (u32)(c * 255.f + 0.5f) << (i * 8);
+    }
+    return packed;
+#else
+    return colour;
+#endif
+}
 
-static bool keys_state[UV_KEY__COUNT] = {0};
-static bool prev_keys_state[UV_KEY__COUNT] = {0};
-static u32 mouse_buttons_down = 0;
-static vec2i mouse_position;
-static vec2i mouse_relative;
-static float mouse_wheel = 0.f;
+// == context =========================================
+// everything a window and its renderer need, so more of them can live in the same process.
+// the uv* functions use default_context, the uvCtx* ones take it as their first argument
+
+typedef struct {
+    uv_drawdata_t data;
+    // layer of each batch, only used in deferred mode
+    u16 *layers;
+    u32 vtx_cap;
+    u32 idx_cap;
+    u32 batch_cap;
+    // instances and mesh draws are allocated on first use
+    u32 inst_cap;
+    u32 mesh_cap;
+    // vertices and indices already in the frame hash
+    u32 hashed_vtx;
+    u32 hashed_idx;
+} uv__chunk_t;
+
+typedef struct {
+    u64 key;
+    u32 chunk;
+    u32 batch;
+} uv__sort_item_t;
+
+typedef struct {
+    texture_t texture;
+    u32 id;
+} uv__texture_slot_t;
+
+typedef struct {
+    uv_drawdata_t data;
+    u32 idx_cap;
+    u32 batch_cap;
+} uv__sorted_t;
+
+typedef struct {
+    u32 x, y, width;
+} uv__skyline_t;
+
+typedef struct {
+    texture_t handle;
+    vec(uv__skyline_t) skyline;
+    u32 live;
+} uv__atlas_page_t;
+
+// see tessellation
+#define UV_TESS_MAX_SEGMENTS 512
+static void uv__tess_free(uv_context_t *ctx);
+// see clip rects
+static void uv__clip_update(uv_context_t *ctx);
+
+// see transforms. x' = m[0]*x + m[1]*y + m[2], y' = m[3]*x + m[4]*y + m[5], like uv_mesh_draw_t
+typedef struct {
+    float m[6];
+} uv__affine_t;
+
+#define UV_AFFINE_IDENTITY { { 1.f, 0.f, 0.f, 0.f, 1.f, 0.f } }
+
+// see text
+typedef struct uv__glyph_atlas_t uv__glyph_atlas_t;
+static void uv__glyph_atlas_free(uv_context_t *ctx);
+
+// see render textures, the state of the frame while a render texture is drawn into.
+// the vectors are swapped with the context's, so both keep their memory
+typedef struct {
+    struct uv__texture_t *texture;
+    colour_t clear_colour;
+    vec(uv__chunk_t *) chunks;
+    u32 chunk_count;
+    vec(vec4i) clip_stack;
+    vec(uv__affine_t) transform_stack;
+    uv__affine_t transform;
+    bool transformed;
+    vec4 cur_uv;
+    u32 cur_slot;
+    u16 cur_layer;
+    u64 frame_hash;
+    u32 culled;
+    vec2i win_size;
+} uv__target_t;
+
+static void uv__target_free(uv_context_t *ctx);
+
+struct uv_context_t {
+    uv_options_t options;
+
+    // uv rectangle of the texture in use
+    vec4 cur_uv;
+    // slot of the texture in use in the current batch, always 0 without UV_TEXTURE_SLOTS
+    u32 cur_slot;
+    u16 cur_layer;
+
+    vec(uv__chunk_t *) chunks;
+    u32 chunk_count;
+    u32 backend_caps;
+
+    // see frame hash
+    u64 frame_hash;
+    u64 prev_frame_hash;
+    bool has_prev_frame;
+    u32 frame_epoch;
+
+    // see deferred mode
+    vec(uv__sort_item_t) sort_items;
+    vec(uv__sort_item_t) sort_temp;
+    vec(uv__texture_slot_t) sort_textures;
+    vec(uv__sorted_t) sorted_lists;
+
+    vec(uv__atlas_page_t) atlas_pages;
+
+    // see culling
+    vec4 cull_rect;
+    u32 culled;
+
+    // see clip rects
+    vec(vec4i) clip_stack;
+    vec4i cur_clip;
+    bool cpu_clip;
+
+    // see transforms, transformed is false while transform is the identity
+    uv__affine_t transform;
+    vec(uv__affine_t) transform_stack;
+    bool transformed;
+
+    // see tessellation, unit circles of 4, 8, 12, ... segments built on first use
+    vec2 *tess_tables[UV_TESS_MAX_SEGMENTS / 4];
+
+    // see text, the glyph atlas is made when the first glyph is drawn.
+    // frame_count goes up with every frame, for the least recently used glyphs
+    uv__glyph_atlas_t *glyph_atlas;
+    u32 frame_count;
+
+    // see render textures
+    uv__target_t target;
+
+    // see readback, the copies in flight are in the backend's slots from readback_head on
+    bool readback_requested;
+    u32 readback_head;
+    u32 readback_count;
+    vec(u8) readback_pixels;
+
+    // see fragments
+    uv_context_t *parent;
+    vec(uv_context_t *) fragments;
+    vec(uv__chunk_t *) frame_chunks;
+
+    colour_t clear_colour;
+    // as returned by uv__backend_create_window and uv__backend_init_gfx
+    void *window_data;
+    void *gfx_data;
+    vec2i win_size;
+    bool is_open;
+
+    bool keys_state[UV_KEY__COUNT];
+    bool prev_keys_state[UV_KEY__COUNT];
+    u32 mouse_buttons_down;
+    vec2i mouse_position;
+    vec2i mouse_relative;
+    float mouse_wheel;
+};
 
-void uvCreateWindow(const char *name, int width, int height, const uv_options_t *options) {
-    win_size = (vec2i){ width, height };
+#define UV_HASH_SEED  14695981039346656037ull
 
-    window_data = uv__backend_create_window(name, width, height);
-    uv__backend_resize_gfx(width, height);
-    uv__backend_init_gfx();
-}
+#define UV_CONTEXT_INIT {                \
+        .cur_uv = { 0, 0, 1, 1 },        \
+        .transform = UV_AFFINE_IDENTITY, \
+        .frame_hash = UV_HASH_SEED,      \
+        .clear_colour = { 0, 0, 0, 1 },  \
+        .is_open = true,                 \
+    }
 
-void uvCloseWindow(void) {
-    is_open = false;
+static uv_context_t default_context = UV_CONTEXT_INIT;
+
+static inline vec2 uv__transform_point(const uv__affine_t *t, vec2 p) {
+    return v2(
+        t->m[0] * p.x + t->m[1] * p.y + t->m[2],
+        t->m[3] * p.x + t->m[4] * p.y + t->m[5]
+    );
 }
 
-void uvOnWindowResize(int new_width, int new_height) {
-    win_size = (vec2i){ new_width, new_height };
-    uv__backend_resize_gfx(new_width, new_height);
+// a vertex as is, without the current transform
+static inline uv_vertex_t uv__vertex_local(const uv_context_t *ctx, vec2 pos, vec2 uv, uv__colour_t colour) {
+    uv_vertex_t vtx = { .pos = pos, .col = colour };
+#ifdef UV_PACKED_UV
+    float u = uv.u > 0.f ? (uv.u < 1.f ? uv.u : 1.f) : 0.f;
+    float v = uv.v > 0.f ? (uv.v < 1.f ? uv.v : 1.f) : 0.f;
+    vtx.uv[0] = (u16)(u * 65535.f + 0.5f);
+    vtx.uv[1] = (u16)(v * 65535.f + 0.5f);
+#else
+    vtx.uv = uv;
+#endif
+#if UV_TEXTURE_SLOTS > 1
+    vtx.slot = ctx->cur_slot;
+#endif
+    return vtx;
 }
 
-void uvCleanup(void) {
-    uv__backend_cleanup_gfx();
-    uv__backend_destroy_window(window_data);
+// every generator writes its vertices through here (or uv__store_vertex), so the current
+// transform is applied while they are written and never in a second pass
+static inline uv_vertex_t uv__vertex(const uv_context_t *ctx, vec2 pos, vec2 uv, uv__colour_t colour) {
+    if (ctx->transformed) {
+        pos = uv__transform_point(&ctx->transform, pos);
+    }
+    return uv__vertex_local(ctx, pos, uv, colour);
 }
 
-bool uvIsOpen(void) {
-    if (!uv__backend_poll_input(window_data)) {
-        return false;
+// the simd vertex paths write the unpacked layout: { x, y, u, v } { r, g, b, a } and the slot
+#if defined(UV_SIMD_SSE2) && !defined(UV_PACKED_VERTEX) && !defined(UV_PACKED_UV)
+#define UV_SIMD_VERTEX
+#endif
+
+// ====================================================
+
+static void *allocator_udata = NULL;
+
+// == draw list =======================================
+// the draw list is a chain of chunks, each one with its own vertices, indices and batches.
+// normally there is only one chunk, which grows like a vector. in frame arena mode a full
+// chunk is never moved: a bigger one is chained after it, and when the next frame starts
+// the chunks are replaced by a single one as big as all of them together (high-water mark).
+// indices are relative to their batch's first vertex and written as u16, when a batch would
+// go past 65536 vertices a new one is started. only a single draw that big widens the chunk's
+// indices in place to u32 (index memory is always allocated for u32 so this never moves)
+
+#define UV_MIN_CHUNK_VERTICES 1024
+#define UV_MIN_CHUNK_INDICES  1536
+#define UV_MIN_CHUNK_BATCHES  16
+#define UV_MAX_U16_VERTICES   65536
+// draws with at least this many indices start their own batch, so they are copied without an offset
+#define UV_COPY_MIN_INDICES   4096
+#define UV_MIN_CHUNK_INSTANCES 256
+#define UV_MIN_CHUNK_MESHES    16
+
+
+// == frame hash ======================================
+// with skip_unchanged the vertices and indices are hashed in the next uv__drawlist_reserve
+// after they are written, while they are still in cache. the rest is small and only hashed
+// in uvEndFrame. textures, meshes and the window can change without the draw list noticing,
+// so frame_epoch is bumped every time they do
+
+#define UV_HASH_PRIME 1099511628211ull
+
+// fnv-1a over 8 bytes at a time, in 4 lanes so the multiplies don't wait on each other
+static u64 uv__hash(u64 hash, const void *data, usize len) {
+    const u8 *bytes = data;
+    usize i = 0;
+
+    if (len >= 32) {
+        u64 lanes[4] = { hash, hash ^ 1, hash ^ 2, hash ^ 3 };
+        for (; i + 32 <= len; i += 32) {
+            for (int k = 0; k < 4; ++k) {
+                u64 word;
+                UV_MEMCPY(&word, bytes + i + k * 8, sizeof(word));
+                lanes[k] = (lanes[k] ^ word) * UV_HASH_PRIME;
+            }
+        }
+        for (int k = 0; k < 4; ++k) {
+            hash = (hash ^ lanes[k]) * UV_HASH_PRIME;
+        }
     }
 
-    // clear draw batch
-    vecclear(drawdata.batches);
-    vecclear(drawdata.vertices);
-    vecclear(drawdata.indices);
+    for (; i + 8 <= len; i += 8) {
+        u64 word;
+        UV_MEMCPY(&word, bytes + i, sizeof(word));
+        hash = (hash ^ word) * UV_HASH_PRIME;
+    }
 
-    return is_open;
-}
+    for (; i < len; ++i) {
+        hash = (hash ^ bytes[i]) * UV_HASH_PRIME;
+    }
 
-vec2i uvGetWindowSize(void) {
-    return win_size;
+    return hash;
 }
 
-float uvGetDeltaTime(void) {
-    return uv__backend_get_delta_time(window_data);
+static void uv__frame_hash_pending(uv_context_t *ctx, uv__chunk_t *chunk) {
+    uv_drawdata_t *data = &chunk->data;
+    if (chunk->hashed_vtx < data->vtx_count) {
+        ctx->frame_hash = uv__hash(ctx->frame_hash, data->vertices + chunk->hashed_vtx, sizeof(uv_vertex_t) * (data->vtx_count - chunk->hashed_vtx));
+        chunk->hashed_vtx = data->vtx_count;
+    }
+    if (chunk->hashed_idx < data->idx_count) {
+        const u8 *indices = (const u8 *)data->indices + (usize)data->index_size * chunk->hashed_idx;
+        ctx->frame_hash = uv__hash(ctx->frame_hash, indices, (usize)data->index_size * (data->idx_count - chunk->hashed_idx));
+        chunk->hashed_idx = data->idx_count;
+    }
 }
 
-void uvSetClearColour(colour_t colour) {
-    clear_colour = colour;
+// hashes what is left of the chunks of ctx
+static void uv__frame_hash_chunks(uv_context_t *ctx) {
+    for (u32 c = 0; c < ctx->chunk_count; ++c) {
+        uv__chunk_t *chunk = ctx->chunks[c];
+        uv_drawdata_t *data = &chunk->data;
+        uv__frame_hash_pending(ctx, chunk);
+
+        u32 counts[] = { data->vtx_count, data->idx_count, data->index_size, data->batch_count, data->inst_count, data->mesh_count };
+        ctx->frame_hash = uv__hash(ctx->frame_hash, counts, sizeof(counts));
+        ctx->frame_hash = uv__hash(ctx->frame_hash, data->batches, sizeof(uv_batch_t) * data->batch_count);
+        ctx->frame_hash = uv__hash(ctx->frame_hash, chunk->layers, sizeof(u16) * data->batch_count);
+        ctx->frame_hash = uv__hash(ctx->frame_hash, data->instances, sizeof(uv_instance_t) * data->inst_count);
+        ctx->frame_hash = uv__hash(ctx->frame_hash, data->meshes, sizeof(uv_mesh_draw_t) * data->mesh_count);
+    }
 }
 
-void uvEndFrame(void) {
-    drawdata.batch_count = veclen(drawdata.batches);
-    drawdata.vtx_count   = veclen(drawdata.vertices);
-    drawdata.idx_count   = veclen(drawdata.indices);
+// finishes the frame hash, returns true if the frame is the same as the previous one.
+// fragments hash their own draw lists, they are combined in the same order they are drawn
+static bool uv__frame_hash_end(uv_context_t *ctx, colour_t clear) {
+    uv__frame_hash_chunks(ctx);
 
-    if (!drawdata.batch_count || !drawdata.vtx_count || !drawdata.idx_count) {
-        return;
+    for (u32 i = 0; i < veclen(ctx->fragments); ++i) {
+        uv_context_t *frag = ctx->fragments[i];
+        uv__frame_hash_chunks(frag);
+        ctx->frame_hash = uv__hash(ctx->frame_hash, &frag->frame_hash, sizeof(frag->frame_hash));
     }
 
-    uv__backend_draw(clear_colour, &drawdata);
-}
+    ctx->frame_hash = uv__hash(ctx->frame_hash, &clear, sizeof(clear));
+    ctx->frame_hash = uv__hash(ctx->frame_hash, &ctx->frame_epoch, sizeof(ctx->frame_epoch));
+
+    bool unchanged = ctx->has_prev_frame && ctx->frame_hash == ctx->prev_frame_hash;
+    ctx->prev_frame_hash = ctx->frame_hash;
+    ctx->has_prev_frame = true;
+    return unchanged;
+}
+
+static u32 uv__index_size(const uv_context_t *ctx) {
+    return ctx->backend_caps & UV_CAP_INDEX_U16 ? sizeof(u16) : sizeof(u32);
+}
+
+static uv__chunk_t *uv__chunk_alloc(uv_context_t *ctx, u32 vtx_cap, u32 idx_cap, u32 batch_cap) {
+    uv__chunk_t *chunk = UV_CALLOC(1, sizeof(uv__chunk_t), allocator_udata);
+    UV_ASSERT(chunk);
+    chunk->vtx_cap   = vtx_cap   > UV_MIN_CHUNK_VERTICES ? vtx_cap   : UV_MIN_CHUNK_VERTICES;
+    chunk->idx_cap   = idx_cap   > UV_MIN_CHUNK_INDICES  ? idx_cap   : UV_MIN_CHUNK_INDICES;
+    chunk->batch_cap = batch_cap > UV_MIN_CHUNK_BATCHES  ? batch_cap : UV_MIN_CHUNK_BATCHES;
+    chunk->data.vertices = UV_REALLOC(NULL, sizeof(uv_vertex_t) * chunk->vtx_cap,   allocator_udata);
+    chunk->data.indices  = UV_REALLOC(NULL, sizeof(u32)         * chunk->idx_cap,   allocator_udata);
+    chunk->data.batches  = UV_REALLOC(NULL, sizeof(uv_batch_t)  * chunk->batch_cap, allocator_udata);
+    chunk->layers        = UV_REALLOC(NULL, sizeof(u16)         * chunk->batch_cap, allocator_udata);
+    UV_ASSERT(chunk->data.vertices && chunk->data.indices && chunk->data.batches && chunk->layers);
+    chunk->data.index_size = uv__index_size(ctx);
+    return chunk;
+}
+
+static void uv__chunk_free(uv__chunk_t *chunk) {
+    if (!chunk) return;
+    UV_FREE(chunk->data.vertices, allocator_udata);
+    UV_FREE(chunk->data.indices, allocator_udata);
+    UV_FREE(chunk->data.batches, allocator_udata);
+    UV_FREE(chunk->data.instances, allocator_udata);
+    UV_FREE(chunk->data.meshes, allocator_udata);
+    UV_FREE(chunk->layers, allocator_udata);
+    UV_FREE(chunk, allocator_udata);
+}
+
+static void uv__drawlist_reset(uv_context_t *ctx) {
+    if (ctx->chunk_count > 1) {
+        u32 vtx_cap = 0, idx_cap = 0, batch_cap = 0;
+        for (u32 i = 0; i < ctx->chunk_count; ++i) {
+            vtx_cap   += ctx->chunks[i]->vtx_cap;
+            idx_cap   += ctx->chunks[i]->idx_cap;
+            batch_cap += ctx->chunks[i]->batch_cap;
+            uv__chunk_free(ctx->chunks[i]);
+        }
+        vecclear(ctx->chunks);
+        vecpush(ctx->chunks, uv__chunk_alloc(ctx, vtx_cap, idx_cap, batch_cap));
+    }
+    else if (vecempty(ctx->chunks)) {
+        vecpush(ctx->chunks, uv__chunk_alloc(ctx, ctx->options.arena_vertices, ctx->options.arena_indices, 0));
+    }
 
-bool uvIsKeyDown(int key) {
-    assert(key < UV_KEY__COUNT);
-	return keys_state[key];
+    ctx->chunk_count = 1;
+    uv_drawdata_t *data = &ctx->chunks[0]->data;
+    data->batch_count = data->vtx_count = data->idx_count = data->inst_count = data->mesh_count = 0;
+    data->index_size = uv__index_size(ctx);
+    data->unchanged = false;
+    data->next = NULL;
+    ctx->chunks[0]->hashed_vtx = ctx->chunks[0]->hashed_idx = 0;
+    ctx->frame_hash = UV_HASH_SEED;
+
+    // every frame starts without a texture, on layer 0
+    ctx->cur_uv = v4(0, 0, 1, 1);
+    ctx->cur_slot = 0;
+    ctx->cur_layer = 0;
+
+    // and without a clip rect or a transform
+    vecclear(ctx->clip_stack);
+    uv__clip_update(ctx);
+    vecclear(ctx->transform_stack);
+    ctx->transform = (uv__affine_t)UV_AFFINE_IDENTITY;
+    ctx->transformed = false;
+    ctx->culled = 0;
+}
+
+static void uv__drawlist_free(uv_context_t *ctx) {
+    for (u32 i = 0; i < veclen(ctx->chunks); ++i) {
+        uv__chunk_free(ctx->chunks[i]);
+    }
+    vecclear(ctx->chunks);
+    ctx->chunk_count = 0;
 }
 
-bool uvIsKeyUp(int key) {
-    assert(key < UV_KEY__COUNT);
-	return !keys_state[key];
+static uv__chunk_t *uv__drawlist_chunk(uv_context_t *ctx) {
+    if (!ctx->chunk_count) {
+        uv__drawlist_reset(ctx);
+    }
+    return ctx->chunks[ctx->chunk_count - 1];
 }
 
-bool uvIsKeyPressed(int key) {
-    assert(key < UV_KEY__COUNT);
-	bool pressed = !prev_keys_state[key] && keys_state[key];
-	prev_keys_state[key] = keys_state[key];
-	return pressed;
-}
+static uv_batch_t *uv__drawlist_push_batch(uv_context_t *ctx, uv__chunk_t *chunk, texture_t texture) {
+    uv_drawdata_t *data = &chunk->data;
+    if (data->batch_count >= chunk->batch_cap) {
+        // batches are tiny and only referenced by index, so they can always move
+        chunk->batch_cap *= 2;
+        data->batches = UV_REALLOC(data->batches, sizeof(uv_batch_t) * chunk->batch_cap, allocator_udata);
+        chunk->layers = UV_REALLOC(chunk->layers, sizeof(u16) * chunk->batch_cap, allocator_udata);
+        UV_ASSERT(data->batches && chunk->layers);
+    }
 
-bool uvIsMouseDown(int mouse) {
-    assert(mouse < UV_MOUSE__COUNT);
-	return mouse_buttons_down & (1 << (uint32_t)mouse);
+    chunk->layers[data->batch_count] = ctx->cur_layer;
+
+    uv_batch_t *batch = &data->batches[data->batch_count++];
+    *batch = (uv_batch_t){
+        .vtx_start = data->vtx_count,
+        .idx_start = data->idx_count,
+        .inst_start = data->inst_count,
+        .mesh_start = data->mesh_count,
+        .texture = texture,
+#if UV_TEXTURE_SLOTS > 1
+        .textures = { texture },
+        .texture_count = 1,
+#endif
+        .clip = ctx->cur_clip,
+    };
+    return batch;
 }
 
-bool uvIsMouseUp(int mouse) {
-    assert(mouse < UV_MOUSE__COUNT);
-	return !uvIsMouseDown(mouse);
+static uv_batch_t *uv__drawlist_batch(uv_context_t *ctx, uv__chunk_t *chunk) {
+    if (!chunk->data.batch_count) {
+        return uv__drawlist_push_batch(ctx, chunk, 0);
+    }
+    return &chunk->data.batches[chunk->data.batch_count - 1];
 }
 
-vec2i uvGetMousePos(void) {
-	return mouse_position;
+static bool uv__batch_is_empty(const uv_batch_t *batch) {
+    return !batch->idx_count && !batch->inst_count && !batch->mesh_count;
 }
 
-vec2i uvGetMousePosRel(void) {
-	return mouse_relative;
+// starts a batch in chunk with the same textures as the current one of from, so cur_slot
+// stays valid. from can be chunk itself
+static uv_batch_t *uv__drawlist_split_batch(uv_context_t *ctx, uv__chunk_t *chunk, uv__chunk_t *from) {
+    // pushing the batch can move from's batches
+    uv_batch_t prev = *uv__drawlist_batch(ctx, from);
+    uv_batch_t *batch = uv__drawlist_push_batch(ctx, chunk, prev.texture);
+#if UV_TEXTURE_SLOTS > 1
+    UV_MEMCPY(batch->textures, prev.textures, sizeof(prev.textures));
+    batch->texture_count = prev.texture_count;
+#endif
+    return batch;
+}
+
+static void uv__chunk_widen_indices(uv__chunk_t *chunk) {
+    uv_drawdata_t *data = &chunk->data;
+    u8 *bytes = data->indices;
+    // back to front, so every u16 is read before the u32 it becomes overwrites it
+    for (u32 i = data->idx_count; i-- > 0;) {
+        u16 narrow;
+        UV_MEMCPY(&narrow, bytes + i * sizeof(u16), sizeof(u16));
+        u32 wide = narrow;
+        UV_MEMCPY(bytes + i * sizeof(u32), &wide, sizeof(u32));
+    }
+    data->index_size = sizeof(u32);
 }
 
-float uvGetMouseWheel(void) {
-	return mouse_wheel;
-}
+// returns a chunk that can fit vtx_count more vertices and idx_count more indices
+static uv__chunk_t *uv__drawlist_reserve(uv_context_t *ctx, u32 vtx_count, u32 idx_count) {
+    uv__chunk_t *chunk = uv__drawlist_chunk(ctx);
+    uv_drawdata_t *data = &chunk->data;
 
-image_t uvLoadImage(const char *filename) {
-    int x, y, channels;
-    u8 *data = stbi_load(filename, &x, &y, &channels, 4);
+    if (ctx->options.skip_unchanged) {
+        uv__frame_hash_pending(ctx, chunk);
+    }
 
-    return (image_t){
-        .data = (u8 *)data,
-        .width = (u32)x,
-        .height = (u32)y,
-    };
-}
+    u32 vtx_needed = data->vtx_count + vtx_count;
+    u32 idx_needed = data->idx_count + idx_count;
 
-image_t uvLoadImageFromMemory(const u8 *buffer, size_t buflen) {
-    int x, y, channels;
-    u8 *data = stbi_load_from_memory(buffer, (int)buflen, &x, &y, &channels, 4);
-    
-    return (image_t){
-        .data = (u8 *)data,
-        .width = (u32)x,
-        .height = (u32)y,
-    };
-}
+    if (vtx_needed > chunk->vtx_cap || idx_needed > chunk->idx_cap) {
+        if (!ctx->options.frame_arena || !data->vtx_count) {
+            if (vtx_needed > chunk->vtx_cap) {
+                chunk->vtx_cap = chunk->vtx_cap * 2 > vtx_needed ? chunk->vtx_cap * 2 : vtx_needed;
+                data->vertices = UV_REALLOC(data->vertices, sizeof(uv_vertex_t) * chunk->vtx_cap, allocator_udata);
+            }
+            if (idx_needed > chunk->idx_cap) {
+                chunk->idx_cap = chunk->idx_cap * 2 > idx_needed ? chunk->idx_cap * 2 : idx_needed;
+                data->indices = UV_REALLOC(data->indices, sizeof(u32) * chunk->idx_cap, allocator_udata);
+            }
+            UV_ASSERT(data->vertices && data->indices);
+        }
+        else {
+            // frame arena: chain a bigger chunk, continuing with the same textures
+            uv__chunk_t *prev = chunk;
+
+            u32 vtx_cap = chunk->vtx_cap * 2 > vtx_count ? chunk->vtx_cap * 2 : vtx_count;
+            u32 idx_cap = chunk->idx_cap * 2 > idx_count ? chunk->idx_cap * 2 : idx_count;
+            chunk = uv__chunk_alloc(ctx, vtx_cap, idx_cap, chunk->batch_cap);
+            vecpush(ctx->chunks, chunk);
+            ctx->chunk_count++;
+
+            uv__drawlist_split_batch(ctx, chunk, prev);
+            data = &chunk->data;
+        }
+    }
 
-void uvFreeImage(image_t *image) {
-    stbi_image_free(image->data);
-}
+    // instanced and mesh batches don't have vertices
+    uv_batch_t *last = uv__drawlist_batch(ctx, chunk);
+    if (last->inst_count || last->mesh_count) {
+        uv__drawlist_split_batch(ctx, chunk, chunk);
+    }
 
-texture_t uvLoadTexture(const char *filename) {
-    image_t img = uvLoadImage(filename);
-    texture_t tex = uvLoadTextureFromImage(&img);
-    uvFreeImage(&img);
-    return tex;
-}
+    if (data->index_size == sizeof(u16)) {
+        uv_batch_t *cur = uv__drawlist_batch(ctx, chunk);
+        if (data->vtx_count + vtx_count - cur->vtx_start > UV_MAX_U16_VERTICES) {
+            if (vtx_count <= UV_MAX_U16_VERTICES) {
+                uv__drawlist_split_batch(ctx, chunk, chunk);
+            }
+            else {
+                UV_ASSERT(ctx->backend_caps & UV_CAP_INDEX_U32);
+                uv__chunk_widen_indices(chunk);
+            }
+        }
+    }
 
-texture_t uvLoadTextureFromImage(const image_t *img) {
-    return uv__backend_load_texture(img);
+    return chunk;
 }
 
-void uvFreeTexture(texture_t texture) {
-    uv__backend_free_texture(texture);
-}
+// returns the current batch of chunk, ready for count more instances
+static uv_batch_t *uv__drawlist_reserve_instances(uv_context_t *ctx, uv__chunk_t *chunk, u32 count) {
+    uv_drawdata_t *data = &chunk->data;
+    u32 needed = data->inst_count + count;
 
-void uvSetKeyState(int key, bool state) {
-    prev_keys_state[key] = keys_state[key];
-    keys_state[key] = state;
-}
+    if (needed > chunk->inst_cap) {
+        // like batches, instances are only referenced by index so they can always move
+        u32 cap = chunk->inst_cap ? chunk->inst_cap * 2 : UV_MIN_CHUNK_INSTANCES;
+        chunk->inst_cap = cap > needed ? cap : needed;
+        data->instances = UV_REALLOC(data->instances, sizeof(uv_instance_t) * chunk->inst_cap, allocator_udata);
+        UV_ASSERT(data->instances);
+    }
 
-void uvSetMouseState(int btn, bool state) {
-    if (state) mouse_buttons_down |= 1 << btn;
-    else       mouse_buttons_down &= ~(1 << btn);
+    uv_batch_t *cur = uv__drawlist_batch(ctx, chunk);
+    if (cur->idx_count || cur->mesh_count) {
+        cur = uv__drawlist_split_batch(ctx, chunk, chunk);
+    }
+    return cur;
 }
 
-void uvSetMousePosition(vec2i position) {
-    mouse_relative = (vec2i){ position.x - mouse_position.x, position.y - mouse_position.y };
-    mouse_position = position;
-}
+// == index patterns ==================================
+// indices for the bulk primitives, written straight into the draw list.
+// base is the first vertex relative to the current batch
 
-void uvSetTexture(texture_t texture) {
-    if (vecempty(drawdata.batches)) {
-        vecpush(drawdata.batches, (uv_batch_t){
-            .texture = texture
-        });
+static const u16 uv__quad_pattern[6] = { 0, 1, 2, 2, 1, 3 };
+
+// base, base + 1, base + 2, ...
+static void uv__write_sequential_indices(uv_drawdata_t *data, u32 base, u32 count) {
+    u32 i = 0;
+
+    if (data->index_size == sizeof(u16)) {
+        u16 *idx = (u16 *)data->indices + data->idx_count;
+#ifdef UV_SIMD_SSE2
+        __m128i cur  = _mm_add_epi16(_mm_set1_epi16((short)base), _mm_setr_epi16(0, 1, 2, 3, 4, 5, 6, 7));
+        __m128i step = _mm_set1_epi16(8);
+        for (; i + 8 <= count; i += 8) {
+            _mm_storeu_si128((__m128i *)(idx + i), cur);
+            cur = _mm_add_epi16(cur, step);
+        }
+#endif
+        for (; i < count; ++i) idx[i] = (u16)(base + i);
     }
     else {
-        uv_batch_t *cur = &vecback(drawdata.batches);
-        if (cur->texture == texture) {
-            return;
+        u32 *idx = (u32 *)data->indices + data->idx_count;
+#if defined(UV_SIMD_AVX2)
+        __m256i cur  = _mm256_add_epi32(_mm256_set1_epi32((int)base), _mm256_setr_epi32(0, 1, 2, 3, 4, 5, 6, 7));
+        __m256i step = _mm256_set1_epi32(8);
+        for (; i + 8 <= count; i += 8) {
+            _mm256_storeu_si256((__m256i *)(idx + i), cur);
+            cur = _mm256_add_epi32(cur, step);
+        }
+#elif defined(UV_SIMD_SSE2)
+        __m128i cur  = _mm_add_epi32(_mm_set1_epi32((int)base), _mm_setr_epi32(0, 1, 2, 3));
+        __m128i step = _mm_set1_epi32(4);
+        for (; i + 4 <= count; i += 4) {
+            _mm_storeu_si128((__m128i *)(idx + i), cur);
+            cur = _mm_add_epi32(cur, step);
         }
-        vecpush(drawdata.batches, (uv_batch_t){
-            .vtx_start = cur->vtx_start + cur->vtx_count,
-            .idx_start = cur->idx_start + cur->idx_count,
-            .texture = texture
-        });
+#endif
+        for (; i < count; ++i) idx[i] = base + i;
     }
-}
 
-void uvClearTexture(void) {
-    uvSetTexture(0);
+    data->idx_count += count;
+}
+
+// 6 indices for each of count quads, 4 vertices each
+static void uv__write_quad_indices(uv_drawdata_t *data, u32 base, u32 count) {
+    u32 i = 0;
+
+    if (data->index_size == sizeof(u16)) {
+        u16 *idx = (u16 *)data->indices + data->idx_count;
+#ifdef UV_SIMD_SSE2
+        // 4 quads at a time: 24 indices, 3 stores
+        __m128i p0 = _mm_setr_epi16(0, 1, 2,  2,  1,  3,  4,  5);
+        __m128i p1 = _mm_setr_epi16(6, 6, 5,  7,  8,  9,  10, 10);
+        __m128i p2 = _mm_setr_epi16(9, 11, 12, 13, 14, 14, 13, 15);
+        __m128i cur  = _mm_set1_epi16((short)base);
+        __m128i step = _mm_set1_epi16(16);
+        for (; i + 4 <= count; i += 4) {
+            __m128i *dst = (__m128i *)(idx + i * 6);
+            _mm_storeu_si128(dst + 0, _mm_add_epi16(cur, p0));
+            _mm_storeu_si128(dst + 1, _mm_add_epi16(cur, p1));
+            _mm_storeu_si128(dst + 2, _mm_add_epi16(cur, p2));
+            cur = _mm_add_epi16(cur, step);
+        }
+#endif
+        for (; i < count; ++i) {
+            for (int k = 0; k < 6; ++k) {
+                idx[i * 6 + k] = (u16)(base + i * 4 + uv__quad_pattern[k]);
+            }
+        }
+    }
+    else {
+        u32 *idx = (u32 *)data->indices + data->idx_count;
+#if defined(UV_SIMD_AVX2)
+        __m256i p0 = _mm256_setr_epi32(0, 1, 2,  2,  1,  3,  4,  5);
+        __m256i p1 = _mm256_setr_epi32(6, 6, 5,  7,  8,  9,  10, 10);
+        __m256i p2 = _mm256_setr_epi32(9, 11, 12, 13, 14, 14, 13, 15);
+        __m256i cur  = _mm256_set1_epi32((int)base);
+        __m256i step = _mm256_set1_epi32(16);
+        for (; i + 4 <= count; i += 4) {
+            __m256i *dst = (__m256i *)(idx + i * 6);
+            _mm256_storeu_si256(dst + 0, _mm256_add_epi32(cur, p0));
+            _mm256_storeu_si256(dst + 1, _mm256_add_epi32(cur, p1));
+            _mm256_storeu_si256(dst + 2, _mm256_add_epi32(cur, p2));
+            cur = _mm256_add_epi32(cur, step);
+        }
+#elif defined(UV_SIMD_SSE2)
+        // 2 quads at a time: 12 indices, 3 stores
+        __m128i p0 = _mm_setr_epi32(0, 1, 2, 2);
+        __m128i p1 = _mm_setr_epi32(1, 3, 4, 5);
+        __m128i p2 = _mm_setr_epi32(6, 6, 5, 7);
+        __m128i cur  = _mm_set1_epi32((int)base);
+        __m128i step = _mm_set1_epi32(8);
+        for (; i + 2 <= count; i += 2) {
+            __m128i *dst = (__m128i *)(idx + i * 6);
+            _mm_storeu_si128(dst + 0, _mm_add_epi32(cur, p0));
+            _mm_storeu_si128(dst + 1, _mm_add_epi32(cur, p1));
+            _mm_storeu_si128(dst + 2, _mm_add_epi32(cur, p2));
+            cur = _mm_add_epi32(cur, step);
+        }
+#endif
+        for (; i < count; ++i) {
+            for (int k = 0; k < 6; ++k) {
+                idx[i * 6 + k] = base + i * 4 + uv__quad_pattern[k];
+            }
+        }
+    }
+
+    data->idx_count += count * 6;
 }
 
-void uvDrawVertices(uv_vertex_t *vertices, u32 count) {
-    uv_vertex_t *vtx = vecadd(drawdata.vertices, count);
-    UV_MEMCPY(vtx, vertices, sizeof(uv_vertex_t) * count);
+// triangles from the vertex at base to each pair of the count vertices after it, which go
+// clockwise on screen. when closed the last one connects back to the first
+static void uv__write_fan_indices(uv_drawdata_t *data, u32 base, u32 count, bool closed) {
+    u32 tris = closed ? count : count - 1;
 
-    vecreserve(drawdata.indices, count);
-    u32 idx_start = drawdata.indices ? vecback(drawdata.indices) + 1 : 0;
+    if (data->index_size == sizeof(u16)) {
+        u16 *idx = (u16 *)data->indices + data->idx_count;
+        for (u32 i = 0; i < tris; ++i) {
+            idx[i * 3 + 0] = (u16)base;
+            idx[i * 3 + 1] = (u16)(base + 1 + (i + 1 < count ? i + 1 : 0));
+            idx[i * 3 + 2] = (u16)(base + 1 + i);
+        }
+    }
+    else {
+        u32 *idx = (u32 *)data->indices + data->idx_count;
+        for (u32 i = 0; i < tris; ++i) {
+            idx[i * 3 + 0] = base;
+            idx[i * 3 + 1] = base + 1 + (i + 1 < count ? i + 1 : 0);
+            idx[i * 3 + 2] = base + 1 + i;
+        }
+    }
 
-    for (u32 i = 0; i < count; ++i) {
-        vecpush(drawdata.indices, idx_start++);
+    data->idx_count += tris * 3;
+}
+
+// a quad between each two of count pairs of vertices, like uv__quad_pattern but with the
+// quads sharing their sides. when closed the last one connects back to the first pair
+static void uv__write_strip_indices(uv_drawdata_t *data, u32 base, u32 count, bool closed) {
+    u32 quads = closed ? count : count - 1;
+
+    if (data->index_size == sizeof(u16)) {
+        u16 *idx = (u16 *)data->indices + data->idx_count;
+        for (u32 i = 0; i < quads; ++i) {
+            u32 a = base + i * 2;
+            u32 b = base + (i + 1 < count ? i + 1 : 0) * 2;
+            idx[i * 6 + 0] = (u16)a;
+            idx[i * 6 + 1] = (u16)(a + 1);
+            idx[i * 6 + 2] = (u16)b;
+            idx[i * 6 + 3] = (u16)b;
+            idx[i * 6 + 4] = (u16)(a + 1);
+            idx[i * 6 + 5] = (u16)(b + 1);
+        }
     }
+    else {
+        u32 *idx = (u32 *)data->indices + data->idx_count;
+        for (u32 i = 0; i < quads; ++i) {
+            u32 a = base + i * 2;
+            u32 b = base + (i + 1 < count ? i + 1 : 0) * 2;
+            idx[i * 6 + 0] = a;
+            idx[i * 6 + 1] = a + 1;
+            idx[i * 6 + 2] = b;
+            idx[i * 6 + 3] = b;
+            idx[i * 6 + 4] = a + 1;
+            idx[i * 6 + 5] = b + 1;
+        }
+    }
+
+    data->idx_count += quads * 6;
+}
+
+// writes count indices for vertices starting at the end of the chunk, or 0, 1, 2, ... if
+// indices is NULL. they are offset to be relative to the current batch
+static void uv__drawlist_write_indices(uv_context_t *ctx, uv__chunk_t *chunk, const uv_index_t *indices, u32 count) {
+    uv_drawdata_t *data = &chunk->data;
+    u32 base = data->vtx_count - uv__drawlist_batch(ctx, chunk)->vtx_start;
 
-    if (vecempty(drawdata.batches)) {
-        vecpush(drawdata.batches, (uv_batch_t){0});
+    if (!indices) {
+        uv__write_sequential_indices(data, base, count);
+        return;
     }
 
-    uv_batch_t *cur = &vecback(drawdata.batches);
-    cur->vtx_count += count;
-    cur->idx_count += count;
+    if (data->index_size == sizeof(u16)) {
+        u16 *idx = (u16 *)data->indices + data->idx_count;
+        if (!base) for (u32 i = 0; i < count; ++i) idx[i] = (u16)indices[i];
+        else       for (u32 i = 0; i < count; ++i) idx[i] = (u16)(base + indices[i]);
+    }
+    else {
+        u32 *idx = (u32 *)data->indices + data->idx_count;
+        if (!base) UV_MEMCPY(idx, indices, sizeof(u32) * count);
+        else       for (u32 i = 0; i < count; ++i) idx[i] = base + indices[i];
+    }
+
+    data->idx_count += count;
 }
 
-void uvDrawIndices(uv_vertex_t *vertices, u32 vtx_count, uv_index_t *indices, u32 idx_count) {
-    uv_vertex_t *vtx = vecadd(drawdata.vertices, vtx_count);
-    UV_MEMCPY(vtx, vertices, sizeof(uv_vertex_t) * vtx_count);
+// == deferred mode ===================================
+// in deferred mode every batch gets a sort key when the frame ends, and the batches are
+// radix sorted so the ones with the same texture on the same layer end up next to each other.
+// the sorted frame only has new indices and batches: its uv_drawdata_t use the vertices of
+// the chunks they come from, with indices relative to the start of the chunk.
+// key: layer (16) | blend (4) | texture (16) | sequence (28)
 
-    vecreserve(drawdata.indices, idx_count);
-    u32 last_idx = veclen(drawdata.indices);
-    u32 idx_start = last_idx ? drawdata.indices[last_idx - 1] + 1 : 0;
+#define UV_KEY_SEQUENCE_BITS 28
+#define UV_KEY_TEXTURE_SHIFT 28
+#define UV_KEY_BLEND_SHIFT   44
+#define UV_KEY_LAYER_SHIFT   48
+#define UV_KEY_MAX_TEXTURES  (1u << 16)
 
-    for (u32 i = 0; i < idx_count; ++i) {
-        vecpush(drawdata.indices, idx_start + indices[i]);
+// textures get ids in order of first use, ids start from 1 as 0 is an empty slot
+static u32 uv__sort_texture_id(uv_context_t *ctx, texture_t texture, u32 *next_id) {
+    u32 mask = veclen(ctx->sort_textures) - 1;
+    u32 slot = (u32)((texture * 0x9E3779B97F4A7C15ull) >> 32) & mask;
+
+    while (ctx->sort_textures[slot].id && ctx->sort_textures[slot].texture != texture) {
+        slot = (slot + 1) & mask;
     }
-    
-    if (vecempty(drawdata.batches)) {
-        vecpush(drawdata.batches, (uv_batch_t){0});
+
+    if (!ctx->sort_textures[slot].id) {
+        ctx->sort_textures[slot] = (uv__texture_slot_t){ texture, ++(*next_id) };
     }
 
-    uv_batch_t *cur = &vecback(drawdata.batches);
-    cur->vtx_count += vtx_count;
-    cur->idx_count += idx_count;
+    return ctx->sort_textures[slot].id - 1;
 }
 
-void uvDrawLine(vec2 start, vec2 end, float thickness, colour_t colour) {
-    if (thickness <= 0) return;
+// lsd radix sort on the key without the sequence: the sort is stable and the items
+// are already in submission order, so those passes would change nothing
+static void uv__sort_items(uv_context_t *ctx) {
+    u32 count = veclen(ctx->sort_items);
+    vecclear(ctx->sort_temp);
+    (void)vecadd(ctx->sort_temp, count);
 
-    vec2 delta = v2sub(end, start);
-    float length = v2mag(delta);
+    u64 diff = 0;
+    for (u32 i = 1; i < count; ++i) {
+        diff |= ctx->sort_items[i].key ^ ctx->sort_items[0].key;
+    }
 
-    if (length <= 0.f) return;
+    uv__sort_item_t *src = ctx->sort_items;
+    uv__sort_item_t *dst = ctx->sort_temp;
 
-    float scale = thickness / (2.f * length);
-    vec2 radius = { -scale*delta.y, scale*delta.x };
+    for (u32 shift = UV_KEY_SEQUENCE_BITS; shift < 64; shift += 8) {
+        // every key has the same digit, nothing to do
+        if (!((diff >> shift) & 0xff)) continue;
 
-    uv_vertex_t verts[] = {
-        { v2sub(start, radius), v2(0, 0), colour },
-        { v2add(start, radius), v2(0, 1), colour },
-        { v2sub(end, radius),   v2(1, 0), colour },
-        { v2add(end, radius),   v2(1, 1), colour },
-    };
+        u32 offsets[256] = {0};
+        for (u32 i = 0; i < count; ++i) {
+            offsets[(src[i].key >> shift) & 0xff]++;
+        }
 
-    uv_index_t indices[] = { 0, 1, 2, 2, 1, 3 };
+        u32 total = 0;
+        for (u32 d = 0; d < 256; ++d) {
+            u32 n = offsets[d];
+            offsets[d] = total;
+            total += n;
+        }
 
-    uvDrawIndices(verts, (u32)UV_ARRLEN(verts), indices, (u32)UV_ARRLEN(indices));
-}
+        for (u32 i = 0; i < count; ++i) {
+            dst[offsets[(src[i].key >> shift) & 0xff]++] = src[i];
+        }
 
-void uvDrawLineBezier(vec2 start, vec2 end, float thickness, colour_t colour) {
-    UV_TODO("uvDrawLineBezier");
-}
+        uv__sort_item_t *tmp = src;
+        src = dst;
+        dst = tmp;
+    }
 
-void uvDrawLineBezierQuad(vec2 start, vec2 end, vec2 control_point, float thickness, colour_t colour) {
-    UV_TODO("uvDrawLineBezierQuad");
+    if (src != ctx->sort_items) {
+        UV_MEMCPY(ctx->sort_items, src, sizeof(uv__sort_item_t) * count);
+    }
 }
 
-void uvDrawLineBeziercubic(vec2 start, vec2 end, vec2 start_control, vec2 end_control, float thickness, colour_t colour) {
-    UV_TODO("uvDrawLineBeziercubic");
-}
+static uv__sorted_t *uv__sorted_push(uv_context_t *ctx, const uv__chunk_t *src, u32 count) {
+    if (count >= veclen(ctx->sorted_lists)) {
+        vecpush(ctx->sorted_lists, (uv__sorted_t){0});
+    }
 
-void uvDrawCircle(vec2 centre, float radius, colour_t colour) {
-    UV_TODO("uvDrawCircle");
-}
+    uv__sorted_t *out = &ctx->sorted_lists[count];
+    uv_drawdata_t *data = &out->data;
 
-void uvDrawCircleEx(vec2 centre, float radius, colour_t colour, uint segments) {
-    UV_TODO("uvDrawCicleEx");
+    // enough for every index of the chunk, even if they don't all end up in this one
+    if (out->idx_cap < src->data.idx_count) {
+        out->idx_cap = src->data.idx_count;
+        data->indices = UV_REALLOC(data->indices, sizeof(u32) * out->idx_cap, allocator_udata);
+        UV_ASSERT(data->indices);
+    }
+
+    *data = (uv_drawdata_t){
+        .batches = data->batches,
+        .vertices = src->data.vertices,
+        .indices = data->indices,
+        .index_size = src->data.vtx_count <= UV_MAX_U16_VERTICES ? src->data.index_size : sizeof(u32),
+        .vtx_count = src->data.vtx_count,
+        .instances = src->data.instances,
+        .inst_count = src->data.inst_count,
+        .meshes = src->data.meshes,
+        .mesh_count = src->data.mesh_count,
+    };
+
+    return out;
 }
 
-void uvDrawArc(vec2 centre, float radius, float start_angle, float end_angle, uint segments, colour_t colour) {
-    UV_TODO("uvDrawArc");
+// the new batch uses the same textures as src
+static uv_batch_t *uv__sorted_push_batch(uv__sorted_t *out, const uv_batch_t *src) {
+    uv_drawdata_t *data = &out->data;
+    if (data->batch_count >= out->batch_cap) {
+        out->batch_cap = out->batch_cap ? out->batch_cap * 2 : UV_MIN_CHUNK_BATCHES;
+        data->batches = UV_REALLOC(data->batches, sizeof(uv_batch_t) * out->batch_cap, allocator_udata);
+        UV_ASSERT(data->batches);
+    }
+
+    uv_batch_t *batch = &data->batches[data->batch_count++];
+    *batch = (uv_batch_t){
+        .vtx_start = 0,
+        .vtx_count = data->vtx_count,
+        .idx_start = data->idx_count,
+        .inst_start = src->inst_start,
+        .mesh_start = src->mesh_start,
+        .texture = src->texture,
+        .clip = src->clip,
+    };
+#if UV_TEXTURE_SLOTS > 1
+    UV_MEMCPY(batch->textures, src->textures, sizeof(src->textures));
+    batch->texture_count = src->texture_count;
+#endif
+    return batch;
 }
 
-void uvDrawArcLines(vec2 centre, float radius, float start_angle, float end_angle, uint segments, colour_t colour, float thickness) {
-    UV_TODO("uvDrawArcLines");
+// batches with texture slots are only merged if they use the same textures in the same slots
+static bool uv__same_textures(const uv_batch_t *a, const uv_batch_t *b) {
+#if UV_TEXTURE_SLOTS > 1
+    if (a->texture_count != b->texture_count) return false;
+    for (u32 i = 0; i < a->texture_count; ++i) {
+        if (a->textures[i] != b->textures[i]) return false;
+    }
+#endif
+    return a->texture == b->texture;
 }
 
-void uvDrawRing(vec2 centre, float inner_radius, float outer_radius, float start_angle, float end_angle, uint segments, colour_t colour) {
-    UV_TODO("uvDrawRing");
+static bool uv__same_clip(const uv_batch_t *a, const uv_batch_t *b) {
+    return a->clip.x == b->clip.x && a->clip.y == b->clip.y && a->clip.z == b->clip.z && a->clip.w == b->clip.w;
 }
 
-void uvDrawQuad(vec2 pos, vec2 sz, colour_t colour) {
-    uv_vertex_t vertices[] = {
-        { pos,                     { 0, 0 }, colour },
-        { { pos.x, pos.y + sz.y }, { 0, 1 }, colour },
-        { { pos.x + sz.x, pos.y }, { 1, 0 }, colour },
-        { v2add(pos, sz),          { 1, 1 }, colour },
-    };
+// appends the indices of batch, made relative to the start of its chunk
+static void uv__sorted_copy_indices(uv_drawdata_t *dst, const uv_drawdata_t *src, const uv_batch_t *batch) {
+    u32 base = batch->vtx_start;
+    u32 count = batch->idx_count;
 
-    uv_index_t indices[] = { 0, 1, 2, 2, 1, 3 };
+    if (dst->index_size == sizeof(u16)) {
+        // the chunk fits in u16, so its indices are u16 too
+        const u16 *in = (const u16 *)src->indices + batch->idx_start;
+        u16 *out = (u16 *)dst->indices + dst->idx_count;
+        for (u32 i = 0; i < count; ++i) out[i] = (u16)(in[i] + base);
+    }
+    else if (src->index_size == sizeof(u16)) {
+        const u16 *in = (const u16 *)src->indices + batch->idx_start;
+        u32 *out = (u32 *)dst->indices + dst->idx_count;
+        for (u32 i = 0; i < count; ++i) out[i] = in[i] + base;
+    }
+    else {
+        const u32 *in = (const u32 *)src->indices + batch->idx_start;
+        u32 *out = (u32 *)dst->indices + dst->idx_count;
+        for (u32 i = 0; i < count; ++i) out[i] = in[i] + base;
+    }
 
-    uvDrawIndices(vertices, UV_ARRLEN(vertices), indices, UV_ARRLEN(indices));
+    dst->idx_count += count;
 }
 
-void uvDrawQuadRot(vec2 position, vec2 size, colour_t colour, float rotation) {
-    UV_TODO("uvDrawQuadRot");
-}
+// returns the sorted frame, or NULL if the batches are already in the best order
+static uv_drawdata_t *uv__drawlist_sort(uv_context_t *ctx) {
+    u32 chunk_count = veclen(ctx->frame_chunks);
+    u32 batch_count = 0;
+    for (u32 c = 0; c < chunk_count; ++c) {
+        batch_count += ctx->frame_chunks[c]->data.batch_count;
+    }
 
-void uvDrawQuadLines(vec2 position, vec2 size, colour_t colour, float rotation, float thickness) {
-    UV_TODO("uvDrawQuadLines");
-}
+    if (batch_count >= (1u << UV_KEY_SEQUENCE_BITS)) {
+        return NULL;
+    }
 
-void uvDrawQuadRounded(vec2 position, vec2 size, colour_t colour, float rotation, float roundness, uint segments) {
-    UV_TODO("uvDrawQuadRounded");
-}
+    // hash table for texture ids, at most half full
+    u32 table_size = 16;
+    while (table_size < batch_count * 2) table_size *= 2;
+    vecclear(ctx->sort_textures);
+    (void)vecadd(ctx->sort_textures, table_size);
+    for (u32 i = 0; i < table_size; ++i) {
+        ctx->sort_textures[i] = (uv__texture_slot_t){0};
+    }
 
-void uvDrawQuadRoundedLines(vec2 position, vec2 size, colour_t colour, float rotation, float roundness, uint segments, float thickness) {
-    UV_TODO("uvDrawQuadRoundedLines");
-}
+    vecclear(ctx->sort_items);
+    vecreserve(ctx->sort_items, batch_count);
 
-void uvDrawTriangle(vec2 v1, vec2 v2, vec2 v3, colour_t colour) {
-    uv_vertex_t vertices[] = {
-        { v1, v2(0, 0), colour },
-        { v2, v2(0, 0), colour },
-        { v3, v2(0, 0), colour },
-    };
+    u32 texture_count = 0;
+    u32 sequence = 0;
+    bool in_order = true;
 
-    uv_index_t indices[] = { 0, 1, 2 };
+    for (u32 c = 0; c < chunk_count; ++c) {
+        const uv__chunk_t *chunk = ctx->frame_chunks[c];
+        for (u32 b = 0; b < chunk->data.batch_count; ++b) {
+            const uv_batch_t *batch = &chunk->data.batches[b];
+            if (uv__batch_is_empty(batch)) continue;
 
-    uvDrawIndices(vertices, UV_ARRLEN(vertices), indices, UV_ARRLEN(indices));
-}
+            u64 texture = uv__sort_texture_id(ctx, batch->texture, &texture_count);
+            if (texture_count > UV_KEY_MAX_TEXTURES) {
+                return NULL;
+            }
 
-void uvDrawTriangleLines(vec2 v1, vec2 v2, vec2 v3, colour_t colour, float thickness) {
-    UV_TODO("uvDrawTriangleLines");
+            // there is only one blend state for now
+            u64 blend = 0;
+
+            u64 key =
+                (u64)chunk->layers[b] << UV_KEY_LAYER_SHIFT |
+                blend   << UV_KEY_BLEND_SHIFT |
+                texture << UV_KEY_TEXTURE_SHIFT |
+                sequence++;
+
+            if (!vecempty(ctx->sort_items) && key < vecback(ctx->sort_items).key) {
+                in_order = false;
+            }
+
+            vecpush(ctx->sort_items, (uv__sort_item_t){ key, c, b });
+        }
+    }
+
+    if (in_order) {
+        return NULL;
+    }
+
+    uv__sort_items(ctx);
+
+    // rebuild the frame, merging neighbours with the same texture. items from another chunk
+    // need a new uv_drawdata_t as they use different vertices
+    u32 sorted_count = 0;
+    u32 cur_chunk = UINT32_MAX;
+    uv__sorted_t *out = NULL;
+    uv_batch_t *out_batch = NULL;
+    u64 state_mask = ~0ull << UV_KEY_TEXTURE_SHIFT & ~(0xffffull << UV_KEY_LAYER_SHIFT);
+    u64 cur_state = 0;
+
+    for (u32 i = 0; i < veclen(ctx->sort_items); ++i) {
+        const uv__sort_item_t *item = &ctx->sort_items[i];
+        const uv__chunk_t *src = ctx->frame_chunks[item->chunk];
+        const uv_batch_t *batch = &src->data.batches[item->batch];
+
+        if (item->chunk != cur_chunk) {
+            out = uv__sorted_push(ctx, src, sorted_count++);
+            cur_chunk = item->chunk;
+            out_batch = NULL;
+        }
+
+        // texture, blend and clip rect, the layer doesn't break a batch. instances and mesh draws
+        // are used straight from the chunk, so they only merge if they come one after the other
+        u64 state = item->key & state_mask;
+        bool merge = out_batch && state == cur_state && uv__same_textures(out_batch, batch) && uv__same_clip(out_batch, batch);
+        if (batch->inst_count) {
+            merge = merge && out_batch->inst_count && out_batch->inst_start + out_batch->inst_count == batch->inst_start;
+        }
+        else if (batch->mesh_count) {
+            merge = merge && out_batch->mesh_count && out_batch->mesh_start + out_batch->mesh_count == batch->mesh_start;
+        }
+        else {
+            merge = merge && !out_batch->inst_count && !out_batch->mesh_count;
+        }
+
+        if (!merge) {
+            out_batch = uv__sorted_push_batch(out, batch);
+            cur_state = state;
+        }
+
+        if (batch->inst_count) {
+            out_batch->inst_count += batch->inst_count;
+        }
+        else if (batch->mesh_count) {
+            out_batch->mesh_count += batch->mesh_count;
+        }
+        else {
+            uv__sorted_copy_indices(&out->data, &src->data, batch);
+            out_batch->idx_count += batch->idx_count;
+        }
+    }
+
+    // sorted_lists can move while it's filled, so they are only linked at the end
+    for (u32 i = 0; i + 1 < sorted_count; ++i) {
+        ctx->sorted_lists[i].data.next = &ctx->sorted_lists[i + 1].data;
+    }
+
+    return &ctx->sorted_lists[0].data;
+}
+
+static void uv__drawlist_sort_free(uv_context_t *ctx) {
+    for (u32 i = 0; i < veclen(ctx->sorted_lists); ++i) {
+        UV_FREE(ctx->sorted_lists[i].data.indices, allocator_udata);
+        UV_FREE(ctx->sorted_lists[i].data.batches, allocator_udata);
+    }
+    ctx->sorted_lists = vecfree(ctx->sorted_lists);
+    ctx->sort_items = vecfree(ctx->sort_items);
+    ctx->sort_temp = vecfree(ctx->sort_temp);
+    ctx->sort_textures = vecfree(ctx->sort_textures);
+}
+
+// == fragments =======================================
+// a fragment is a context with only a draw list, so another thread can record primitives
+// without locking. in uvEndFrame the frame is made of the chunks of the context followed by
+// the ones of each fragment, in the order the fragments were created. chunks are already
+// separate uv_drawdata_t with offsets relative to themselves, so they are only linked and
+// nothing has to be copied or rebased
+
+static void uv__frame_gather_chunks(uv_context_t *ctx, const uv_context_t *from) {
+    for (u32 c = 0; c < from->chunk_count; ++c) {
+        uv__chunk_t *chunk = from->chunks[c];
+        const uv_drawdata_t *data = &chunk->data;
+        if (data->idx_count || data->inst_count || data->mesh_count) {
+            vecpush(ctx->frame_chunks, chunk);
+        }
+    }
+}
+
+// links the chunks in frame_chunks, returns false if there are none
+static bool uv__frame_link(uv_context_t *ctx) {
+    u32 count = veclen(ctx->frame_chunks);
+    for (u32 i = 0; i < count; ++i) {
+        ctx->frame_chunks[i]->data.next = i + 1 < count ? &ctx->frame_chunks[i + 1]->data : NULL;
+    }
+
+    return count > 0;
+}
+
+// collects the chunks of the frame in frame_chunks and links them, returns false if it's empty
+static bool uv__frame_gather(uv_context_t *ctx) {
+    vecclear(ctx->frame_chunks);
+    uv__frame_gather_chunks(ctx, ctx);
+    for (u32 i = 0; i < veclen(ctx->fragments); ++i) {
+        uv__frame_gather_chunks(ctx, ctx->fragments[i]);
+    }
+    return uv__frame_link(ctx);
+}
+
+// every fragment starts the frame with its context
+static void uv__fragments_reset(uv_context_t *ctx) {
+    for (u32 i = 0; i < veclen(ctx->fragments); ++i) {
+        uv_context_t *frag = ctx->fragments[i];
+        frag->options = ctx->options;
+        frag->backend_caps = ctx->backend_caps;
+        frag->win_size = ctx->win_size;
+        uv__drawlist_reset(frag);
+    }
+}
+
+static void uv__fragment_unlink(uv_context_t *frag) {
+    uv_context_t *ctx = frag->parent;
+    u32 count = veclen(ctx->fragments);
+    for (u32 i = 0; i < count; ++i) {
+        if (ctx->fragments[i] == frag) {
+            // keep the order of the others
+            UV_MEMMOVE(&ctx->fragments[i], &ctx->fragments[i + 1], sizeof(uv_context_t *) * (count - i - 1));
+            (void)vecpop(ctx->fragments);
+            break;
+        }
+    }
+    frag->parent = NULL;
+}
+
+// == readback ========================================
+// uvReadPixelsAsync only asks for a copy, it's sent to the backend with the next frame that is
+// drawn. the backend's staging slots are used as a ring, so the copies come back in the order
+// they were asked for and polling never has to wait for the gpu
+
+static void uv__readback_send(uv_context_t *ctx) {
+    if (!ctx->readback_requested) return;
+    ctx->readback_requested = false;
+
+    u32 slot = (ctx->readback_head + ctx->readback_count) % UV_READBACK_SLOTS;
+    ctx->readback_count++;
+    uv__backend_read_pixels(ctx->gfx_data, slot);
+}
+
+bool uvCtxReadPixelsAsync(uv_context_t *ctx) {
+    if (ctx->parent || !(ctx->backend_caps & UV_CAP_READBACK)) return false;
+    // asking again for the same frame still gives a single copy
+    if (ctx->readback_requested) return true;
+    if (ctx->readback_count >= UV_READBACK_SLOTS) return false;
+
+    ctx->readback_requested = true;
+    return true;
+}
+
+bool uvCtxPollReadPixels(uv_context_t *ctx, image_t *image) {
+    if (!ctx->readback_count) return false;
+
+    u32 slot = ctx->readback_head;
+    u32 width, height;
+    if (!uv__backend_poll_pixels(ctx->gfx_data, slot, &width, &height)) return false;
+
+    vecclear(ctx->readback_pixels);
+    u8 *pixels = vecadd(ctx->readback_pixels, width * height * 4);
+    uv__backend_get_pixels(ctx->gfx_data, slot, pixels);
+
+    ctx->readback_head = (ctx->readback_head + 1) % UV_READBACK_SLOTS;
+    ctx->readback_count--;
+    *image = (image_t){ .data = pixels, .width = width, .height = height };
+    return true;
+}
+
+// == textures ========================================
+// a texture_t points to a uv__texture_t. in atlas mode small images are packed in shared
+// pages with a skyline packer and the texture only has the uv rectangle of its image inside
+// of the page, so different sprites on the same page are drawn in the same batch.
+// a page's skyline is only reset once all of its textures are freed
+
+#define UV_ATLAS_PAGE_SIZE 2048
+#define UV_ATLAS_MAX_SIZE  256
+// transparent border around every image, so nothing bleeds from its neighbours
+#define UV_ATLAS_PADDING   1
+
+typedef struct uv__texture_t {
+    texture_t handle;
+    vec4 uv;
+    u32 width, height;
+    int page;
+    // made with uvCreateRenderTexture
+    bool render_target;
+} uv__texture_t;
+
+static u32 uv__atlas_page_size(const uv_context_t *ctx) {
+    return ctx->options.atlas_page_size ? ctx->options.atlas_page_size : UV_ATLAS_PAGE_SIZE;
+}
+
+// never more than what fits in a page with its padding
+static u32 uv__atlas_max_size(const uv_context_t *ctx) {
+    u32 max_size = ctx->options.atlas_max_size ? ctx->options.atlas_max_size : UV_ATLAS_MAX_SIZE;
+    u32 page_size = uv__atlas_page_size(ctx);
+    u32 fits = page_size > UV_ATLAS_PADDING * 2 ? page_size - UV_ATLAS_PADDING * 2 : 0;
+    return max_size < fits ? max_size : fits;
+}
+
+static void uv__skyline_reset(uv_context_t *ctx, uv__atlas_page_t *page) {
+    vecclear(page->skyline);
+    vecpush(page->skyline, (uv__skyline_t){ 0, 0, uv__atlas_page_size(ctx) });
+}
+
+// y a w * h rectangle would have if placed on node i, UINT32_MAX if it doesn't fit
+static u32 uv__skyline_fit(uv_context_t *ctx, uv__atlas_page_t *page, u32 i, u32 w, u32 h) {
+    uv__skyline_t *nodes = page->skyline;
+    u32 size = uv__atlas_page_size(ctx);
+
+    if (nodes[i].x + w > size) {
+        return UINT32_MAX;
+    }
+
+    // the nodes always cover the whole width, so this can't go past the last one
+    u32 y = 0;
+    for (u32 left = w; left > 0; ++i) {
+        if (nodes[i].y > y) y = nodes[i].y;
+        if (y + h > size) return UINT32_MAX;
+        left = nodes[i].width >= left ? 0 : left - nodes[i].width;
+    }
+
+    return y;
+}
+
+static void uv__skyline_remove(uv__atlas_page_t *page, u32 i) {
+    u32 len = veclen(page->skyline);
+    UV_MEMMOVE(&page->skyline[i], &page->skyline[i + 1], sizeof(uv__skyline_t) * (len - i - 1));
+    uv__veclen(page->skyline)--;
+}
+
+// bottom-left: the lowest top edge wins, then the narrowest node
+static bool uv__skyline_insert(uv_context_t *ctx, uv__atlas_page_t *page, u32 w, u32 h, u32 *out_x, u32 *out_y) {
+    u32 best = UINT32_MAX, best_y = UINT32_MAX, best_width = UINT32_MAX;
+
+    for (u32 i = 0; i < veclen(page->skyline); ++i) {
+        u32 y = uv__skyline_fit(ctx, page, i, w, h);
+        if (y == UINT32_MAX) continue;
+        if (y < best_y || (y == best_y && page->skyline[i].width < best_width)) {
+            best = i;
+            best_y = y;
+            best_width = page->skyline[i].width;
+        }
+    }
+
+    if (best == UINT32_MAX) {
+        return false;
+    }
+
+    uv__skyline_t node = { page->skyline[best].x, best_y + h, w };
+    *out_x = node.x;
+    *out_y = best_y;
+
+    vecpush(page->skyline, node);
+    uv__skyline_t *nodes = page->skyline;
+    u32 len = veclen(nodes);
+    UV_MEMMOVE(&nodes[best + 1], &nodes[best], sizeof(uv__skyline_t) * (len - best - 1));
+    nodes[best] = node;
+
+    // shrink or remove the nodes now covered by the new one
+    for (u32 i = best + 1; i < veclen(page->skyline);) {
+        uv__skyline_t *prev = &page->skyline[i - 1];
+        uv__skyline_t *cur = &page->skyline[i];
+        u32 prev_end = prev->x + prev->width;
+        if (cur->x >= prev_end) break;
+
+        u32 shrink = prev_end - cur->x;
+        if (cur->width > shrink) {
+            cur->x += shrink;
+            cur->width -= shrink;
+            break;
+        }
+        uv__skyline_remove(page, i);
+    }
+
+    // merge neighbours at the same height
+    for (u32 i = 0; i + 1 < veclen(page->skyline);) {
+        if (page->skyline[i].y == page->skyline[i + 1].y) {
+            page->skyline[i].width += page->skyline[i + 1].width;
+            uv__skyline_remove(page, i + 1);
+        }
+        else {
+            ++i;
+        }
+    }
+
+    return true;
+}
+
+// finds space for a w * h rectangle, adding a page if none of them has it
+static int uv__atlas_alloc(uv_context_t *ctx, u32 w, u32 h, u32 *x, u32 *y) {
+    u32 size = uv__atlas_page_size(ctx);
+    // a new page wouldn't have room for it either
+    if (w > size || h > size) {
+        return -1;
+    }
+
+    for (u32 i = 0; i < veclen(ctx->atlas_pages); ++i) {
+        if (uv__skyline_insert(ctx, &ctx->atlas_pages[i], w, h, x, y)) {
+            return (int)i;
+        }
+    }
+
+    image_t blank = {
+        .data = UV_CALLOC(1, sizeof(u32) * size * size, allocator_udata),
+        .width = size,
+        .height = size,
+    };
+    if (!blank.data) {
+        return -1;
+    }
+
+    texture_t handle = uv__backend_load_texture(ctx->gfx_data, &blank);
+    UV_FREE(blank.data, allocator_udata);
+    if (!handle) {
+        return -1;
+    }
+
+    uv__atlas_page_t page = { .handle = handle };
+    uv__skyline_reset(ctx, &page);
+    vecpush(ctx->atlas_pages, page);
+
+    uv__atlas_page_t *last = &ctx->atlas_pages[veclen(ctx->atlas_pages) - 1];
+    if (!uv__skyline_insert(ctx, last, w, h, x, y)) {
+        return -1;
+    }
+    return (int)veclen(ctx->atlas_pages) - 1;
+}
+
+static bool uv__atlas_add(uv_context_t *ctx, uv__texture_t *tex, const image_t *img) {
+    const u32 pad = UV_ATLAS_PADDING;
+    u32 w = img->width + pad * 2;
+    u32 h = img->height + pad * 2;
+    u32 x, y;
+
+    int page = uv__atlas_alloc(ctx, w, h, &x, &y);
+    if (page < 0) {
+        return false;
+    }
+
+    // upload the padding too, the page could have old images in it
+    image_t padded = {
+        .data = UV_CALLOC(1, sizeof(u32) * w * h, allocator_udata),
+        .width = w,
+        .height = h,
+    };
+    if (!padded.data) {
+        return false;
+    }
+
+    for (u32 row = 0; row < img->height; ++row) {
+        UV_MEMCPY(
+            padded.data + ((row + pad) * w + pad) * 4,
+            img->data + row * img->width * 4,
+            img->width * 4
+        );
+    }
+
+    uv__atlas_page_t *p = &ctx->atlas_pages[page];
+    uv__backend_update_texture(ctx->gfx_data, p->handle, &padded, x, y);
+    UV_FREE(padded.data, allocator_udata);
+    p->live++;
+
+    float size = (float)uv__atlas_page_size(ctx);
+    tex->handle = p->handle;
+    tex->page = page;
+    tex->uv = v4(
+        (float)(x + pad) / size,
+        (float)(y + pad) / size,
+        (float)(x + pad + img->width) / size,
+        (float)(y + pad + img->height) / size
+    );
+    return true;
+}
+
+static void uv__atlas_free(uv_context_t *ctx) {
+    for (u32 i = 0; i < veclen(ctx->atlas_pages); ++i) {
+        uv__backend_free_texture(ctx->gfx_data, ctx->atlas_pages[i].handle);
+        ctx->atlas_pages[i].skyline = vecfree(ctx->atlas_pages[i].skyline);
+    }
+    ctx->atlas_pages = vecfree(ctx->atlas_pages);
+}
+
+void uvCtxCreateWindow(uv_context_t *ctx, const char *name, int width, int height, const uv_options_t *opts) {
+    if (opts) ctx->options = *opts;
+    ctx->win_size = (vec2i){ width, height };
+
+    ctx->window_data = uv__backend_create_window(ctx, name, width, height);
+    ctx->gfx_data = uv__backend_init_gfx(ctx->window_data, width, height);
+    ctx->backend_caps = uv__backend_get_caps(ctx->gfx_data);
+}
+
+void uvCtxCloseWindow(uv_context_t *ctx) {
+    ctx->is_open = false;
+}
+
+void uvCtxOnWindowResize(uv_context_t *ctx, int new_width, int new_height) {
+    ctx->win_size = (vec2i){ new_width, new_height };
+    uv__clip_update(ctx);
+    ctx->frame_epoch++;
+    // the window can be resized while it's created, before the gfx exists
+    if (ctx->gfx_data) {
+        uv__backend_resize_gfx(ctx->gfx_data, new_width, new_height);
+    }
+}
+
+uv_context_t *uvCtxCreateFragment(uv_context_t *ctx) {
+    uv_context_t *frag = uvCreateContext();
+    if (frag) {
+        frag->parent = ctx;
+        frag->options = ctx->options;
+        frag->backend_caps = ctx->backend_caps;
+        frag->win_size = ctx->win_size;
+        uv__clip_update(frag);
+        vecpush(ctx->fragments, frag);
+    }
+    return frag;
+}
+
+void uvCtxCleanup(uv_context_t *ctx) {
+    uv__tess_free(ctx);
+    ctx->clip_stack = vecfree(ctx->clip_stack);
+    ctx->transform_stack = vecfree(ctx->transform_stack);
+    if (ctx->parent) {
+        uv__fragment_unlink(ctx);
+        uv__drawlist_free(ctx);
+        ctx->chunks = vecfree(ctx->chunks);
+        return;
+    }
+    if (!ctx->gfx_data) {
+        return;
+    }
+    while (!vecempty(ctx->fragments)) {
+        uvDestroyContext(vecback(ctx->fragments));
+    }
+    ctx->fragments = vecfree(ctx->fragments);
+    ctx->frame_chunks = vecfree(ctx->frame_chunks);
+    uv__atlas_free(ctx);
+    uv__glyph_atlas_free(ctx);
+    uv__target_free(ctx);
+    ctx->readback_pixels = vecfree(ctx->readback_pixels);
+    ctx->readback_requested = false;
+    ctx->readback_count = 0;
+    uv__backend_cleanup_gfx(ctx->gfx_data);
+    uv__backend_destroy_window(ctx->window_data);
+    uv__drawlist_free(ctx);
+    uv__drawlist_sort_free(ctx);
+    ctx->chunks = vecfree(ctx->chunks);
+    ctx->gfx_data = NULL;
+    ctx->window_data = NULL;
+}
+
+bool uvCtxIsOpen(uv_context_t *ctx) {
+    if (!uv__backend_poll_input(ctx->window_data)) {
+        return false;
+    }
+
+    // clear draw list
+    uv__drawlist_reset(ctx);
+    uv__fragments_reset(ctx);
+    ctx->frame_count++;
+
+    return ctx->is_open;
+}
+
+vec2i uvCtxGetWindowSize(uv_context_t *ctx) {
+    return ctx->win_size;
+}
+
+float uvCtxGetDeltaTime(uv_context_t *ctx) {
+    return uv__backend_get_delta_time(ctx->window_data);
+}
+
+void uvCtxSetClearColour(uv_context_t *ctx, colour_t colour) {
+    ctx->clear_colour = colour;
+}
+
+void uvCtxEndFrame(uv_context_t *ctx) {
+    UV_ASSERT(!ctx->target.texture && "uvEndRenderTexture wasn't called");
+
+    if (!uv__frame_gather(ctx)) {
+        ctx->has_prev_frame = false;
+        return;
+    }
+
+    uv_drawdata_t *sorted = ctx->options.deferred ? uv__drawlist_sort(ctx) : NULL;
+    uv_drawdata_t *frame = sorted ? sorted : &ctx->frame_chunks[0]->data;
+
+    // a chunk that is first now could have been flagged in an older frame
+    frame->unchanged = ctx->options.skip_unchanged && uv__frame_hash_end(ctx, ctx->clear_colour);
+
+    uv__readback_send(ctx);
+    uv__backend_draw(ctx->gfx_data, ctx->clear_colour, frame);
+}
+
+bool uvCtxIsKeyDown(uv_context_t *ctx, int key) {
+    assert(key < UV_KEY__COUNT);
+	return ctx->keys_state[key];
+}
+
+bool uvCtxIsKeyUp(uv_context_t *ctx, int key) {
+    assert(key < UV_KEY__COUNT);
+	return !ctx->keys_state[key];
+}
+
+bool uvCtxIsKeyPressed(uv_context_t *ctx, int key) {
+    assert(key < UV_KEY__COUNT);
+	bool pressed = !ctx->prev_keys_state[key] && ctx->keys_state[key];
+	ctx->prev_keys_state[key] = ctx->keys_state[key];
+	return pressed;
+}
+
+bool uvCtxIsMouseDown(uv_context_t *ctx, int mouse) {
+    assert(mouse < UV_MOUSE__COUNT);
+	return ctx->mouse_buttons_down & (1 << (uint32_t)mouse);
+}
+
+bool uvCtxIsMouseUp(uv_context_t *ctx, int mouse) {
+    assert(mouse < UV_MOUSE__COUNT);
+	return !uvCtxIsMouseDown(ctx, mouse);
+}
+
+vec2i uvCtxGetMousePos(uv_context_t *ctx) {
+	return ctx->mouse_position;
+}
+
+vec2i uvCtxGetMousePosRel(uv_context_t *ctx) {
+	return ctx->mouse_relative;
+}
+
+float uvCtxGetMouseWheel(uv_context_t *ctx) {
+	return ctx->mouse_wheel;
+}
+
+image_t uvLoadImage(const char *filename) {
+    int x, y, channels;
+    u8 *data = stbi_load(filename, &x, &y, &channels, 4);
+
+    return (image_t){
+        .data = (u8 *)data,
+        .width = (u32)x,
+        .height = (u32)y,
+    };
+}
+
+image_t uvLoadImageFromMemory(const u8 *buffer, size_t buflen) {
+    int x, y, channels;
+    u8 *data = stbi_load_from_memory(buffer, (int)buflen, &x, &y, &channels, 4);
+    
+    return (image_t){
+        .data = (u8 *)data,
+        .width = (u32)x,
+        .height = (u32)y,
+    };
+}
+
+void uvFreeImage(image_t *image) {
+    stbi_image_free(image->data);
+}
+
+texture_t uvCtxLoadTexture(uv_context_t *ctx, const char *filename) {
+    image_t img = uvLoadImage(filename);
+    texture_t tex = uvCtxLoadTextureFromImage(ctx, &img);
+    uvFreeImage(&img);
+    return tex;
+}
+
+texture_t uvCtxLoadTextureFromImage(uv_context_t *ctx, const image_t *img) {
+    if (!img || !img->data) return 0;
+
+    // it can end up in an atlas page that is already in use
+    ctx->frame_epoch++;
+
+    uv__texture_t *tex = UV_CALLOC(1, sizeof(uv__texture_t), allocator_udata);
+    if (!tex) return 0;
+
+    tex->width = img->width;
+    tex->height = img->height;
+    tex->page = -1;
+    tex->uv = v4(0, 0, 1, 1);
+
+    u32 max_size = uv__atlas_max_size(ctx);
+    bool small = img->width <= max_size && img->height <= max_size;
+    if (ctx->options.texture_atlas && small && uv__atlas_add(ctx, tex, img)) {
+        return (texture_t)tex;
+    }
+
+    tex->handle = uv__backend_load_texture(ctx->gfx_data, img);
+    if (!tex->handle) {
+        UV_FREE(tex, allocator_udata);
+        return 0;
+    }
+
+    return (texture_t)tex;
+}
+
+void uvCtxFreeTexture(uv_context_t *ctx, texture_t texture) {
+    uv__texture_t *tex = (uv__texture_t *)texture;
+    if (!tex) return;
+
+    UV_ASSERT(tex != ctx->target.texture && "the render texture is still being drawn into");
+
+    // the handle could be given to a new texture
+    ctx->frame_epoch++;
+
+    if (tex->page >= 0) {
+        uv__atlas_page_t *page = &ctx->atlas_pages[tex->page];
+        if (--page->live == 0) {
+            uv__skyline_reset(ctx, page);
+        }
+    }
+    else {
+        uv__backend_free_texture(ctx->gfx_data, tex->handle);
+    }
+
+    UV_FREE(tex, allocator_udata);
+}
+
+vec2i uvGetTextureSize(texture_t texture) {
+    const uv__texture_t *tex = (const uv__texture_t *)texture;
+    return tex ? (vec2i){ (int)tex->width, (int)tex->height } : (vec2i){ 1, 1 };
+}
+
+vec4 uvGetTextureUV(texture_t texture) {
+    const uv__texture_t *tex = (const uv__texture_t *)texture;
+    return tex ? tex->uv : v4(0, 0, 1, 1);
+}
+
+void uvCtxSetKeyState(uv_context_t *ctx, int key, bool state) {
+    ctx->prev_keys_state[key] = ctx->keys_state[key];
+    ctx->keys_state[key] = state;
+}
+
+void uvCtxSetMouseState(uv_context_t *ctx, int btn, bool state) {
+    if (state) ctx->mouse_buttons_down |= 1 << btn;
+    else       ctx->mouse_buttons_down &= ~(1 << btn);
+}
+
+void uvCtxSetMousePosition(uv_context_t *ctx, vec2i position) {
+    ctx->mouse_relative = (vec2i){ position.x - ctx->mouse_position.x, position.y - ctx->mouse_position.y };
+    ctx->mouse_position = position;
+}
+
+// texture is the backend's handle, uv its rectangle in it
+static void uv__set_texture(uv_context_t *ctx, texture_t texture, vec4 uv) {
+    uv__chunk_t *chunk = uv__drawlist_chunk(ctx);
+    ctx->cur_uv = uv;
+
+    if (chunk->data.batch_count) {
+        uv_batch_t *cur = uv__drawlist_batch(ctx, chunk);
+#if UV_TEXTURE_SLOTS > 1
+        // the batch only breaks once all of its slots are taken
+        for (u32 i = 0; i < cur->texture_count; ++i) {
+            if (cur->textures[i] == texture) {
+                ctx->cur_slot = i;
+                return;
+            }
+        }
+        if (!uv__batch_is_empty(cur) && cur->texture_count < UV_TEXTURE_SLOTS) {
+            ctx->cur_slot = cur->texture_count++;
+            cur->textures[ctx->cur_slot] = texture;
+            return;
+        }
+#else
+        if (cur->texture == texture) {
+            return;
+        }
+#endif
+        // nothing was drawn with the previous texture, reuse the batch
+        if (uv__batch_is_empty(cur)) {
+            cur->texture = texture;
+#if UV_TEXTURE_SLOTS > 1
+            cur->textures[0] = texture;
+            cur->texture_count = 1;
+#endif
+            ctx->cur_slot = 0;
+            return;
+        }
+    }
+
+    ctx->cur_slot = 0;
+    uv__drawlist_push_batch(ctx, chunk, texture);
+}
+
+// the backend's handle of the texture in use
+static texture_t uv__get_texture(uv_context_t *ctx) {
+    const uv_batch_t *cur = uv__drawlist_batch(ctx, uv__drawlist_chunk(ctx));
+#if UV_TEXTURE_SLOTS > 1
+    return cur->textures[ctx->cur_slot];
+#else
+    return cur->texture;
+#endif
+}
+
+void uvCtxSetTexture(uv_context_t *ctx, texture_t texture) {
+    // batches use the backend's handle, so textures on the same atlas page share them
+    const uv__texture_t *tex = (const uv__texture_t *)texture;
+    uv__set_texture(ctx, tex ? tex->handle : 0, tex ? tex->uv : v4(0, 0, 1, 1));
+}
+
+void uvCtxClearTexture(uv_context_t *ctx) {
+    uvCtxSetTexture(ctx, 0);
+}
+
+void uvCtxSetLayer(uv_context_t *ctx, u16 layer) {
+    if (!ctx->options.deferred || layer == ctx->cur_layer) {
+        return;
+    }
+
+    ctx->cur_layer = layer;
+
+    uv__chunk_t *chunk = uv__drawlist_chunk(ctx);
+    if (!chunk->data.batch_count) {
+        return;
+    }
+
+    uv_batch_t *cur = uv__drawlist_batch(ctx, chunk);
+    // nothing was drawn on the previous layer, reuse the batch
+    if (uv__batch_is_empty(cur)) {
+        chunk->layers[chunk->data.batch_count - 1] = layer;
+        return;
+    }
+
+    uv__drawlist_split_batch(ctx, chunk, chunk);
+}
+
+u16 uvCtxGetLayer(uv_context_t *ctx) {
+    return ctx->cur_layer;
+}
+
+// == render textures =================================
+// while a render texture is drawn into the context has a draw list of its own: the frame's
+// one and the state that goes with it are swapped with the ones in ctx->target, and are back
+// once the texture is drawn in uvEndRenderTexture. fragments keep drawing to the frame
+
+#define uv__swap(a, b) do {                      \
+        u8 uv__tmp[sizeof(a)];                   \
+        UV_MEMCPY(uv__tmp, &(a), sizeof(a));     \
+        UV_MEMCPY(&(a), &(b), sizeof(a));        \
+        UV_MEMCPY(&(b), uv__tmp, sizeof(a));     \
+    } while (0)
+
+static void uv__target_swap(uv_context_t *ctx) {
+    uv__target_t *t = &ctx->target;
+    uv__swap(ctx->chunks, t->chunks);
+    uv__swap(ctx->chunk_count, t->chunk_count);
+    uv__swap(ctx->clip_stack, t->clip_stack);
+    uv__swap(ctx->transform_stack, t->transform_stack);
+    uv__swap(ctx->transform, t->transform);
+    uv__swap(ctx->transformed, t->transformed);
+    uv__swap(ctx->cur_uv, t->cur_uv);
+    uv__swap(ctx->cur_slot, t->cur_slot);
+    uv__swap(ctx->cur_layer, t->cur_layer);
+    uv__swap(ctx->frame_hash, t->frame_hash);
+    uv__swap(ctx->culled, t->culled);
+    uv__swap(ctx->win_size, t->win_size);
+}
+
+static void uv__target_free(uv_context_t *ctx) {
+    uv__target_t *t = &ctx->target;
+    for (u32 i = 0; i < veclen(t->chunks); ++i) {
+        uv__chunk_free(t->chunks[i]);
+    }
+    t->chunks = vecfree(t->chunks);
+    t->clip_stack = vecfree(t->clip_stack);
+    t->transform_stack = vecfree(t->transform_stack);
+}
+
+texture_t uvCtxCreateRenderTexture(uv_context_t *ctx, u32 width, u32 height) {
+    if (!(ctx->backend_caps & UV_CAP_RENDER_TEXTURES) || !width || !height) return 0;
+
+    uv__texture_t *tex = UV_CALLOC(1, sizeof(uv__texture_t), allocator_udata);
+    if (!tex) return 0;
+
+    tex->width = width;
+    tex->height = height;
+    tex->page = -1;
+    tex->uv = v4(0, 0, 1, 1);
+    tex->render_target = true;
+
+    tex->handle = uv__backend_create_render_texture(ctx->gfx_data, width, height);
+    if (!tex->handle) {
+        UV_FREE(tex, allocator_udata);
+        return 0;
+    }
+
+    return (texture_t)tex;
+}
+
+void uvCtxBeginRenderTexture(uv_context_t *ctx, texture_t target, colour_t clear_colour) {
+    uv__texture_t *tex = (uv__texture_t *)target;
+    UV_ASSERT(!ctx->parent && "fragments can't draw to render textures");
+    UV_ASSERT(!ctx->target.texture && "render textures can't be nested");
+    if (!tex || !tex->render_target) return;
+
+    uv__target_swap(ctx);
+    ctx->target.texture = tex;
+    ctx->target.clear_colour = clear_colour;
+
+    // the clip rects and the culling are relative to the texture
+    ctx->win_size = (vec2i){ (int)tex->width, (int)tex->height };
+    uv__drawlist_reset(ctx);
+}
+
+void uvCtxEndRenderTexture(uv_context_t *ctx) {
+    uv__target_t *t = &ctx->target;
+    if (!t->texture) return;
+
+    vecclear(ctx->frame_chunks);
+    uv__frame_gather_chunks(ctx, ctx);
+
+    // even without anything in it the texture is cleared
+    uv_drawdata_t *data = &ctx->chunks[0]->data;
+    if (uv__frame_link(ctx)) {
+        uv_drawdata_t *sorted = ctx->options.deferred ? uv__drawlist_sort(ctx) : NULL;
+        data = sorted ? sorted : &ctx->frame_chunks[0]->data;
+    }
+    data->unchanged = false;
+
+    uv__backend_set_target(ctx->gfx_data, t->texture->handle);
+    uv__backend_draw(ctx->gfx_data, t->clear_colour, data);
+    uv__backend_set_target(ctx->gfx_data, 0);
+
+    uv__target_swap(ctx);
+    t->texture = NULL;
+    ctx->culled += t->culled;
+    uv__clip_update(ctx);
+
+    // frames that drew the texture before aren't the same anymore
+    ctx->frame_epoch++;
+}
+
+// == culling =========================================
+// with uv_options_t.cull a primitive whose bounding box is entirely outside of cull_rect
+// (left, top, right, bottom) isn't emitted at all. the bulk functions read the option once.
+// cull_rect is the current clip rect, which is the window when none was pushed
+
+void uvCtxSetCulling(uv_context_t *ctx, bool enabled) {
+    ctx->options.cull = enabled;
+}
+
+u32 uvCtxGetCulledCount(uv_context_t *ctx) {
+    u32 culled = ctx->culled;
+    for (u32 i = 0; i < veclen(ctx->fragments); ++i) {
+        culled += ctx->fragments[i]->culled;
+    }
+    return culled;
+}
+
+// without a scissor the clip rect can only be applied by culling
+static inline bool uv__culling(const uv_context_t *ctx) {
+    return ctx->options.cull || ctx->cpu_clip;
+}
+
+// counts the primitive if it's culled. the box is before the transform
+static inline bool uv__culled(uv_context_t *ctx, float x0, float y0, float x1, float y1) {
+    if (ctx->transformed) {
+        // box around the transformed box, from its centre and half extents
+        const float *m = ctx->transform.m;
+        float cx = (x0 + x1) * 0.5f, cy = (y0 + y1) * 0.5f;
+        float hx = (x1 - x0) * 0.5f, hy = (y1 - y0) * 0.5f;
+        float ex = fabsf(m[0]) * hx + fabsf(m[1]) * hy;
+        float ey = fabsf(m[3]) * hx + fabsf(m[4]) * hy;
+        float tx = m[0] * cx + m[1] * cy + m[2];
+        float ty = m[3] * cx + m[4] * cy + m[5];
+        x0 = tx - ex; x1 = tx + ex;
+        y0 = ty - ey; y1 = ty + ey;
+    }
+    if (x1 < ctx->cull_rect.x || y1 < ctx->cull_rect.y || x0 > ctx->cull_rect.z || y0 > ctx->cull_rect.w) {
+        ctx->culled++;
+        return true;
+    }
+    return false;
+}
+
+// anything within radius of centre
+static inline bool uv__culled_radius(uv_context_t *ctx, vec2 centre, float radius) {
+    return uv__culled(ctx, centre.x - radius, centre.y - radius, centre.x + radius, centre.y + radius);
+}
+
+// anything within margin of the bounding box of the points
+static bool uv__culled_points(uv_context_t *ctx, const vec2 *points, u32 count, float margin) {
+    float x0 = points[0].x, y0 = points[0].y;
+    float x1 = x0, y1 = y0;
+    for (u32 i = 1; i < count; ++i) {
+        x0 = points[i].x < x0 ? points[i].x : x0;
+        y0 = points[i].y < y0 ? points[i].y : y0;
+        x1 = points[i].x > x1 ? points[i].x : x1;
+        y1 = points[i].y > y1 ? points[i].y : y1;
+    }
+    return uv__culled(ctx, x0 - margin, y0 - margin, x1 + margin, y1 + margin);
+}
+
+// == clip rects ======================================
+// the clip rect is in whole pixels, rounded the same way as the edges of a quad, and every
+// batch has the one that was current when it started. a backend with UV_CAP_SCISSOR applies
+// it on its own, otherwise cpu_clip is set while one is pushed: the bulk quads and the sprites
+// that aren't rotated are cut to it here, everything else is only culled
+
+static void uv__clip_update(uv_context_t *ctx) {
+    vec4i clip = { 0, 0, ctx->win_size.x, ctx->win_size.y };
+    if (!vecempty(ctx->clip_stack)) {
+        vec4i top = vecback(ctx->clip_stack);
+        clip.x = top.x > clip.x ? top.x : clip.x;
+        clip.y = top.y > clip.y ? top.y : clip.y;
+        clip.z = top.z < clip.z ? top.z : clip.z;
+        clip.w = top.w < clip.w ? top.w : clip.w;
+        clip.z = clip.z > clip.x ? clip.z : clip.x;
+        clip.w = clip.w > clip.y ? clip.w : clip.y;
+    }
+
+    ctx->cur_clip = clip;
+    ctx->cull_rect = v4((float)clip.x, (float)clip.y, (float)clip.z, (float)clip.w);
+    ctx->cpu_clip = !vecempty(ctx->clip_stack) && !(ctx->backend_caps & UV_CAP_SCISSOR);
+}
+
+// the batch breaks only if something was drawn with the previous clip rect
+static void uv__clip_apply(uv_context_t *ctx) {
+    uv__clip_update(ctx);
+
+    uv__chunk_t *chunk = uv__drawlist_chunk(ctx);
+    if (!chunk->data.batch_count) {
+        return;
+    }
+
+    uv_batch_t *cur = uv__drawlist_batch(ctx, chunk);
+    if (cur->clip.x == ctx->cur_clip.x && cur->clip.y == ctx->cur_clip.y &&
+        cur->clip.z == ctx->cur_clip.z && cur->clip.w == ctx->cur_clip.w) {
+        return;
+    }
+
+    if (uv__batch_is_empty(cur)) {
+        cur->clip = ctx->cur_clip;
+        return;
+    }
+
+    uv__drawlist_split_batch(ctx, chunk, chunk);
+}
+
+void uvCtxPushClipRect(uv_context_t *ctx, vec2 position, vec2 size) {
+    // the pixels whose centre is inside of the rectangle
+    float x0 = size.x < 0.f ? position.x + size.x : position.x;
+    float y0 = size.y < 0.f ? position.y + size.y : position.y;
+    float x1 = size.x < 0.f ? position.x : position.x + size.x;
+    float y1 = size.y < 0.f ? position.y : position.y + size.y;
+    vec4i clip = {
+        (int)floorf(x0 + 0.5f), (int)floorf(y0 + 0.5f),
+        (int)floorf(x1 + 0.5f), (int)floorf(y1 + 0.5f),
+    };
+
+    // always inside of the previous one
+    if (!vecempty(ctx->clip_stack)) {
+        vec4i top = vecback(ctx->clip_stack);
+        clip.x = top.x > clip.x ? top.x : clip.x;
+        clip.y = top.y > clip.y ? top.y : clip.y;
+        clip.z = top.z < clip.z ? top.z : clip.z;
+        clip.w = top.w < clip.w ? top.w : clip.w;
+    }
+
+    // the draw list can reset the stack on the first use in a frame
+    uv__drawlist_chunk(ctx);
+    vecpush(ctx->clip_stack, clip);
+    uv__clip_apply(ctx);
+}
+
+void uvCtxPopClipRect(uv_context_t *ctx) {
+    UV_ASSERT(!vecempty(ctx->clip_stack));
+    if (vecempty(ctx->clip_stack)) return;
+    (void)vecpop(ctx->clip_stack);
+    uv__clip_apply(ctx);
+}
+
+// the clip rect before the transform, false if the bulk quads can't be cut to it: without
+// cpu_clip, or when the transform doesn't keep them axis aligned
+static bool uv__clip_local(const uv_context_t *ctx, vec4 *clip) {
+    if (!ctx->cpu_clip) return false;
+
+    *clip = v4((float)ctx->cur_clip.x, (float)ctx->cur_clip.y, (float)ctx->cur_clip.z, (float)ctx->cur_clip.w);
+    if (!ctx->transformed) return true;
+
+    const float *m = ctx->transform.m;
+    if (m[1] != 0.f || m[3] != 0.f || m[0] == 0.f || m[4] == 0.f) return false;
+
+    float x0 = (clip->x - m[2]) / m[0], x1 = (clip->z - m[2]) / m[0];
+    float y0 = (clip->y - m[5]) / m[4], y1 = (clip->w - m[5]) / m[4];
+    *clip = v4(x0 < x1 ? x0 : x1, y0 < y1 ? y0 : y1, x0 < x1 ? x1 : x0, y0 < y1 ? y1 : y0);
+    return true;
+}
+
+// cuts one axis of a rectangle to [lo, hi], the uvs at its two ends follow.
+// returns true if anything changed
+static inline bool uv__clip_span(float lo, float hi, float *pos, float *size, float *uv0, float *uv1) {
+    float a = *pos, b = *pos + *size;
+    float ca = a < lo ? lo : (a > hi ? hi : a);
+    float cb = b < lo ? lo : (b > hi ? hi : b);
+    if (ca == a && cb == b) return false;
+
+    if (*size != 0.f) {
+        float du = (*uv1 - *uv0) / *size;
+        *uv1 = *uv0 + (cb - a) * du;
+        *uv0 = *uv0 + (ca - a) * du;
+    }
+    *pos = ca;
+    *size = cb - ca;
+    return true;
+}
+
+// clip from uv__clip_local. uv, xy: at position, zw: at position + size
+static bool uv__clip_rect(vec4 clip, vec2 *position, vec2 *size, vec4 *uv) {
+    bool x = uv__clip_span(clip.x, clip.z, &position->x, &size->x, &uv->x, &uv->z);
+    bool y = uv__clip_span(clip.y, clip.w, &position->y, &size->y, &uv->y, &uv->w);
+    return x || y;
+}
+
+// == transforms ======================================
+// the current transform is applied to the points of every primitive while its vertices are
+// written. uvTranslate, uvRotate and uvScale multiply it on the right, so the last one called
+// is the first applied to the points, and every frame starts with the identity
+
+static void uv__transform_set(uv_context_t *ctx, const uv__affine_t *t) {
+    ctx->transform = *t;
+    const float *m = t->m;
+    ctx->transformed = !(m[0] == 1.f && m[1] == 0.f && m[2] == 0.f && m[3] == 0.f && m[4] == 1.f && m[5] == 0.f);
+}
+
+// a rotation with a uniform scale, which keeps rectangles and circles what they are
+static bool uv__transform_similarity(const uv_context_t *ctx, float *scale, float *angle) {
+    const float *m = ctx->transform.m;
+    if (m[0] != m[4] || m[1] != -m[3]) return false;
+    *scale = sqrtf(m[0] * m[0] + m[3] * m[3]);
+    *angle = atan2f(m[3], m[0]);
+    return *scale > 0.f;
+}
+
+// how much longer a segment can get, for the tolerance of the tessellation
+static float uv__transform_stretch(const uv_context_t *ctx) {
+    if (!ctx->transformed) return 1.f;
+    const float *m = ctx->transform.m;
+    float x = m[0] * m[0] + m[3] * m[3];
+    float y = m[1] * m[1] + m[4] * m[4];
+    return sqrtf(x > y ? x : y);
+}
+
+void uvCtxPushTransform(uv_context_t *ctx) {
+    vecpush(ctx->transform_stack, ctx->transform);
+}
+
+void uvCtxPopTransform(uv_context_t *ctx) {
+    UV_ASSERT(!vecempty(ctx->transform_stack));
+    if (vecempty(ctx->transform_stack)) return;
+    uv__affine_t t = vecpop(ctx->transform_stack);
+    uv__transform_set(ctx, &t);
+}
+
+void uvCtxTranslate(uv_context_t *ctx, vec2 offset) {
+    uv__affine_t t = ctx->transform;
+    t.m[2] += t.m[0] * offset.x + t.m[1] * offset.y;
+    t.m[5] += t.m[3] * offset.x + t.m[4] * offset.y;
+    uv__transform_set(ctx, &t);
+}
+
+void uvCtxRotate(uv_context_t *ctx, float angle) {
+    float c = cosf(angle);
+    float s = sinf(angle);
+    uv__affine_t t = ctx->transform;
+    const float *m = ctx->transform.m;
+    t.m[0] = m[0] * c + m[1] * s;
+    t.m[1] = m[1] * c - m[0] * s;
+    t.m[3] = m[3] * c + m[4] * s;
+    t.m[4] = m[4] * c - m[3] * s;
+    uv__transform_set(ctx, &t);
+}
+
+void uvCtxScale(uv_context_t *ctx, vec2 scale) {
+    uv__affine_t t = ctx->transform;
+    t.m[0] *= scale.x;
+    t.m[3] *= scale.x;
+    t.m[1] *= scale.y;
+    t.m[4] *= scale.y;
+    uv__transform_set(ctx, &t);
+}
+
+// vertices coming from the user don't know the batch's slots, they use the current texture
+static void uv__set_slots(const uv_context_t *ctx, uv_vertex_t *vertices, u32 count) {
+#if UV_TEXTURE_SLOTS > 1
+    for (u32 i = 0; i < count; ++i) {
+        vertices[i].slot = ctx->cur_slot;
+    }
+#endif
+}
+
+// raw vertices are copied as a block, then transformed in place
+static void uv__transform_vertices(const uv_context_t *ctx, uv_vertex_t *vertices, u32 count) {
+    if (!ctx->transformed) return;
+    for (u32 i = 0; i < count; ++i) {
+        vertices[i].pos = uv__transform_point(&ctx->transform, vertices[i].pos);
+    }
+}
+
+void uvCtxDrawVertices(uv_context_t *ctx, uv_vertex_t *vertices, u32 count) {
+    uv__chunk_t *chunk = uv__drawlist_reserve(ctx, count, count);
+    uv_drawdata_t *data = &chunk->data;
+    uv_batch_t *cur = uv__drawlist_batch(ctx, chunk);
+
+    UV_MEMCPY(data->vertices + data->vtx_count, vertices, sizeof(uv_vertex_t) * count);
+    uv__set_slots(ctx, data->vertices + data->vtx_count, count);
+    uv__transform_vertices(ctx, data->vertices + data->vtx_count, count);
+    uv__drawlist_write_indices(ctx, chunk, NULL, count);
+
+    data->vtx_count += count;
+    cur->vtx_count += count;
+    cur->idx_count += count;
+}
+
+void uvCtxDrawIndices(uv_context_t *ctx, uv_vertex_t *vertices, u32 vtx_count, uv_index_t *indices, u32 idx_count) {
+    uv__chunk_t *chunk = uv__drawlist_reserve(ctx, vtx_count, idx_count);
+    uv_drawdata_t *data = &chunk->data;
+    uv_batch_t *cur = uv__drawlist_batch(ctx, chunk);
+
+    // big meshes get a batch of their own, so their indices don't need to be offset:
+    // u32 indices are memcpy'd and u16 ones are only narrowed
+    if (idx_count >= UV_COPY_MIN_INDICES && cur->vtx_count) {
+        cur = uv__drawlist_split_batch(ctx, chunk, chunk);
+    }
+
+    UV_MEMCPY(data->vertices + data->vtx_count, vertices, sizeof(uv_vertex_t) * vtx_count);
+    uv__set_slots(ctx, data->vertices + data->vtx_count, vtx_count);
+    uv__transform_vertices(ctx, data->vertices + data->vtx_count, vtx_count);
+    uv__drawlist_write_indices(ctx, chunk, indices, idx_count);
+
+    data->vtx_count += vtx_count;
+    cur->vtx_count += vtx_count;
+    cur->idx_count += idx_count;
+}
+
+void uvCtxDrawLine(uv_context_t *ctx, vec2 start, vec2 end, float thickness, colour_t colour) {
+    uvCtxDrawLines(ctx, &(uv_line_t){ start, end, thickness, colour }, 1);
+}
+
+void uvCtxDrawQuad(uv_context_t *ctx, vec2 pos, vec2 sz, colour_t colour) {
+    uvCtxDrawQuads(ctx, &(uv_quad_t){ pos, sz, colour }, 1);
+}
+
+void uvCtxDrawTriangle(uv_context_t *ctx, vec2 v1, vec2 v2, vec2 v3, colour_t colour) {
+    uvCtxDrawTriangles(ctx, &(uv_triangle_t){ v1, v2, v3, colour }, 1);
+}
+
+// == bulk primitives =================================
+// vertices and indices are written straight into the draw list, in runs that always fit in
+// a batch with u16 indices
+
+#define UV_BULK_MAX_QUADS     (UV_MAX_U16_VERTICES / 4)
+#define UV_BULK_MAX_TRIANGLES (UV_MAX_U16_VERTICES / 3)
+
+// uvs of the corners of a quad for the current texture, in the same order as its vertices
+typedef struct {
+    vec2 uv[4];
+#ifdef UV_SIMD_VERTEX
+    // uv in the z and w lanes
+    __m128 lanes[4];
+    // columns of the transform in the x and y lanes: x axis, y axis, translation
+    __m128 axes[3];
+#endif
+} uv__corners_t;
+
+static uv__corners_t uv__make_corners(const uv_context_t *ctx, vec4 uv) {
+    uv__corners_t c = {
+        .uv = {
+            v2(uv.x, uv.y),
+            v2(uv.x, uv.w),
+            v2(uv.z, uv.y),
+            v2(uv.z, uv.w),
+        },
+    };
+#ifdef UV_SIMD_VERTEX
+    for (int k = 0; k < 4; ++k) {
+        c.lanes[k] = _mm_setr_ps(0.f, 0.f, c.uv[k].u, c.uv[k].v);
+    }
+    const float *m = ctx->transform.m;
+    c.axes[0] = _mm_setr_ps(m[0], m[3], 0.f, 0.f);
+    c.axes[1] = _mm_setr_ps(m[1], m[4], 0.f, 0.f);
+    c.axes[2] = _mm_setr_ps(m[2], m[5], 0.f, 0.f);
+#endif
+    return c;
+}
+
+static uv__corners_t uv__get_corners(const uv_context_t *ctx) {
+    return uv__make_corners(ctx, ctx->cur_uv);
+}
+
+#ifdef UV_SIMD_VERTEX
+// builds the vertex in registers, a compound literal goes through the stack
+static inline void uv__store_vertex(const uv_context_t *ctx, uv_vertex_t *out, vec2 pos, vec2 uv, __m128 col) {
+    if (ctx->transformed) {
+        pos = uv__transform_point(&ctx->transform, pos);
+    }
+    _mm_storeu_ps(&out->pos.x, _mm_setr_ps(pos.x, pos.y, uv.u, uv.v));
+    _mm_storeu_ps(&out->col.r, col);
+#if UV_TEXTURE_SLOTS > 1
+    out->slot = ctx->cur_slot;
+#endif
+}
+#endif
+
+static void uv__quad_vertices(const uv_context_t *ctx, uv_vertex_t *out, const uv_quad_t *quad, const uv__corners_t *corners) {
+#ifdef UV_SIMD_VERTEX
+    const __m128 x_mask = _mm_castsi128_ps(_mm_setr_epi32(-1, 0, 0, 0));
+    const __m128 y_mask = _mm_castsi128_ps(_mm_setr_epi32(0, -1, 0, 0));
+
+    __m128 pos = _mm_setr_ps(quad->position.x, quad->position.y, 0.f, 0.f);
+    __m128 sz  = _mm_setr_ps(quad->size.x, quad->size.y, 0.f, 0.f);
+    __m128 col = _mm_loadu_ps(&quad->colour.r);
+    __m128 dx  = _mm_and_ps(sz, x_mask);
+    __m128 dy  = _mm_and_ps(sz, y_mask);
+
+    if (ctx->transformed) {
+        // the transformed corner plus the transformed sides, the z and w lanes stay +0
+        __m128 px = _mm_setr_ps(quad->position.x, quad->position.x, 0.f, 0.f);
+        __m128 py = _mm_setr_ps(quad->position.y, quad->position.y, 0.f, 0.f);
+        pos = _mm_add_ps(_mm_add_ps(_mm_mul_ps(corners->axes[0], px), _mm_mul_ps(corners->axes[1], py)), corners->axes[2]);
+        dx = _mm_mul_ps(corners->axes[0], _mm_setr_ps(quad->size.x, quad->size.x, 0.f, 0.f));
+        dy = _mm_mul_ps(corners->axes[1], _mm_setr_ps(quad->size.y, quad->size.y, 0.f, 0.f));
+    }
+
+    // uvs are or'ed in the zeroed lanes
+    __m128 v[4] = {
+        _mm_or_ps(pos,                                 corners->lanes[0]),
+        _mm_or_ps(_mm_add_ps(pos, dy),                 corners->lanes[1]),
+        _mm_or_ps(_mm_add_ps(pos, dx),                 corners->lanes[2]),
+        _mm_or_ps(_mm_add_ps(_mm_add_ps(pos, dx), dy), corners->lanes[3]),
+    };
+
+    for (int k = 0; k < 4; ++k) {
+#ifdef UV_SIMD_AVX2
+        _mm256_storeu_ps(&out[k].pos.x, _mm256_insertf128_ps(_mm256_castps128_ps256(v[k]), col, 1));
+#else
+        _mm_storeu_ps(&out[k].pos.x, v[k]);
+        _mm_storeu_ps(&out[k].col.r, col);
+#endif
+#if UV_TEXTURE_SLOTS > 1
+        out[k].slot = ctx->cur_slot;
+#endif
+    }
+#else
+    uv__colour_t col = uv__pack_colour(quad->colour);
+    vec2 pos = quad->position;
+    vec2 sz = quad->size;
+
+    out[0] = uv__vertex(ctx, pos,                     corners->uv[0], col);
+    out[1] = uv__vertex(ctx, v2(pos.x, pos.y + sz.y), corners->uv[1], col);
+    out[2] = uv__vertex(ctx, v2(pos.x + sz.x, pos.y), corners->uv[2], col);
+    out[3] = uv__vertex(ctx, v2add(pos, sz),          corners->uv[3], col);
+#endif
+}
+
+// returns false if the line is empty
+static bool uv__line_vertices(const uv_context_t *ctx, uv_vertex_t *out, const uv_line_t *line, const uv__corners_t *corners) {
+    if (line->thickness <= 0) return false;
+
+    vec2 delta = v2sub(line->end, line->start);
+    float length = v2mag(delta);
+
+    if (length <= 0.f) return false;
+
+    float scale = line->thickness / (2.f * length);
+    vec2 radius = { -scale*delta.y, scale*delta.x };
+
+#ifdef UV_SIMD_VERTEX
+    __m128 col = _mm_loadu_ps(&line->colour.r);
+
+    uv__store_vertex(ctx, &out[0], v2sub(line->start, radius), corners->uv[0], col);
+    uv__store_vertex(ctx, &out[1], v2add(line->start, radius), corners->uv[1], col);
+    uv__store_vertex(ctx, &out[2], v2sub(line->end, radius),   corners->uv[2], col);
+    uv__store_vertex(ctx, &out[3], v2add(line->end, radius),   corners->uv[3], col);
+#else
+    uv__colour_t col = uv__pack_colour(line->colour);
+
+    out[0] = uv__vertex(ctx, v2sub(line->start, radius), corners->uv[0], col);
+    out[1] = uv__vertex(ctx, v2add(line->start, radius), corners->uv[1], col);
+    out[2] = uv__vertex(ctx, v2sub(line->end, radius),   corners->uv[2], col);
+    out[3] = uv__vertex(ctx, v2add(line->end, radius),   corners->uv[3], col);
+#endif
+
+    return true;
+}
+
+// adds count quads (already written after the chunk's vertices) to the current batch
+static void uv__commit_quads(uv_context_t *ctx, uv__chunk_t *chunk, u32 count) {
+    uv_drawdata_t *data = &chunk->data;
+    uv_batch_t *cur = uv__drawlist_batch(ctx, chunk);
+
+    uv__write_quad_indices(data, data->vtx_count - cur->vtx_start, count);
+
+    data->vtx_count += count * 4;
+    cur->vtx_count += count * 4;
+    cur->idx_count += count * 6;
+}
+
+void uvCtxDrawQuads(uv_context_t *ctx, const uv_quad_t *quads, u32 count) {
+    uv__corners_t corners = uv__get_corners(ctx);
+    bool cull = uv__culling(ctx);
+    vec4 clip_rect;
+    bool clip = uv__clip_local(ctx, &clip_rect);
+
+    while (count) {
+        u32 n = count < UV_BULK_MAX_QUADS ? count : UV_BULK_MAX_QUADS;
+        uv__chunk_t *chunk = uv__drawlist_reserve(ctx, n * 4, n * 6);
+        uv_vertex_t *vtx = chunk->data.vertices + chunk->data.vtx_count;
+
+        u32 written = 0;
+        for (u32 i = 0; i < n; ++i) {
+            const uv_quad_t *quad = &quads[i];
+            if (cull) {
+                vec2 box[2] = { quad->position, v2add(quad->position, quad->size) };
+                if (uv__culled_points(ctx, box, 2, 0.f)) continue;
+            }
+            // only the quads across an edge of the clip rect need new uvs
+            uv_quad_t cut = *quad;
+            vec4 uv = ctx->cur_uv;
+            if (clip && uv__clip_rect(clip_rect, &cut.position, &cut.size, &uv)) {
+                uv__corners_t cut_corners = uv__make_corners(ctx, uv);
+                uv__quad_vertices(ctx, vtx + written * 4, &cut, &cut_corners);
+            }
+            else {
+                uv__quad_vertices(ctx, vtx + written * 4, quad, &corners);
+            }
+            written++;
+        }
+
+        uv__commit_quads(ctx, chunk, written);
+        quads += n;
+        count -= n;
+    }
+}
+
+void uvCtxDrawLines(uv_context_t *ctx, const uv_line_t *lines, u32 count) {
+    uv__corners_t corners = uv__get_corners(ctx);
+    bool cull = uv__culling(ctx);
+
+    while (count) {
+        u32 n = count < UV_BULK_MAX_QUADS ? count : UV_BULK_MAX_QUADS;
+        uv__chunk_t *chunk = uv__drawlist_reserve(ctx, n * 4, n * 6);
+        uv_vertex_t *vtx = chunk->data.vertices + chunk->data.vtx_count;
+
+        u32 written = 0;
+        for (u32 i = 0; i < n; ++i) {
+            const uv_line_t *line = &lines[i];
+            if (cull) {
+                vec2 ends[2] = { line->start, line->end };
+                if (uv__culled_points(ctx, ends, 2, line->thickness * 0.5f)) continue;
+            }
+            written += uv__line_vertices(ctx, vtx + written * 4, line, &corners);
+        }
+
+        uv__commit_quads(ctx, chunk, written);
+        lines += n;
+        count -= n;
+    }
+}
+
+void uvCtxDrawTriangles(uv_context_t *ctx, const uv_triangle_t *triangles, u32 count) {
+    // triangles sample the top left corner of the texture
+    vec2 uv = v2(ctx->cur_uv.x, ctx->cur_uv.y);
+    bool cull = uv__culling(ctx);
+
+    while (count) {
+        u32 n = count < UV_BULK_MAX_TRIANGLES ? count : UV_BULK_MAX_TRIANGLES;
+        uv__chunk_t *chunk = uv__drawlist_reserve(ctx, n * 3, n * 3);
+        uv_drawdata_t *data = &chunk->data;
+        uv_batch_t *cur = uv__drawlist_batch(ctx, chunk);
+        uv_vertex_t *vtx = data->vertices + data->vtx_count;
+
+        u32 written = 0;
+        for (u32 i = 0; i < n; ++i) {
+            const uv_triangle_t *tri = &triangles[i];
+            if (cull) {
+                vec2 corners3[3] = { tri->v1, tri->v2, tri->v3 };
+                if (uv__culled_points(ctx, corners3, 3, 0.f)) continue;
+            }
+            uv_vertex_t *out = vtx + written * 3;
+#ifdef UV_SIMD_VERTEX
+            __m128 col = _mm_loadu_ps(&tri->colour.r);
+            uv__store_vertex(ctx, &out[0], tri->v1, uv, col);
+            uv__store_vertex(ctx, &out[1], tri->v2, uv, col);
+            uv__store_vertex(ctx, &out[2], tri->v3, uv, col);
+#else
+            uv__colour_t col = uv__pack_colour(tri->colour);
+            out[0] = uv__vertex(ctx, tri->v1, uv, col);
+            out[1] = uv__vertex(ctx, tri->v2, uv, col);
+            out[2] = uv__vertex(ctx, tri->v3, uv, col);
+#endif
+            written++;
+        }
+
+        uv__write_sequential_indices(data, data->vtx_count - cur->vtx_start, written * 3);
+
+        data->vtx_count += written * 3;
+        cur->vtx_count += written * 3;
+        cur->idx_count += written * 3;
+        triangles += n;
+        count -= n;
+    }
+}
+
+// == sdf shapes ======================================
+// with uv_options_t.sdf_shapes and UV_CAP_SHAPES a circle, a ring or a rounded quad is a single
+// uv_instance_t, the backend evaluates its signed distance for every pixel of the quad and
+// turns it into coverage. it costs the same however big it is on screen and its edge is always
+// anti-aliased. outlines are a band inside of the shape, which is as big as their outer edge
+
+void uvCtxSetSdfShapes(uv_context_t *ctx, bool enabled) {
+    ctx->options.sdf_shapes = enabled;
+}
+
+// false when the shape has to be tessellated. centre and size are before the transform,
+// thickness 0 is filled and uv is the rectangle of the current texture mapped on size
+static bool uv__shape(uv_context_t *ctx, vec2 centre, vec2 size, float rotation, float radius, float thickness, vec4 uv, colour_t colour) {
+    if (!ctx->options.sdf_shapes || !(ctx->backend_caps & UV_CAP_SHAPES)) return false;
+
+    // the distance is only exact if the shape is still a rounded box on screen
+    float scale = 1.f, angle = 0.f;
+    if (ctx->transformed) {
+        if (!uv__transform_similarity(ctx, &scale, &angle)) return false;
+        centre = uv__transform_point(&ctx->transform, centre);
+        size = v2(size.x * scale, size.y * scale);
+        rotation += angle;
+    }
+
+    uv__chunk_t *chunk = uv__drawlist_chunk(ctx);
+    uv_batch_t *cur = uv__drawlist_reserve_instances(ctx, chunk, 1);
+    chunk->data.instances[chunk->data.inst_count++] = (uv_instance_t){
+        .pos = v2(centre.x - size.x * 0.5f, centre.y - size.y * 0.5f),
+        .size = size,
+        .rotation = rotation,
+        .radius = radius * scale,
+        .thickness = thickness * scale,
+        .uv = uv,
+        .col = uv__pack_colour(colour),
+#if UV_TEXTURE_SLOTS > 1
+        .slot = ctx->cur_slot,
+#endif
+    };
+    cur->inst_count++;
+    return true;
+}
+
+// == tessellation ====================================
+// circles, arcs, rings and rounded quads are polygons with as many segments as they need to
+// stay within tess_tolerance pixels of the curve. their points come from a table of the unit
+// circle with a multiple of 4 segments, so the corners of rounded quads start and end on its
+// entries, and sinf/cosf are only called to build it and for the two ends of an arc
+
+#define UV_TESS_TOLERANCE    0.25f
+#define UV_TESS_MIN_SEGMENTS 8
+#define UV_TAU               6.28318530717958647692f
+
+// in the units of the points, which the transform can make bigger on screen
+static inline float uv__tess_tolerance(const uv_context_t *ctx) {
+    float tolerance = ctx->options.tess_tolerance > 0.f ? ctx->options.tess_tolerance : UV_TESS_TOLERANCE;
+    return tolerance / uv__transform_stretch(ctx);
+}
+
+static const vec2 *uv__tess_table(uv_context_t *ctx, u32 segments) {
+    vec2 **table = &ctx->tess_tables[segments / 4 - 1];
+    if (!*table) {
+        u32 quarter = segments / 4;
+        vec2 *dirs = UV_REALLOC(NULL, sizeof(vec2) * segments, allocator_udata);
+        UV_ASSERT(dirs);
+        // the other quarters are the first one rotated by 90 degrees, which also makes them exact
+        for (u32 k = 0; k < quarter; ++k) {
+            float a = UV_TAU * (float)k / (float)segments;
+            float c = cosf(a);
+            float s = sinf(a);
+            dirs[k]               = v2(c, s);
+            dirs[k + quarter]     = v2(-s, c);
+            dirs[k + quarter * 2] = v2(-c, -s);
+            dirs[k + quarter * 3] = v2(s, -c);
+        }
+        *table = dirs;
+    }
+    return *table;
+}
+
+static void uv__tess_free(uv_context_t *ctx) {
+    for (u32 i = 0; i < UV_TESS_MAX_SEGMENTS / 4; ++i) {
+        if (ctx->tess_tables[i]) {
+            UV_FREE(ctx->tess_tables[i], allocator_udata);
+            ctx->tess_tables[i] = NULL;
+        }
+    }
+}
+
+// segments in a full turn of a circle with this radius on screen. with a count from the user
+// it's enough for sweep to have at least that many
+static u32 uv__tess_segments(const uv_context_t *ctx, float radius, uint segments, float sweep) {
+    float n = 0.f;
+    if (segments) {
+        n = (float)segments * UV_TAU / sweep;
+    }
+    else {
+        float tol = uv__tess_tolerance(ctx);
+        // a segment spanning the angle a is at most r * (1 - cos(a / 2)) ~= r * a^2 / 8 from
+        // the curve, the approximation errs on the side of more segments
+        if (radius > tol) n = UV_TAU / sqrtf(8.f * tol / radius);
+    }
+
+    u32 min = segments ? 4 : UV_TESS_MIN_SEGMENTS;
+    // also catches nan and inf
+    if (!(n < UV_TESS_MAX_SEGMENTS)) return UV_TESS_MAX_SEGMENTS;
+    u32 count = ((u32)ceilf(n) + 3) & ~3u;
+    return count > min ? count : min;
+}
+
+// the points of an arc: its two ends and the table entries between them
+typedef struct {
+    const vec2 *table;
+    u32 segments;
+    // first table entry after the start, and how many are before the end
+    u32 first;
+    u32 inner;
+    vec2 start;
+    vec2 end;
+    // a full circle is only the table, its last point connects back to the first
+    bool closed;
+} uv__arc_t;
+
+static uv__arc_t uv__tess_arc(uv_context_t *ctx, float radius, float start, float end, uint segments) {
+    if (end < start) {
+        float tmp = start;
+        start = end;
+        end = tmp;
+    }
+
+    float sweep = end - start;
+    uv__arc_t arc = { .closed = sweep >= UV_TAU };
+    if (arc.closed) sweep = UV_TAU;
+
+    arc.segments = uv__tess_segments(ctx, radius, segments, sweep);
+    arc.table = uv__tess_table(ctx, arc.segments);
+
+    if (arc.closed) {
+        arc.inner = arc.segments;
+        return arc;
+    }
+
+    start = fmodf(start, UV_TAU);
+    if (start < 0.f) start += UV_TAU;
+    end = start + sweep;
+
+    float step = UV_TAU / (float)arc.segments;
+    int first = (int)floorf(start / step) + 1;
+    int last = (int)ceilf(end / step) - 1;
+
+    arc.first = (u32)first;
+    arc.inner = last >= first ? (u32)(last - first + 1) : 0;
+    arc.start = v2(cosf(start), sinf(start));
+    arc.end = v2(cosf(end), sinf(end));
+    return arc;
+}
+
+static inline u32 uv__arc_points(const uv__arc_t *arc) {
+    return arc->closed ? arc->segments : arc->inner + 2;
+}
+
+static inline vec2 uv__arc_dir(const uv__arc_t *arc, u32 i) {
+    if (arc->closed)      return arc->table[i];
+    if (i == 0)           return arc->start;
+    if (i > arc->inner)   return arc->end;
+    return arc->table[(arc->first + i - 1) % arc->segments];
+}
+
+// the current texture covers the bounding box of the circle
+static void uv__tess_circle_uv(const uv_context_t *ctx, vec2 *uv_centre, vec2 *uv_radius) {
+    *uv_centre = v2((ctx->cur_uv.x + ctx->cur_uv.z) * 0.5f, (ctx->cur_uv.y + ctx->cur_uv.w) * 0.5f);
+    *uv_radius = v2((ctx->cur_uv.z - ctx->cur_uv.x) * 0.5f, (ctx->cur_uv.w - ctx->cur_uv.y) * 0.5f);
+}
+
+// filled sector: a fan from the centre
+static void uv__tess_fan(uv_context_t *ctx, vec2 centre, float radius, const uv__arc_t *arc, colour_t colour) {
+    u32 points = uv__arc_points(arc);
+    u32 tris = arc->closed ? points : points - 1;
+
+    uv__chunk_t *chunk = uv__drawlist_reserve(ctx, points + 1, tris * 3);
+    uv_drawdata_t *data = &chunk->data;
+    uv_batch_t *cur = uv__drawlist_batch(ctx, chunk);
+    uv_vertex_t *vtx = data->vertices + data->vtx_count;
+
+    uv__colour_t col = uv__pack_colour(colour);
+    vec2 uvc, uvr;
+    uv__tess_circle_uv(ctx, &uvc, &uvr);
+
+    vtx[0] = uv__vertex(ctx, centre, uvc, col);
+    for (u32 i = 0; i < points; ++i) {
+        vec2 dir = uv__arc_dir(arc, i);
+        vec2 pos = v2(centre.x + dir.x * radius, centre.y + dir.y * radius);
+        vtx[i + 1] = uv__vertex(ctx, pos, v2(uvc.x + dir.x * uvr.x, uvc.y + dir.y * uvr.y), col);
+    }
+
+    uv__write_fan_indices(data, data->vtx_count - cur->vtx_start, points, arc->closed);
+
+    data->vtx_count += points + 1;
+    cur->vtx_count += points + 1;
+    cur->idx_count += tris * 3;
+}
+
+// between two radii: a strip of quads with an outer and an inner vertex for each point
+static void uv__tess_band(uv_context_t *ctx, vec2 centre, float inner, float outer, const uv__arc_t *arc, colour_t colour) {
+    u32 points = uv__arc_points(arc);
+    u32 quads = arc->closed ? points : points - 1;
+
+    uv__chunk_t *chunk = uv__drawlist_reserve(ctx, points * 2, quads * 6);
+    uv_drawdata_t *data = &chunk->data;
+    uv_batch_t *cur = uv__drawlist_batch(ctx, chunk);
+    uv_vertex_t *vtx = data->vertices + data->vtx_count;
+
+    uv__colour_t col = uv__pack_colour(colour);
+    vec2 uvc, uvr;
+    uv__tess_circle_uv(ctx, &uvc, &uvr);
+    float uv_inner = inner / outer;
+
+    for (u32 i = 0; i < points; ++i) {
+        vec2 dir = uv__arc_dir(arc, i);
+        vec2 uv = v2(dir.x * uvr.x, dir.y * uvr.y);
+        vtx[i * 2 + 0] = uv__vertex(ctx, v2(centre.x + dir.x * outer, centre.y + dir.y * outer), v2add(uvc, uv), col);
+        vtx[i * 2 + 1] = uv__vertex(ctx, v2(centre.x + dir.x * inner, centre.y + dir.y * inner), v2(uvc.x + uv.x * uv_inner, uvc.y + uv.y * uv_inner), col);
+    }
+
+    uv__write_strip_indices(data, data->vtx_count - cur->vtx_start, points, arc->closed);
+
+    data->vtx_count += points * 2;
+    cur->vtx_count += points * 2;
+    cur->idx_count += quads * 6;
+}
+
+// filled when thickness is 0, otherwise its outline with thickness centred on the border
+static void uv__tess_rounded(uv_context_t *ctx, vec2 position, vec2 size, colour_t colour, float rotation, float roundness, uint segments, float thickness) {
+    if (size.x <= 0.f || size.y <= 0.f) return;
+    // any rotation stays within the circle around the corners
+    vec2 middle = v2(position.x + size.x * 0.5f, position.y + size.y * 0.5f);
+    if (uv__culling(ctx) && uv__culled_radius(ctx, middle, (size.x + size.y) * 0.5f + thickness * 0.5f)) return;
+
+    roundness = roundness > 0.f ? (roundness < 1.f ? roundness : 1.f) : 0.f;
+    float radius = roundness * (size.x < size.y ? size.x : size.y) * 0.5f;
+    float half = thickness * 0.5f;
+
+    if (thickness <= 0.f) {
+        if (uv__shape(ctx, middle, size, rotation, radius, 0.f, ctx->cur_uv, colour)) return;
+    }
+    else {
+        // the outline is centred on the border, the shape is its outer edge. the texture
+        // stays on the border, like the tessellated one
+        vec4 uv = ctx->cur_uv;
+        float du = (uv.z - uv.x) * half / size.x;
+        float dv = (uv.w - uv.y) * half / size.y;
+        uv = v4(uv.x - du, uv.y - dv, uv.z + du, uv.w + dv);
+        vec2 outer = v2(size.x + thickness, size.y + thickness);
+        if (uv__shape(ctx, middle, outer, rotation, radius > 0.f ? radius + half : 0.f, thickness, uv, colour)) return;
+    }
+
+    // sharp corners are a single point
+    const vec2 *table = NULL;
+    u32 quarter = 0;
+    if (radius > 0.f) {
+        u32 n = uv__tess_segments(ctx, radius + half, segments * 4, UV_TAU);
+        table = uv__tess_table(ctx, n);
+        quarter = n / 4;
+    }
+
+    u32 points = (quarter + 1) * 4;
+    bool fill = thickness <= 0.f;
+    u32 vtx_count = fill ? points + 1 : points * 2;
+    u32 idx_count = fill ? points * 3 : points * 6;
+
+    uv__chunk_t *chunk = uv__drawlist_reserve(ctx, vtx_count, idx_count);
+    uv_drawdata_t *data = &chunk->data;
+    uv_batch_t *cur = uv__drawlist_batch(ctx, chunk);
+    uv_vertex_t *vtx = data->vertices + data->vtx_count;
+
+    float c = 1.f, s = 0.f;
+    if (rotation != 0.f) {
+        c = cosf(rotation);
+        s = sinf(rotation);
+    }
+
+    vec2 extent = v2(size.x * 0.5f, size.y * 0.5f);
+    uv__colour_t col = uv__pack_colour(colour);
+    vec2 uvc, uvr;
+    uv__tess_circle_uv(ctx, &uvc, &uvr);
+
+    // the corners in the same order as the angles: bottom right, bottom left, top left, top right.
+    // inward is the direction from the corner to the centre of its arc
+    static const vec2 inward[4] = { { -1, -1 }, { 1, -1 }, { 1, 1 }, { -1, 1 } };
+
+    // the inner side of an outline can have sharp corners even if the outer one doesn't
+    float outer = radius + half;
+    float inner = radius > half ? radius - half : 0.f;
+    float inner_offset = radius > half ? radius : half;
+
+    u32 v = fill ? 1 : 0;
+    for (u32 k = 0; k < 4; ++k) {
+        vec2 in = inward[k];
+        vec2 corner = v2(-in.x * extent.x, -in.y * extent.y);
+
+        for (u32 j = 0; j <= quarter; ++j) {
+            vec2 dir = table ? table[(k * quarter + j) % (quarter * 4)] : v2(-in.x, -in.y);
+            vec2 p[2] = {
+                v2(corner.x + in.x * radius + dir.x * outer, corner.y + in.y * radius + dir.y * outer),
+                v2(corner.x + in.x * inner_offset + dir.x * inner, corner.y + in.y * inner_offset + dir.y * inner),
+            };
+
+            for (u32 m = 0; m < (fill ? 1u : 2u); ++m) {
+                vec2 pos = v2(middle.x + c * p[m].x - s * p[m].y, middle.y + s * p[m].x + c * p[m].y);
+                vec2 uv = v2(uvc.x + p[m].x / extent.x * uvr.x, uvc.y + p[m].y / extent.y * uvr.y);
+                vtx[v++] = uv__vertex(ctx, pos, uv, col);
+            }
+        }
+    }
+
+    u32 base = data->vtx_count - cur->vtx_start;
+    if (fill) {
+        vtx[0] = uv__vertex(ctx, middle, uvc, col);
+        uv__write_fan_indices(data, base, points, true);
+    }
+    else {
+        uv__write_strip_indices(data, base, points, true);
+    }
+
+    data->vtx_count += vtx_count;
+    cur->vtx_count += vtx_count;
+    cur->idx_count += idx_count;
+}
+
+void uvCtxDrawCircle(uv_context_t *ctx, vec2 centre, float radius, colour_t colour) {
+    uvCtxDrawCircleEx(ctx, centre, radius, colour, 0);
+}
+
+void uvCtxDrawCircleEx(uv_context_t *ctx, vec2 centre, float radius, colour_t colour, uint segments) {
+    uvCtxDrawArc(ctx, centre, radius, 0.f, UV_TAU, segments, colour);
+}
+
+void uvCtxDrawArc(uv_context_t *ctx, vec2 centre, float radius, float start_angle, float end_angle, uint segments, colour_t colour) {
+    if (radius <= 0.f || start_angle == end_angle) return;
+    if (uv__culling(ctx) && uv__culled_radius(ctx, centre, radius)) return;
+
+    bool full = fabsf(end_angle - start_angle) >= UV_TAU;
+    if (full && uv__shape(ctx, centre, v2(radius * 2.f, radius * 2.f), 0.f, radius, 0.f, ctx->cur_uv, colour)) return;
+
+    uv__arc_t arc = uv__tess_arc(ctx, radius, start_angle, end_angle, segments);
+    uv__tess_fan(ctx, centre, radius, &arc, colour);
+}
+
+void uvCtxDrawArcLines(uv_context_t *ctx, vec2 centre, float radius, float start_angle, float end_angle, uint segments, colour_t colour, float thickness) {
+    float half = thickness * 0.5f;
+    uvCtxDrawRing(ctx, centre, radius - half, radius + half, start_angle, end_angle, segments, colour);
+}
+
+void uvCtxDrawRing(uv_context_t *ctx, vec2 centre, float inner_radius, float outer_radius, float start_angle, float end_angle, uint segments, colour_t colour) {
+    if (inner_radius > outer_radius) {
+        float tmp = inner_radius;
+        inner_radius = outer_radius;
+        outer_radius = tmp;
+    }
+    if (inner_radius <= 0.f) {
+        uvCtxDrawArc(ctx, centre, outer_radius, start_angle, end_angle, segments, colour);
+        return;
+    }
+    if (inner_radius == outer_radius || start_angle == end_angle) return;
+    if (uv__culling(ctx) && uv__culled_radius(ctx, centre, outer_radius)) return;
+
+    bool full = fabsf(end_angle - start_angle) >= UV_TAU;
+    vec2 size = v2(outer_radius * 2.f, outer_radius * 2.f);
+    if (full && uv__shape(ctx, centre, size, 0.f, outer_radius, outer_radius - inner_radius, ctx->cur_uv, colour)) return;
+
+    uv__arc_t arc = uv__tess_arc(ctx, outer_radius, start_angle, end_angle, segments);
+    uv__tess_band(ctx, centre, inner_radius, outer_radius, &arc, colour);
+}
+
+void uvCtxDrawQuadRounded(uv_context_t *ctx, vec2 position, vec2 size, colour_t colour, float rotation, float roundness, uint segments) {
+    uv__tess_rounded(ctx, position, size, colour, rotation, roundness, segments, 0.f);
+}
+
+void uvCtxDrawQuadRoundedLines(uv_context_t *ctx, vec2 position, vec2 size, colour_t colour, float rotation, float roundness, uint segments, float thickness) {
+    if (thickness <= 0.f) return;
+    uv__tess_rounded(ctx, position, size, colour, rotation, roundness, segments, thickness);
+}
+
+// == bezier curves ===================================
+// flattened with forward differencing in as many steps as Wang's formula says the curve needs
+// to stay within tess_tolerance pixels of its segments: more where the control points bend
+// it more. the stroke is a strip with a pair of vertices for each point, shared by the quads
+// on both sides of it. quadratic curves are drawn as the cubic with the same shape
+
+static void uv__tess_cubic(uv_context_t *ctx, vec2 p0, vec2 p1, vec2 p2, vec2 p3, float thickness, colour_t colour) {
+    if (thickness <= 0.f) return;
+    // the curve is inside of the hull of its control points
+    if (uv__culling(ctx)) {
+        vec2 hull[4] = { p0, p1, p2, p3 };
+        if (uv__culled_points(ctx, hull, 4, thickness * 0.5f)) return;
+    }
+
+    float tol = uv__tess_tolerance(ctx);
+    // the second differences of the control points bound how far the curve is from its chords
+    vec2 dd0 = v2(p0.x - 2.f * p1.x + p2.x, p0.y - 2.f * p1.y + p2.y);
+    vec2 dd1 = v2(p1.x - 2.f * p2.x + p3.x, p1.y - 2.f * p2.y + p3.y);
+    float dd = sqrtf(v2mag2(dd0) > v2mag2(dd1) ? v2mag2(dd0) : v2mag2(dd1));
+    float n = ceilf(sqrtf(0.75f * dd / tol));
+    // also catches nan
+    u32 steps = n >= 1.f ? (n < UV_TESS_MAX_SEGMENTS ? (u32)n : UV_TESS_MAX_SEGMENTS) : 1;
+
+    u32 points = steps + 1;
+    uv__chunk_t *chunk = uv__drawlist_reserve(ctx, points * 2, steps * 6);
+    uv_drawdata_t *data = &chunk->data;
+    uv_batch_t *cur = uv__drawlist_batch(ctx, chunk);
+    uv_vertex_t *vtx = data->vertices + data->vtx_count;
+
+    // p(t) = a t^3 + b t^2 + c t + p0, stepped by h
+    float h = 1.f / (float)steps;
+    vec2 a = v2(3.f * (p1.x - p2.x) + p3.x - p0.x, 3.f * (p1.y - p2.y) + p3.y - p0.y);
+    vec2 b = v2(3.f * (p0.x - 2.f * p1.x + p2.x), 3.f * (p0.y - 2.f * p1.y + p2.y));
+    vec2 c = v2(3.f * (p1.x - p0.x), 3.f * (p1.y - p0.y));
+    float h2 = h * h, h3 = h2 * h;
+    vec2 d1 = v2(a.x * h3 + b.x * h2 + c.x * h, a.y * h3 + b.y * h2 + c.y * h);
+    vec2 d2 = v2(6.f * a.x * h3 + 2.f * b.x * h2, 6.f * a.y * h3 + 2.f * b.y * h2);
+    vec2 d3 = v2(6.f * a.x * h3, 6.f * a.y * h3);
+
+    uv__colour_t col = uv__pack_colour(colour);
+    float half = thickness * 0.5f;
+    float du = ctx->cur_uv.z - ctx->cur_uv.x;
+
+    // each pair is across the direction from the previous point to the next one
+    vec2 prev = p0;
+    vec2 pos = p0;
+    vec2 next = steps > 1 ? v2add(p0, d1) : p3;
+    vec2 normal = v2(0.f, 0.f);
+
+    for (u32 i = 0; i < points; ++i) {
+        vec2 dir = v2sub(next, prev);
+        float len2 = v2mag2(dir);
+        // where points overlap (e.g. a control point on the end) the last normal is kept
+        if (len2 > 0.f) {
+            float scale = half / sqrtf(len2);
+            normal = v2(-dir.y * scale, dir.x * scale);
+        }
+        else if (i == 0) {
+            vec2 chord = v2sub(p3, p0);
+            float chord2 = v2mag2(chord);
+            if (chord2 > 0.f) {
+                float scale = half / sqrtf(chord2);
+                normal = v2(-chord.y * scale, chord.x * scale);
+            }
+        }
+
+        float u = ctx->cur_uv.x + du * (float)i * h;
+        vtx[i * 2 + 0] = uv__vertex(ctx, v2sub(pos, normal), v2(u, ctx->cur_uv.y), col);
+        vtx[i * 2 + 1] = uv__vertex(ctx, v2add(pos, normal), v2(u, ctx->cur_uv.w), col);
+
+        d1 = v2add(d1, d2);
+        d2 = v2add(d2, d3);
+        prev = pos;
+        pos = next;
+        // the end is exact, without the error the steps accumulate. it's its own next point
+        if (i + 2 < steps)       next = v2add(next, d1);
+        else if (i + 2 == steps) next = p3;
+    }
+
+    uv__write_strip_indices(data, data->vtx_count - cur->vtx_start, points, false);
+
+    data->vtx_count += points * 2;
+    cur->vtx_count += points * 2;
+    cur->idx_count += steps * 6;
+}
+
+void uvCtxDrawLineBezier(uv_context_t *ctx, vec2 start, vec2 end, float thickness, colour_t colour) {
+    // eases in and out of the two ends horizontally, like the wires of a node graph
+    float mid = (start.x + end.x) * 0.5f;
+    uv__tess_cubic(ctx, start, v2(mid, start.y), v2(mid, end.y), end, thickness, colour);
+}
+
+void uvCtxDrawLineBezierQuad(uv_context_t *ctx, vec2 start, vec2 end, vec2 control_point, float thickness, colour_t colour) {
+    vec2 c1 = v2(start.x + (control_point.x - start.x) * (2.f / 3.f), start.y + (control_point.y - start.y) * (2.f / 3.f));
+    vec2 c2 = v2(end.x + (control_point.x - end.x) * (2.f / 3.f), end.y + (control_point.y - end.y) * (2.f / 3.f));
+    uv__tess_cubic(ctx, start, c1, c2, end, thickness, colour);
+}
+
+void uvCtxDrawLineBeziercubic(uv_context_t *ctx, vec2 start, vec2 end, vec2 start_control, vec2 end_control, float thickness, colour_t colour) {
+    uv__tess_cubic(ctx, start, start_control, end_control, end, thickness, colour);
+}
+
+// == polylines =======================================
+// a strip of pairs of vertices, right then left of the direction of the line like the quads of
+// uvDrawLines, with one pair for each point where the segments meet at a miter. other joins
+// share the vertex on the inner side of the turn and fill the outer side with a triangle or
+// an arc. vertices and indices are reserved in runs, at the start of a run the last pair is
+// written again so the strip stays connected
+
+#define UV_STROKE_RUN_VERTICES 4096
+// miter length over thickness, the same default as svg
+#define UV_MITER_LIMIT         4.f
+
+typedef struct {
+    uv_context_t *ctx;
+    uv__chunk_t *chunk;
+    uv_vertex_t *vtx;
+    // vertices and indices written in this run, and how many were reserved
+    u32 vtx_count;
+    u32 idx_count;
+    u32 vtx_cap;
+    u32 idx_cap;
+    // first vertex of the run relative to its batch
+    u32 base;
+    // pair that the next segment starts from
+    u32 right;
+    u32 left;
+    uv__colour_t col;
+    float half;
+    float u;
+    // one step around the unit circle for round joins and caps, and at most how many a half turn has
+    vec2 step;
+    u32 arc_max;
+    // least |n0 + n1|^2 of joins drawn as a miter: within the miter limit, and for the other
+    // joins where the miter is within tess_tolerance of the round join
+    float miter_min2;
+    float flat_min2;
+} uv__stroke_t;
+
+static void uv__stroke_begin(uv__stroke_t *st, u32 vtx_count, u32 idx_count) {
+    st->chunk = uv__drawlist_reserve(st->ctx, vtx_count, idx_count);
+    uv_drawdata_t *data = &st->chunk->data;
+    st->vtx = data->vertices + data->vtx_count;
+    st->base = data->vtx_count - uv__drawlist_batch(st->ctx, st->chunk)->vtx_start;
+    st->vtx_count = 0;
+    st->idx_count = 0;
+    st->vtx_cap = vtx_count;
+    st->idx_cap = idx_count;
+}
+
+static void uv__stroke_end(uv__stroke_t *st) {
+    uv_drawdata_t *data = &st->chunk->data;
+    uv_batch_t *cur = uv__drawlist_batch(st->ctx, st->chunk);
+    data->vtx_count += st->vtx_count;
+    data->idx_count += st->idx_count;
+    cur->vtx_count += st->vtx_count;
+    cur->idx_count += st->idx_count;
+}
+
+// starts a new run if the next step could not fit in this one
+static void uv__stroke_reserve(uv__stroke_t *st, u32 vtx_count, u32 idx_count) {
+    if (st->vtx_count + vtx_count <= st->vtx_cap && st->idx_count + idx_count <= st->idx_cap) {
+        return;
+    }
+
+    uv_vertex_t pair[2] = { st->vtx[st->right], st->vtx[st->left] };
+    uv__stroke_end(st);
+    uv__stroke_begin(st, st->vtx_cap, st->idx_cap);
+
+    st->vtx[0] = pair[0];
+    st->vtx[1] = pair[1];
+    st->right = 0;
+    st->left = 1;
+    st->vtx_count = 2;
+}
+
+static u32 uv__stroke_vertex(uv__stroke_t *st, vec2 pos, float v) {
+    st->vtx[st->vtx_count] = uv__vertex(st->ctx, pos, v2(st->u, v), st->col);
+    return st->vtx_count++;
+}
+
+static void uv__stroke_tri(uv__stroke_t *st, u32 a, u32 b, u32 c) {
+    uv_drawdata_t *data = &st->chunk->data;
+    u32 at = data->idx_count + st->idx_count;
+    if (data->index_size == sizeof(u16)) {
+        u16 *idx = (u16 *)data->indices + at;
+        idx[0] = (u16)(st->base + a);
+        idx[1] = (u16)(st->base + b);
+        idx[2] = (u16)(st->base + c);
+    }
+    else {
+        u32 *idx = (u32 *)data->indices + at;
+        idx[0] = st->base + a;
+        idx[1] = st->base + b;
+        idx[2] = st->base + c;
+    }
+    st->idx_count += 3;
+}
+
+// quad from the current pair to this one, which becomes the current pair
+static void uv__stroke_quad_to(uv__stroke_t *st, u32 right, u32 left) {
+    uv__stroke_tri(st, st->right, st->left, right);
+    uv__stroke_tri(st, right, st->left, left);
+    st->right = right;
+    st->left = left;
+}
+
+static inline float uv__cross(vec2 a, vec2 b) {
+    return a.x * b.y - a.y * b.x;
+}
+
+// fan from centre over the arc around pos from the vertex first (in the direction from) to
+// last (in the direction to). the arc turns towards positive angles when sign is positive
+static void uv__stroke_arc(uv__stroke_t *st, u32 centre, vec2 pos, vec2 from, vec2 to, u32 first, u32 last, float sign, float v) {
+    float s = st->step.y * sign;
+    u32 prev = first;
+    vec2 dir = from;
+
+    for (u32 k = 0; k < st->arc_max; ++k) {
+        dir = v2(dir.x * st->step.x - dir.y * s, dir.x * s + dir.y * st->step.x);
+        if (uv__cross(dir, to) * sign <= 0.f) break;
+
+        u32 cur = uv__stroke_vertex(st, v2(pos.x + dir.x * st->half, pos.y + dir.y * st->half), v);
+        if (sign > 0.f) uv__stroke_tri(st, centre, cur, prev);
+        else            uv__stroke_tri(st, centre, prev, cur);
+        prev = cur;
+    }
+
+    if (sign > 0.f) uv__stroke_tri(st, centre, last, prev);
+    else            uv__stroke_tri(st, centre, prev, last);
+}
+
+// pair across pos for a segment going in direction dir
+static void uv__stroke_pair(uv__stroke_t *st, vec2 pos, vec2 dir, bool connect) {
+    vec2 n = v2(-dir.y * st->half, dir.x * st->half);
+    u32 right = uv__stroke_vertex(st, v2sub(pos, n), st->ctx->cur_uv.y);
+    u32 left = uv__stroke_vertex(st, v2add(pos, n), st->ctx->cur_uv.w);
+    if (connect) {
+        uv__stroke_quad_to(st, right, left);
+    }
+    else {
+        st->right = right;
+        st->left = left;
+    }
+}
+
+static void uv__stroke_cap(uv__stroke_t *st, vec2 pos, vec2 dir, uv_line_cap_e cap, bool start) {
+    if (cap == UV_LINE_CAP_SQUARE) {
+        vec2 ext = v2(dir.x * st->half, dir.y * st->half);
+        pos = start ? v2sub(pos, ext) : v2add(pos, ext);
+    }
+
+    uv__stroke_pair(st, pos, dir, !start);
+
+    if (cap == UV_LINE_CAP_ROUND) {
+        // around the back of the start and the front of the end, both turning towards positive angles
+        u32 centre = uv__stroke_vertex(st, pos, (st->ctx->cur_uv.y + st->ctx->cur_uv.w) * 0.5f);
+        vec2 n = v2(-dir.y, dir.x);
+        if (start) uv__stroke_arc(st, centre, pos, n, v2(-n.x, -n.y), st->left, st->right, 1.f, st->ctx->cur_uv.y);
+        else       uv__stroke_arc(st, centre, pos, v2(-n.x, -n.y), n, st->right, st->left, 1.f, st->ctx->cur_uv.w);
+    }
+}
+
+// where the segment with direction d0 meets the one with direction d1. the pair where the first
+// segment ends is only written with finish, the one where the second starts with start
+static void uv__stroke_join(uv__stroke_t *st, vec2 pos, vec2 d0, vec2 d1, float min_length, uv_line_join_e join, bool finish, bool start) {
+    float half = st->half;
+    vec2 n0 = v2(-d0.y, d0.x);
+    vec2 n1 = v2(-d1.y, d1.x);
+    vec2 m = v2add(n0, n1);
+    float m2 = v2mag2(m);
+    float vr = st->ctx->cur_uv.y;
+    float vl = st->ctx->cur_uv.w;
+
+    // |n0 + n1| is 2 cos of half the turn, so the miter is half * 2 / |m| long, along m
+    vec2 miter = m2 > 1e-12f ? v2(m.x * 2.f * half / m2, m.y * 2.f * half / m2) : v2(0.f, 0.f);
+
+    if (m2 >= (join == UV_LINE_JOIN_MITER ? st->miter_min2 : st->flat_min2)) {
+        u32 right = uv__stroke_vertex(st, v2sub(pos, miter), vr);
+        u32 left = uv__stroke_vertex(st, v2add(pos, miter), vl);
+        if (finish) uv__stroke_quad_to(st, right, left);
+        st->right = right;
+        st->left = left;
+        return;
+    }
+
+    // the inner corner doesn't go past the end of the shorter segment
+    float limit2 = half * half + min_length * min_length;
+    float miter2 = v2mag2(miter);
+    if (miter2 > limit2) {
+        float scale = sqrtf(limit2 / miter2);
+        miter = v2(miter.x * scale, miter.y * scale);
+    }
+
+    // turning left the inner side is on the left
+    float turn = uv__cross(d0, d1) >= 0.f ? 1.f : -1.f;
+    vec2 inner = turn > 0.f ? v2add(pos, miter) : v2sub(pos, miter);
+    vec2 o0 = v2(n0.x * -turn, n0.y * -turn);
+    vec2 o1 = v2(n1.x * -turn, n1.y * -turn);
+    float vi = turn > 0.f ? vl : vr;
+    float vo = turn > 0.f ? vr : vl;
+
+    u32 in = uv__stroke_vertex(st, inner, vi);
+
+    if (finish) {
+        u32 out = uv__stroke_vertex(st, v2(pos.x + o0.x * half, pos.y + o0.y * half), vo);
+        if (turn > 0.f) uv__stroke_quad_to(st, out, in);
+        else            uv__stroke_quad_to(st, in, out);
+    }
+    if (!start) return;
+
+    u32 out = uv__stroke_vertex(st, v2(pos.x + o1.x * half, pos.y + o1.y * half), vo);
+    if (finish) {
+        u32 prev = turn > 0.f ? st->right : st->left;
+        if (join == UV_LINE_JOIN_ROUND) {
+            uv__stroke_arc(st, in, pos, o0, o1, prev, out, turn, vo);
+        }
+        else if (turn > 0.f) {
+            uv__stroke_tri(st, in, out, prev);
+        }
+        else {
+            uv__stroke_tri(st, in, prev, out);
+        }
+    }
+
+    st->right = turn > 0.f ? out : in;
+    st->left = turn > 0.f ? in : out;
+}
+
+static inline bool uv__same_point(vec2 a, vec2 b) {
+    return a.x == b.x && a.y == b.y;
+}
+
+static inline vec2 uv__direction(vec2 from, vec2 to, float *length) {
+    vec2 d = v2sub(to, from);
+    *length = v2mag(d);
+    return v2(d.x / *length, d.y / *length);
+}
+
+// next point after i that isn't the same as it, count if there isn't one
+static inline u32 uv__next_point(const vec2 *points, u32 count, u32 i) {
+    u32 j = i + 1;
+    while (j < count && uv__same_point(points[j], points[i])) ++j;
+    return j;
+}
+
+static void uv__stroke_polyline(uv_context_t *ctx, const vec2 *points, u32 count, float thickness, colour_t colour, uv_line_join_e join, uv_line_cap_e cap, bool closed) {
+    if (thickness <= 0.f || count < 2) return;
+
+    // the end of a closed polyline is its start
+    while (closed && count > 1 && uv__same_point(points[count - 1], points[0])) --count;
+
+    u32 second = uv__next_point(points, count, 0);
+    if (second >= count) return;
+    // miters and square caps don't go farther than this from the points
+    if (uv__culling(ctx) && uv__culled_points(ctx, points, count, thickness * 0.5f * UV_MITER_LIMIT)) return;
+
+    uv__stroke_t st = {
+        .ctx = ctx,
+        .col = uv__pack_colour(colour),
+        .half = thickness * 0.5f,
+    };
+
+    // the miter is half / cos(turn / 2) long, and |n0 + n1| = 2 cos(turn / 2)
+    float tol = uv__tess_tolerance(ctx);
+    float flat = 2.f / (1.f + tol / st.half);
+    st.miter_min2 = 4.f / (UV_MITER_LIMIT * UV_MITER_LIMIT);
+    st.flat_min2 = flat * flat;
+
+    // round joins and caps have as many segments as a circle as thick as the line
+    u32 segments = uv__tess_segments(ctx, st.half, 0, UV_TAU);
+    st.step = uv__tess_table(ctx, segments)[1];
+    st.arc_max = join == UV_LINE_JOIN_ROUND || cap == UV_LINE_CAP_ROUND ? segments / 2 + 1 : 0;
+
+    // the most a single join or cap can write
+    u32 step_vtx = 4 + st.arc_max;
+    u32 step_idx = 6 + 3 * (st.arc_max + 1);
+    u32 run_vtx = UV_STROKE_RUN_VERTICES > step_vtx * 4 ? UV_STROKE_RUN_VERTICES : step_vtx * 4;
+    // every join and cap writes at most 3 indices for each of its vertices
+    uv__stroke_begin(&st, run_vtx, run_vtx * 3);
+
+    float du = (ctx->cur_uv.z - ctx->cur_uv.x) / (float)(count - 1);
+    float first_len = 0.f;
+    vec2 first_dir = uv__direction(points[0], points[second], &first_len);
+
+    st.u = ctx->cur_uv.x;
+    if (closed) {
+        float len = 0.f;
+        vec2 dir = uv__direction(points[count - 1], points[0], &len);
+        uv__stroke_join(&st, points[0], dir, first_dir, len < first_len ? len : first_len, join, false, true);
+    }
+    else {
+        uv__stroke_cap(&st, points[0], first_dir, cap, true);
+    }
+
+    vec2 d0 = first_dir;
+    float len0 = first_len;
+    for (u32 i = second; i < count;) {
+        u32 next = uv__next_point(points, count, i);
+        st.u = ctx->cur_uv.x + du * (float)i;
+        uv__stroke_reserve(&st, step_vtx, step_idx);
+
+        if (next >= count && !closed) {
+            uv__stroke_cap(&st, points[i], d0, cap, false);
+            break;
+        }
+
+        float len1 = 0.f;
+        vec2 d1 = uv__direction(points[i], points[next < count ? next : 0], &len1);
+        uv__stroke_join(&st, points[i], d0, d1, len0 < len1 ? len0 : len1, join, true, true);
+
+        if (next >= count) {
+            // back to where the first segment starts
+            st.u = ctx->cur_uv.z;
+            uv__stroke_reserve(&st, step_vtx, step_idx);
+            uv__stroke_join(&st, points[0], d1, first_dir, len1 < first_len ? len1 : first_len, join, true, false);
+        }
+
+        d0 = d1;
+        len0 = len1;
+        i = next;
+    }
+
+    uv__stroke_end(&st);
+}
+
+void uvCtxDrawPolyline(uv_context_t *ctx, const vec2 *points, u32 count, float thickness, colour_t colour, uv_line_join_e join, uv_line_cap_e cap) {
+    uv__stroke_polyline(ctx, points, count, thickness, colour, join, cap, false);
+}
+
+void uvCtxDrawQuadLines(uv_context_t *ctx, vec2 position, vec2 size, colour_t colour, float rotation, float thickness) {
+    vec2 half = v2(size.x * 0.5f, size.y * 0.5f);
+    vec2 centre = v2add(position, half);
+
+    float c = 1.f, s = 0.f;
+    if (rotation != 0.f) {
+        c = cosf(rotation);
+        s = sinf(rotation);
+    }
+
+    // same corners as uv__sprite_vertices, going around clockwise
+    vec2 ax = v2(half.x * c, half.x * s);
+    vec2 ay = v2(-half.y * s, half.y * c);
+    vec2 corners[4] = {
+        v2sub(v2sub(centre, ax), ay),
+        v2sub(v2add(centre, ax), ay),
+        v2add(v2add(centre, ax), ay),
+        v2add(v2sub(centre, ax), ay),
+    };
+    uv__stroke_polyline(ctx, corners, 4, thickness, colour, UV_LINE_JOIN_MITER, UV_LINE_CAP_BUTT, true);
+}
+
+void uvCtxDrawTriangleLines(uv_context_t *ctx, vec2 v1, vec2 v2, vec2 v3, colour_t colour, float thickness) {
+    vec2 corners[3] = { v1, v2, v3 };
+    uv__stroke_polyline(ctx, corners, 3, thickness, colour, UV_LINE_JOIN_MITER, UV_LINE_CAP_BUTT, true);
+}
+
+// == sprites =========================================
+// with UV_CAP_INSTANCES a sprite is a single uv_instance_t, the backend makes the quad.
+// otherwise it's expanded here like the bulk quads
+
+// the sprite's uv rectangle inside of the current texture
+static inline vec4 uv__sprite_uv(const uv_context_t *ctx, const uv_sprite_t *sprite) {
+    float du = ctx->cur_uv.z - ctx->cur_uv.x;
+    float dv = ctx->cur_uv.w - ctx->cur_uv.y;
+    return v4(
+        ctx->cur_uv.x + sprite->uv.x * du, ctx->cur_uv.y + sprite->uv.y * dv,
+        ctx->cur_uv.x + sprite->uv.z * du, ctx->cur_uv.y + sprite->uv.w * dv
+    );
+}
+
+// sprites that aren't rotated are cut to the clip rect like the quads
+static inline uv_sprite_t uv__sprite_clip(vec4 clip, const uv_sprite_t *sprite) {
+    uv_sprite_t cut = *sprite;
+    if (cut.rotation == 0.f) {
+        uv__clip_rect(clip, &cut.position, &cut.size, &cut.uv);
+    }
+    return cut;
+}
+
+static inline bool uv__sprite_culled(uv_context_t *ctx, const uv_sprite_t *sprite) {
+    vec2 box[2] = { sprite->position, v2add(sprite->position, sprite->size) };
+    if (sprite->rotation == 0.f) {
+        return uv__culled_points(ctx, box, 2, 0.f);
+    }
+    // the rotated corners never go farther than the sum of the half extents
+    vec2 centre = v2(sprite->position.x + sprite->size.x * 0.5f, sprite->position.y + sprite->size.y * 0.5f);
+    return uv__culled_radius(ctx, centre, (fabsf(sprite->size.x) + fabsf(sprite->size.y)) * 0.5f);
+}
+
+static void uv__sprite_vertices(const uv_context_t *ctx, uv_vertex_t *out, const uv_sprite_t *sprite) {
+    vec2 half = v2(sprite->size.x * 0.5f, sprite->size.y * 0.5f);
+    vec2 centre = v2add(sprite->position, half);
+
+    float c = 1.f, s = 0.f;
+    if (sprite->rotation != 0.f) {
+        c = cosf(sprite->rotation);
+        s = sinf(sprite->rotation);
+    }
+
+    // half extents along the rotated axes of the sprite
+    vec2 ax = v2(half.x * c, half.x * s);
+    vec2 ay = v2(-half.y * s, half.y * c);
+
+    vec4 uv = uv__sprite_uv(ctx, sprite);
+    uv__colour_t col = uv__pack_colour(sprite->colour);
+
+    out[0] = uv__vertex(ctx, v2sub(v2sub(centre, ax), ay), v2(uv.x, uv.y), col);
+    out[1] = uv__vertex(ctx, v2add(v2sub(centre, ax), ay), v2(uv.x, uv.w), col);
+    out[2] = uv__vertex(ctx, v2sub(v2add(centre, ax), ay), v2(uv.z, uv.y), col);
+    out[3] = uv__vertex(ctx, v2add(v2add(centre, ax), ay), v2(uv.z, uv.w), col);
+}
+
+void uvCtxDrawQuadRot(uv_context_t *ctx, vec2 position, vec2 size, colour_t colour, float rotation) {
+    uv_sprite_t sprite = { position, size, rotation, v4(0, 0, 1, 1), colour };
+    if (uv__culling(ctx) && uv__sprite_culled(ctx, &sprite)) return;
+
+    uv__chunk_t *chunk = uv__drawlist_reserve(ctx, 4, 6);
+    uv__sprite_vertices(ctx, chunk->data.vertices + chunk->data.vtx_count, &sprite);
+    uv__commit_quads(ctx, chunk, 1);
+}
+
+void uvCtxDrawSprites(uv_context_t *ctx, const uv_sprite_t *sprites, u32 count) {
+    bool cull = uv__culling(ctx);
+    vec4 clip_rect;
+    bool clip = uv__clip_local(ctx, &clip_rect);
+
+    // an instance is still a rotated rectangle after a similarity, anything else is expanded
+    bool expand = !(ctx->backend_caps & UV_CAP_INSTANCES);
+    float scale = 1.f, angle = 0.f;
+    if (ctx->transformed && !expand) {
+        expand = !uv__transform_similarity(ctx, &scale, &angle);
+    }
+
+    if (expand) {
+        while (count) {
+            u32 n = count < UV_BULK_MAX_QUADS ? count : UV_BULK_MAX_QUADS;
+            uv__chunk_t *chunk = uv__drawlist_reserve(ctx, n * 4, n * 6);
+            uv_vertex_t *vtx = chunk->data.vertices + chunk->data.vtx_count;
+            u32 written = 0;
+
+            for (u32 i = 0; i < n; ++i) {
+                if (cull && uv__sprite_culled(ctx, &sprites[i])) continue;
+                if (clip) {
+                    uv_sprite_t cut = uv__sprite_clip(clip_rect, &sprites[i]);
+                    uv__sprite_vertices(ctx, vtx + written * 4, &cut);
+                }
+                else {
+                    uv__sprite_vertices(ctx, vtx + written * 4, &sprites[i]);
+                }
+                written++;
+            }
+
+            uv__commit_quads(ctx, chunk, written);
+            sprites += n;
+            count -= n;
+        }
+        return;
+    }
+
+    if (!count) return;
+
+    uv__chunk_t *chunk = uv__drawlist_chunk(ctx);
+    uv_batch_t *cur = uv__drawlist_reserve_instances(ctx, chunk, count);
+    uv_instance_t *out = chunk->data.instances + chunk->data.inst_count;
+    u32 written = 0;
+
+    for (u32 i = 0; i < count; ++i) {
+        const uv_sprite_t *sprite = &sprites[i];
+        if (cull && uv__sprite_culled(ctx, sprite)) continue;
+        uv_sprite_t cut;
+        if (clip) {
+            cut = uv__sprite_clip(clip_rect, sprite);
+            sprite = &cut;
+        }
+
+        vec2 pos = sprite->position;
+        vec2 size = sprite->size;
+        float rotation = sprite->rotation;
+        if (ctx->transformed) {
+            // the centre moves, the rest is scaled and rotated around it
+            vec2 centre = v2(pos.x + size.x * 0.5f, pos.y + size.y * 0.5f);
+            centre = uv__transform_point(&ctx->transform, centre);
+            size = v2(size.x * scale, size.y * scale);
+            pos = v2(centre.x - size.x * 0.5f, centre.y - size.y * 0.5f);
+            rotation += angle;
+        }
+
+        out[written++] = (uv_instance_t){
+            .pos = pos,
+            .size = size,
+            .rotation = rotation,
+            .radius = -1.f,
+            .uv = uv__sprite_uv(ctx, sprite),
+            .col = uv__pack_colour(sprite->colour),
+#if UV_TEXTURE_SLOTS > 1
+            .slot = ctx->cur_slot,
+#endif
+        };
+    }
+
+    chunk->data.inst_count += written;
+    cur->inst_count += written;
+}
+
+// == meshes ==========================================
+// a mesh lives in the backend, uvDrawMesh only adds a uv_mesh_draw_t to the draw list.
+// consecutive draws with the same texture share a batch
+
+mesh_t uvCtxCreateMesh(uv_context_t *ctx, const vec2 *positions, const vec2 *uvs, const colour_t *colours, u32 vtx_count, const u32 *indices, u32 idx_count) {
+    if (!positions || !vtx_count) return 0;
+    if (!indices) idx_count = vtx_count;
+    if (!idx_count) return 0;
+
+    bool narrow = vtx_count <= UV_MAX_U16_VERTICES && (ctx->backend_caps & UV_CAP_INDEX_U16);
+    u32 index_size = narrow ? sizeof(u16) : sizeof(u32);
+
+    uv_vertex_t *vertices = UV_REALLOC(NULL, sizeof(uv_vertex_t) * vtx_count, allocator_udata);
+    u8 *mesh_indices = UV_REALLOC(NULL, (usize)index_size * idx_count, allocator_udata);
+    UV_ASSERT(vertices && mesh_indices);
+
+    for (u32 i = 0; i < vtx_count; ++i) {
+        vec2 uv = uvs ? uvs[i] : v2(0, 0);
+        colour_t col = colours ? colours[i] : UV_WHITE;
+        // in the mesh's own space, the transform is applied when it's drawn
+        vertices[i] = uv__vertex_local(ctx, positions[i], uv, uv__pack_colour(col));
+#if UV_TEXTURE_SLOTS > 1
+        vertices[i].slot = 0;
+#endif
+    }
+
+    for (u32 i = 0; i < idx_count; ++i) {
+        u32 index = indices ? indices[i] : i;
+        UV_ASSERT(index < vtx_count);
+        if (narrow) {
+            ((u16 *)mesh_indices)[i] = (u16)index;
+        }
+        else {
+            ((u32 *)mesh_indices)[i] = index;
+        }
+    }
+
+    mesh_t mesh = uv__backend_create_mesh(ctx->gfx_data, vertices, vtx_count, mesh_indices, index_size, idx_count);
+
+    UV_FREE(vertices, allocator_udata);
+    UV_FREE(mesh_indices, allocator_udata);
+    return mesh;
+}
+
+void uvCtxFreeMesh(uv_context_t *ctx, mesh_t mesh) {
+    if (mesh) {
+        // the handle could be given to a new mesh
+        ctx->frame_epoch++;
+        uv__backend_free_mesh(ctx->gfx_data, mesh);
+    }
+}
+
+void uvCtxDrawMesh(uv_context_t *ctx, mesh_t mesh, vec2 position, float rotation, vec2 scale, colour_t tint) {
+    if (!mesh) return;
+
+    uv__chunk_t *chunk = uv__drawlist_chunk(ctx);
+    uv_drawdata_t *data = &chunk->data;
+
+    if (data->mesh_count >= chunk->mesh_cap) {
+        // like batches, mesh draws are only referenced by index so they can always move
+        chunk->mesh_cap = chunk->mesh_cap ? chunk->mesh_cap * 2 : UV_MIN_CHUNK_MESHES;
+        data->meshes = UV_REALLOC(data->meshes, sizeof(uv_mesh_draw_t) * chunk->mesh_cap, allocator_udata);
+        UV_ASSERT(data->meshes);
+    }
+
+    // the mesh's vertices sample slot 0, so the current texture must be the batch's first one
+    uv_batch_t *cur = uv__drawlist_batch(ctx, chunk);
+    if (!cur->mesh_count || ctx->cur_slot != 0) {
+#if UV_TEXTURE_SLOTS > 1
+        texture_t texture = cur->textures[ctx->cur_slot];
+#else
+        texture_t texture = cur->texture;
+#endif
+        if (uv__batch_is_empty(cur)) {
+            cur->texture = texture;
+#if UV_TEXTURE_SLOTS > 1
+            cur->textures[0] = texture;
+            cur->texture_count = 1;
+#endif
+        }
+        else {
+            cur = uv__drawlist_push_batch(ctx, chunk, texture);
+        }
+        ctx->cur_slot = 0;
+    }
+
+    float c = cosf(rotation);
+    float s = sinf(rotation);
+
+    uv_mesh_draw_t *draw = &data->meshes[data->mesh_count++];
+    *draw = (uv_mesh_draw_t){
+        .mesh = mesh,
+        .transform = {
+            c * scale.x, -s * scale.y, position.x,
+            s * scale.x,  c * scale.y, position.y,
+        },
+        .uv = ctx->cur_uv,
+        .tint = tint,
+    };
+
+    // the current transform goes after the mesh's own
+    if (ctx->transformed) {
+        const float *a = ctx->transform.m;
+        float b[6];
+        UV_MEMCPY(b, draw->transform, sizeof(b));
+        draw->transform[0] = a[0] * b[0] + a[1] * b[3];
+        draw->transform[1] = a[0] * b[1] + a[1] * b[4];
+        draw->transform[2] = a[0] * b[2] + a[1] * b[5] + a[2];
+        draw->transform[3] = a[3] * b[0] + a[4] * b[3];
+        draw->transform[4] = a[3] * b[1] + a[4] * b[4];
+        draw->transform[5] = a[3] * b[2] + a[4] * b[5] + a[5];
+    }
+    cur->mesh_count++;
+}
+
+// == text ============================================
+// fonts are parsed and rasterized here: the quadratic outlines of the glyf table are flattened
+// and their coverage is accumulated as signed areas, there is no hinting. every glyph a context
+// draws is kept in one glyph atlas made of square cells of a few sizes, once it's full a new
+// glyph takes the cell of the least recently used one of its size. the layout of the strings a
+// font drew is kept in a small cache, so drawing the same label again only writes its quads
+
+#define UV_GLYPH_ATLAS_SIZE 1024
+// transparent border around every glyph, so nothing bleeds from its neighbours
+#define UV_GLYPH_PADDING    1
+#define UV_GLYPH_CLASSES    10
+#define UV_GLYPH_NONE       UINT32_MAX
+// strings with their layout in each font, must be a power of 2
+#define UV_TEXT_RUNS        256
+// how far, in pixels, the flattened curves can be from the outline
+#define UV_GLYPH_TOLERANCE  0.2f
+// a glyph with more components or points than this, counting every time a compound glyph
+// uses another, is broken and left empty
+#define UV_GLYPH_MAX_COMPONENTS 256
+#define UV_GLYPH_MAX_POINTS     65536
+
+// side of the cells of every size class
+static const u32 uv__glyph_cell_sizes[UV_GLYPH_CLASSES] = { 8, 12, 16, 24, 32, 48, 64, 96, 128, 256 };
+
+typedef struct {
+    // size of the bitmap and its top left from the pen, which is on the baseline
+    u32 width, height;
+    int x, y;
+    float advance;
+    // in the glyph atlas, UV_GLYPH_NONE while it isn't in there
+    u32 cell;
+    u16 id;
+} uv__glyph_t;
+
+typedef struct {
+    // in the font's glyphs
+    u32 glyph;
+    // from the top left of the string
+    vec2 pen;
+} uv__run_glyph_t;
+
+typedef struct {
+    u64 hash;
+    vec(char) text;
+    vec(uv__run_glyph_t) glyphs;
+    vec2 size;
+} uv__text_run_t;
+
+typedef struct {
+    uv_context_t *ctx;
+    u8 *data;
+    u32 size;
+    // offsets of the tables, 0 when the font doesn't have one
+    u32 cmap, loca, glyf, hmtx, kern;
+    u16 cmap_format;
+    bool long_loca;
+    u32 glyph_count;
+    u32 hmetric_count;
+    // from font units to pixels
+    float scale;
+    float ascent;
+    float line_height;
+    // index + 1 in glyphs for every glyph id, 0 until it's first used
+    u32 *glyph_map;
+    vec(uv__glyph_t) glyphs;
+    uv__text_run_t *runs;
+} uv__font_t;
+
+typedef struct {
+    u32 x, y;
+    u32 size_class;
+    // most recently used list of its size class, or the free list (only next)
+    u32 prev, next;
+    u32 frame;
+    // glyph in the cell, font is NULL while it's free
+    uv__font_t *font;
+    u32 glyph;
+} uv__glyph_cell_t;
+
+typedef struct {
+    // the shelf being filled, shelf_x is the atlas size when there's none
+    u32 shelf_x, shelf_y;
+    // most and least recently used cells
+    u32 head, tail;
+    u32 free;
+} uv__glyph_class_t;
+
+// the contours of a glyph in font units, a compound glyph has the points of all its components.
+// ends has the last point of every contour
+typedef struct {
+    vec(vec2) points;
+    vec(u8) flags;
+    vec(u32) ends;
+    // read so far, compound glyphs can use the same components many times
+    u32 components;
+} uv__outline_t;
+
+struct uv__glyph_atlas_t {
+    texture_t handle;
+    u32 size;
+    // shelves are stacked from the top, this is the first row under them
+    u32 top;
+    uv__glyph_class_t classes[UV_GLYPH_CLASSES];
+    vec(uv__glyph_cell_t) cells;
+    // scratch for rasterizing and uploading a cell
+    uv__outline_t outline;
+    vec(float) coverage;
+    vec(u8) pixels;
+};
+
+// -- parsing --
+
+static inline u32 uv__ttf_u8(const uv__font_t *font, u32 at) {
+    return at < font->size ? font->data[at] : 0;
+}
+
+static inline u32 uv__ttf_u16(const uv__font_t *font, u32 at) {
+    return uv__ttf_u8(font, at) << 8 | uv__ttf_u8(font, at + 1);
+}
+
+static inline int uv__ttf_i16(const uv__font_t *font, u32 at) {
+    return (int)(int16_t)uv__ttf_u16(font, at);
+}
+
+static inline u32 uv__ttf_u32(const uv__font_t *font, u32 at) {
+    return uv__ttf_u16(font, at) << 16 | uv__ttf_u16(font, at + 2);
+}
+
+static u32 uv__ttf_table(const uv__font_t *font, const char *tag) {
+    u32 count = uv__ttf_u16(font, 4);
+    u32 want = (u32)tag[0] << 24 | (u32)tag[1] << 16 | (u32)tag[2] << 8 | (u32)tag[3];
+    for (u32 i = 0; i < count; ++i) {
+        u32 record = 12 + i * 16;
+        if (uv__ttf_u32(font, record) == want) {
+            u32 offset = uv__ttf_u32(font, record + 8);
+            return offset < font->size ? offset : 0;
+        }
+    }
+    return 0;
+}
+
+// the unicode subtable, format 12 (full range) if there is one, otherwise format 4
+static bool uv__ttf_parse_cmap(uv__font_t *font, u32 cmap) {
+    u32 count = uv__ttf_u16(font, cmap + 2);
+    for (u32 i = 0; i < count; ++i) {
+        u32 record = cmap + 4 + i * 8;
+        u32 platform = uv__ttf_u16(font, record);
+        u32 encoding = uv__ttf_u16(font, record + 2);
+        u32 table = cmap + uv__ttf_u32(font, record + 4);
+        u32 format = uv__ttf_u16(font, table);
+
+        bool unicode = platform == 0 || (platform == 3 && (encoding == 1 || encoding == 10));
+        if (!unicode || (format != 4 && format != 12)) continue;
+        if (!font->cmap || format == 12) {
+            font->cmap = table;
+            font->cmap_format = (u16)format;
+        }
+    }
+    return font->cmap != 0;
+}
+
+static bool uv__font_parse(uv__font_t *font, float pixel_size) {
+    // only plain TrueType, not collections or CFF outlines
+    u32 version = uv__ttf_u32(font, 0);
+    if (version != 0x00010000 && version != 0x74727565) return false;
+
+    u32 head = uv__ttf_table(font, "head");
+    u32 hhea = uv__ttf_table(font, "hhea");
+    u32 maxp = uv__ttf_table(font, "maxp");
+    u32 cmap = uv__ttf_table(font, "cmap");
+    font->loca = uv__ttf_table(font, "loca");
+    font->glyf = uv__ttf_table(font, "glyf");
+    font->hmtx = uv__ttf_table(font, "hmtx");
+    font->kern = uv__ttf_table(font, "kern");
+    if (!head || !hhea || !maxp || !cmap || !font->loca || !font->glyf || !font->hmtx) return false;
+    if (!uv__ttf_parse_cmap(font, cmap)) return false;
+
+    font->long_loca = uv__ttf_i16(font, head + 50) != 0;
+    font->glyph_count = uv__ttf_u16(font, maxp + 4);
+    font->hmetric_count = uv__ttf_u16(font, hhea + 34);
+    if (!font->glyph_count || !font->hmetric_count) return false;
+
+    int ascender = uv__ttf_i16(font, hhea + 4);
+    int descender = uv__ttf_i16(font, hhea + 6);
+    int line_gap = uv__ttf_i16(font, hhea + 8);
+    if (ascender - descender <= 0) return false;
+
+    font->scale = pixel_size / (float)(ascender - descender);
+    font->ascent = (float)ascender * font->scale;
+    font->line_height = (float)(ascender - descender + line_gap) * font->scale;
+    return true;
+}
+
+static u32 uv__ttf_glyph_id(const uv__font_t *font, u32 codepoint) {
+    u32 t = font->cmap;
+
+    if (font->cmap_format == 12) {
+        u32 lo = 0, hi = uv__ttf_u32(font, t + 12);
+        while (lo < hi) {
+            u32 mid = (lo + hi) / 2;
+            u32 group = t + 16 + mid * 12;
+            u32 start = uv__ttf_u32(font, group);
+            u32 end = uv__ttf_u32(font, group + 4);
+            if (codepoint < start)    hi = mid;
+            else if (codepoint > end) lo = mid + 1;
+            else return uv__ttf_u32(font, group + 8) + codepoint - start;
+        }
+        return 0;
+    }
+
+    if (codepoint > 0xffff) return 0;
+    u32 seg_x2 = uv__ttf_u16(font, t + 6);
+    u32 ends = t + 14;
+    u32 starts = ends + seg_x2 + 2;
+    u32 deltas = starts + seg_x2;
+    u32 ranges = deltas + seg_x2;
+
+    // the segments are sorted by their end
+    u32 lo = 0, hi = seg_x2 / 2;
+    while (lo < hi) {
+        u32 mid = (lo + hi) / 2;
+        if (uv__ttf_u16(font, ends + mid * 2) < codepoint) lo = mid + 1;
+        else hi = mid;
+    }
+    if (lo >= seg_x2 / 2) return 0;
+
+    u32 start = uv__ttf_u16(font, starts + lo * 2);
+    if (codepoint < start) return 0;
+
+    u32 delta = uv__ttf_u16(font, deltas + lo * 2);
+    u32 range = uv__ttf_u16(font, ranges + lo * 2);
+    if (!range) return (codepoint + delta) & 0xffff;
+
+    u32 id = uv__ttf_u16(font, ranges + lo * 2 + range + (codepoint - start) * 2);
+    return id ? (id + delta) & 0xffff : 0;
+}
+
+static float uv__ttf_advance(const uv__font_t *font, u32 id) {
+    u32 i = id < font->hmetric_count ? id : font->hmetric_count - 1;
+    return (float)uv__ttf_u16(font, font->hmtx + i * 4) * font->scale;
+}
+
+// horizontal kerning from the first subtable of the kern table, in pixels
+static float uv__ttf_kern(const uv__font_t *font, u32 left, u32 right) {
+    if (!font->kern || uv__ttf_u16(font, font->kern) != 0 || !uv__ttf_u16(font, font->kern + 2)) return 0.f;
+
+    u32 sub = font->kern + 4;
+    u32 coverage = uv__ttf_u16(font, sub + 4);
+    // format 0 and horizontal
+    if ((coverage >> 8) != 0 || !(coverage & 1)) return 0.f;
+
+    u32 want = left << 16 | right;
+    u32 lo = 0, hi = uv__ttf_u16(font, sub + 6);
+    while (lo < hi) {
+        u32 mid = (lo + hi) / 2;
+        u32 pair = sub + 14 + mid * 6;
+        u32 key = uv__ttf_u32(font, pair);
+        if (key < want)      lo = mid + 1;
+        else if (key > want) hi = mid;
+        else return (float)uv__ttf_i16(font, pair + 4) * font->scale;
+    }
+    return 0.f;
+}
+
+// start of the glyph in the glyf table, 0 when it doesn't have an outline
+static u32 uv__ttf_glyph_offset(const uv__font_t *font, u32 id) {
+    if (id >= font->glyph_count) return 0;
+    u32 start, end;
+    if (font->long_loca) {
+        start = uv__ttf_u32(font, font->loca + id * 4);
+        end = uv__ttf_u32(font, font->loca + id * 4 + 4);
+    }
+    else {
+        start = uv__ttf_u16(font, font->loca + id * 2) * 2;
+        end = uv__ttf_u16(font, font->loca + id * 2 + 2) * 2;
+    }
+    return end > start ? font->glyf + start : 0;
+}
+
+// metrics of the glyph, its bitmap covers the bounding box of the glyf header
+static u32 uv__font_glyph(uv__font_t *font, u32 id) {
+    if (id >= font->glyph_count) id = 0;
+    if (font->glyph_map[id]) return font->glyph_map[id] - 1;
+
+    uv__glyph_t glyph = {
+        .advance = uv__ttf_advance(font, id),
+        .cell = UV_GLYPH_NONE,
+        .id = (u16)id,
+    };
+
+    u32 g = uv__ttf_glyph_offset(font, id);
+    if (g) {
+        // y goes down on screen
+        float s = font->scale;
+        int x0 = (int)floorf((float)uv__ttf_i16(font, g + 2) * s);
+        int y0 = (int)floorf((float)-uv__ttf_i16(font, g + 8) * s);
+        int x1 = (int)ceilf((float)uv__ttf_i16(font, g + 6) * s);
+        int y1 = (int)ceilf((float)-uv__ttf_i16(font, g + 4) * s);
+        if (x1 > x0 && y1 > y0) {
+            glyph = (uv__glyph_t){
+                .width = (u32)(x1 - x0),
+                .height = (u32)(y1 - y0),
+                .x = x0,
+                .y = y0,
+                .advance = glyph.advance,
+                .cell = UV_GLYPH_NONE,
+                .id = (u16)id,
+            };
+        }
+    }
+
+    vecpush(font->glyphs, glyph);
+    font->glyph_map[id] = veclen(font->glyphs);
+    return veclen(font->glyphs) - 1;
+}
+
+// the points of a simple glyph are added to the outline as they are, in font units
+static bool uv__outline_simple(const uv__font_t *font, uv__outline_t *out, u32 g, u32 contours) {
+    enum { X_SHORT = 2, Y_SHORT = 4, REPEAT = 8, X_SAME = 16, Y_SAME = 32 };
+
+    u32 ends = g + 10;
+    u32 point_count = uv__ttf_u16(font, ends + (contours - 1) * 2) + 1;
+    u32 flags_at = ends + contours * 2 + 2 + uv__ttf_u16(font, ends + contours * 2);
+
+    u32 base = veclen(out->points);
+    if (base + point_count > UV_GLYPH_MAX_POINTS) return false;
+    u8 *flags = vecadd(out->flags, point_count);
+    vec2 *points = vecadd(out->points, point_count);
+
+    // the flags are expanded first, the coordinates come after all of them
+    u32 at = flags_at;
+    for (u32 i = 0; i < point_count;) {
+        u8 flag = (u8)uv__ttf_u8(font, at++);
+        u32 repeat = flag & REPEAT ? uv__ttf_u8(font, at++) : 0;
+        for (u32 k = 0; k <= repeat && i < point_count; ++k) {
+            flags[i++] = flag;
+        }
+    }
+
+    int x = 0;
+    for (u32 i = 0; i < point_count; ++i) {
+        u8 flag = flags[i];
+        if (flag & X_SHORT) {
+            int dx = (int)uv__ttf_u8(font, at++);
+            x += flag & X_SAME ? dx : -dx;
+        }
+        else if (!(flag & X_SAME)) {
+            x += uv__ttf_i16(font, at);
+            at += 2;
+        }
+        points[i].x = (float)x;
+    }
+
+    int y = 0;
+    for (u32 i = 0; i < point_count; ++i) {
+        u8 flag = flags[i];
+        if (flag & Y_SHORT) {
+            int dy = (int)uv__ttf_u8(font, at++);
+            y += flag & Y_SAME ? dy : -dy;
+        }
+        else if (!(flag & Y_SAME)) {
+            y += uv__ttf_i16(font, at);
+            at += 2;
+        }
+        points[i].y = (float)y;
+    }
+
+    // contours that go backwards or past the points are dropped with the ones after them,
+    // so the contours of the outline always follow each other
+    u32 first = 0;
+    for (u32 c = 0; c < contours; ++c) {
+        u32 last = uv__ttf_u16(font, ends + c * 2);
+        if (last >= point_count || last < first) break;
+        vecpush(out->ends, base + last);
+        first = last + 1;
+    }
+    uv__veclen(out->points) = uv__veclen(out->flags) = base + first;
+    return true;
+}
+
+static bool uv__outline_glyph(const uv__font_t *font, uv__outline_t *out, u32 id, u32 depth);
+
+// every component is another glyph, its points are transformed and then moved either by an
+// offset or so that one of them lands on a point of the components before it
+static bool uv__outline_compound(const uv__font_t *font, uv__outline_t *out, u32 g, u32 depth) {
+    enum { WORDS = 1, XY_VALUES = 2, SCALE = 8, MORE = 32, XY_SCALE = 64, TWO_BY_TWO = 128 };
+
+    u32 base = veclen(out->points);
+    u32 at = g + 10;
+    u32 flags;
+    do {
+        flags = uv__ttf_u16(font, at);
+        u32 id = uv__ttf_u16(font, at + 2);
+        at += 4;
+        if (++out->components > UV_GLYPH_MAX_COMPONENTS) return false;
+
+        // offsets are signed, point numbers aren't
+        u32 arg1, arg2;
+        float e = 0.f, f = 0.f;
+        if (flags & WORDS) {
+            arg1 = uv__ttf_u16(font, at);
+            arg2 = uv__ttf_u16(font, at + 2);
+            e = (float)(int16_t)arg1;
+            f = (float)(int16_t)arg2;
+            at += 4;
+        }
+        else {
+            arg1 = uv__ttf_u8(font, at);
+            arg2 = uv__ttf_u8(font, at + 1);
+            e = (float)(int8_t)arg1;
+            f = (float)(int8_t)arg2;
+            at += 2;
+        }
+
+        // 2.14 fixed point
+        float a = 1.f, b = 0.f, c = 0.f, d = 1.f;
+        if (flags & SCALE) {
+            a = d = (float)uv__ttf_i16(font, at) / 16384.f;
+            at += 2;
+        }
+        else if (flags & XY_SCALE) {
+            a = (float)uv__ttf_i16(font, at) / 16384.f;
+            d = (float)uv__ttf_i16(font, at + 2) / 16384.f;
+            at += 4;
+        }
+        else if (flags & TWO_BY_TWO) {
+            a = (float)uv__ttf_i16(font, at) / 16384.f;
+            b = (float)uv__ttf_i16(font, at + 2) / 16384.f;
+            c = (float)uv__ttf_i16(font, at + 4) / 16384.f;
+            d = (float)uv__ttf_i16(font, at + 6) / 16384.f;
+            at += 8;
+        }
+
+        u32 from = veclen(out->points);
+        if (!uv__outline_glyph(font, out, id, depth + 1)) return false;
+        u32 count = veclen(out->points) - from;
+
+        // x' = a*x + c*y, y' = b*x + d*y
+        vec2 *points = out->points + from;
+        for (u32 i = 0; i < count; ++i) {
+            vec2 p = points[i];
+            points[i] = v2(a * p.x + c * p.y, b * p.x + d * p.y);
+        }
+
+        if (!(flags & XY_VALUES)) {
+            // arg1 is a point of the components before, arg2 one of this component
+            if (arg1 >= from - base || arg2 >= count) return false;
+            vec2 target = out->points[base + arg1];
+            e = target.x - points[arg2].x;
+            f = target.y - points[arg2].y;
+        }
+
+        for (u32 i = 0; i < count; ++i) {
+            points[i].x += e;
+            points[i].y += f;
+        }
+    } while (flags & MORE);
+
+    return true;
+}
+
+// adds the contours of the glyph to the outline, false if the glyph is broken
+static bool uv__outline_glyph(const uv__font_t *font, uv__outline_t *out, u32 id, u32 depth) {
+    u32 g = uv__ttf_glyph_offset(font, id);
+    if (!g) return true;
+    // compound glyphs can't go on forever in a broken font
+    if (depth > 8) return false;
+
+    int contours = uv__ttf_i16(font, g);
+    if (contours > 0) {
+        return uv__outline_simple(font, out, g, (u32)contours);
+    }
+    else if (contours < 0) {
+        return uv__outline_compound(font, out, g, depth);
+    }
+    return true;
+}
+
+// -- rasterizing --
+
+typedef struct {
+    // coverage accumulated as signed areas, a row is width + 2 wide
+    float *acc;
+    u32 width, height;
+    // from font units to the bitmap: x' = m[0]*x + m[1]*y + m[2], y' = m[3]*x + m[4]*y + m[5]
+    float m[6];
+} uv__raster_t;
+
+// adds the area on the right of the line to every pixel it crosses, the running sum of a row
+// is then the winding of each pixel
+static void uv__raster_line(uv__raster_t *r, vec2 p0, vec2 p1) {
+    float w = (float)r->width, h = (float)r->height;
+    p0.x = p0.x > 0.f ? (p0.x < w ? p0.x : w) : 0.f;
+    p1.x = p1.x > 0.f ? (p1.x < w ? p1.x : w) : 0.f;
+    if (p0.y == p1.y) return;
+
+    float dir = 1.f;
+    if (p0.y > p1.y) {
+        vec2 tmp = p0;
+        p0 = p1;
+        p1 = tmp;
+        dir = -1.f;
+    }
+
+    float dxdy = (p1.x - p0.x) / (p1.y - p0.y);
+    float x = p0.x;
+    if (p0.y < 0.f) {
+        x -= p0.y * dxdy;
+    }
+
+    u32 stride = r->width + 2;
+    int y_end = (int)ceilf(p1.y < h ? p1.y : h);
+    for (int y = p0.y > 0.f ? (int)p0.y : 0; y < y_end; ++y) {
+        float *row = r->acc + (u32)y * stride;
+        float top = (float)y > p0.y ? (float)y : p0.y;
+        float bottom = (float)(y + 1) < p1.y ? (float)(y + 1) : p1.y;
+        float dy = bottom - top;
+        float x_next = x + dxdy * dy;
+        float d = dy * dir;
+
+        float xa = x < x_next ? x : x_next;
+        float xb = x < x_next ? x_next : x;
+        float xa_floor = floorf(xa);
+        int xai = (int)xa_floor;
+        float xb_ceil = ceilf(xb);
+        int xbi = (int)xb_ceil;
+
+        if (xbi <= xai + 1) {
+            // inside of one pixel: split by the middle of the span
+            float xm = 0.5f * (x + x_next) - xa_floor;
+            row[xai] += d - d * xm;
+            row[xai + 1] += d * xm;
+        }
+        else {
+            float s = 1.f / (xb - xa);
+            float xaf = xa - xa_floor;
+            float a0 = 0.5f * s * (1.f - xaf) * (1.f - xaf);
+            float xbf = xb - xb_ceil + 1.f;
+            float am = 0.5f * s * xbf * xbf;
+            row[xai] += d * a0;
+            if (xbi == xai + 2) {
+                row[xai + 1] += d * (1.f - a0 - am);
+            }
+            else {
+                float a1 = s * (1.5f - xaf);
+                row[xai + 1] += d * (a1 - a0);
+                for (int xi = xai + 2; xi < xbi - 1; ++xi) {
+                    row[xi] += d * s;
+                }
+                float a2 = a1 + (float)(xbi - xai - 3) * s;
+                row[xbi - 1] += d * (1.f - a2 - am);
+            }
+            row[xbi] += d * am;
+        }
+
+        x = x_next;
+    }
+}
+
+static inline vec2 uv__raster_point(const uv__raster_t *r, float x, float y) {
+    return v2(r->m[0] * x + r->m[1] * y + r->m[2], r->m[3] * x + r->m[4] * y + r->m[5]);
+}
+
+static void uv__raster_quad(uv__raster_t *r, vec2 p0, vec2 p1, vec2 p2) {
+    // a quadratic is at most |p0 - 2 p1 + p2| / (4 n^2) from n segments
+    float dx = p0.x - 2.f * p1.x + p2.x;
+    float dy = p0.y - 2.f * p1.y + p2.y;
+    float dd = sqrtf(dx * dx + dy * dy);
+    u32 n = (u32)ceilf(sqrtf(dd / (4.f * UV_GLYPH_TOLERANCE)));
+    n = n < 1 ? 1 : (n > 64 ? 64 : n);
+
+    vec2 prev = p0;
+    for (u32 i = 1; i <= n; ++i) {
+        float t = (float)i / (float)n;
+        float mt = 1.f - t;
+        vec2 p = v2(
+            mt * mt * p0.x + 2.f * mt * t * p1.x + t * t * p2.x,
+            mt * mt * p0.y + 2.f * mt * t * p1.y + t * t * p2.y
+        );
+        uv__raster_line(r, prev, p);
+        prev = p;
+    }
+}
+
+// the outline is moved to the bitmap in place, then every contour is flattened
+static void uv__raster_outline(uv__raster_t *r, const uv__outline_t *out) {
+    enum { ON_CURVE = 1 };
+
+    const u8 *flags = out->flags;
+    vec2 *points = out->points;
+    for (u32 i = 0; i < veclen(out->points); ++i) {
+        points[i] = uv__raster_point(r, points[i].x, points[i].y);
+    }
+
+    u32 first = 0;
+    for (u32 c = 0; c < veclen(out->ends); ++c) {
+        u32 last = out->ends[c];
+
+        // start on a point on the curve, or between two control points
+        vec2 start;
+        u32 from = first, count = last - first + 1;
+        if (flags[first] & ON_CURVE) {
+            start = points[first];
+            from = first + 1;
+            count--;
+        }
+        else if (flags[last] & ON_CURVE) {
+            start = points[last];
+            count--;
+        }
+        else {
+            start = v2((points[first].x + points[last].x) * 0.5f, (points[first].y + points[last].y) * 0.5f);
+        }
+
+        vec2 cur = start, ctrl = start;
+        bool has_ctrl = false;
+        for (u32 k = 0; k < count; ++k) {
+            u32 i = from + k;
+            vec2 p = points[i];
+            if (flags[i] & ON_CURVE) {
+                if (has_ctrl) uv__raster_quad(r, cur, ctrl, p);
+                else          uv__raster_line(r, cur, p);
+                cur = p;
+                has_ctrl = false;
+            }
+            else {
+                if (has_ctrl) {
+                    vec2 mid = v2((ctrl.x + p.x) * 0.5f, (ctrl.y + p.y) * 0.5f);
+                    uv__raster_quad(r, cur, ctrl, mid);
+                    cur = mid;
+                }
+                ctrl = p;
+                has_ctrl = true;
+            }
+        }
+        if (has_ctrl) uv__raster_quad(r, cur, ctrl, start);
+        else          uv__raster_line(r, cur, start);
+
+        first = last + 1;
+    }
+}
+
+// -- glyph atlas --
+
+static uv__glyph_atlas_t *uv__glyph_atlas(uv_context_t *ctx) {
+    if (ctx->glyph_atlas) return ctx->glyph_atlas;
+
+    u32 size = ctx->options.glyph_atlas_size ? ctx->options.glyph_atlas_size : UV_GLYPH_ATLAS_SIZE;
+    image_t blank = {
+        .data = UV_CALLOC(1, sizeof(u32) * size * size, allocator_udata),
+        .width = size,
+        .height = size,
+    };
+    if (!blank.data) return NULL;
+
+    texture_t handle = uv__backend_load_texture(ctx->gfx_data, &blank);
+    UV_FREE(blank.data, allocator_udata);
+    if (!handle) return NULL;
+
+    uv__glyph_atlas_t *atlas = UV_CALLOC(1, sizeof(uv__glyph_atlas_t), allocator_udata);
+    UV_ASSERT(atlas);
+    atlas->handle = handle;
+    atlas->size = size;
+    for (u32 i = 0; i < UV_GLYPH_CLASSES; ++i) {
+        atlas->classes[i] = (uv__glyph_class_t){
+            .shelf_x = size,
+            .head = UV_GLYPH_NONE,
+            .tail = UV_GLYPH_NONE,
+            .free = UV_GLYPH_NONE,
+        };
+    }
+    ctx->glyph_atlas = atlas;
+    return atlas;
+}
+
+static void uv__glyph_atlas_free(uv_context_t *ctx) {
+    uv__glyph_atlas_t *atlas = ctx->glyph_atlas;
+    if (!atlas) return;
+    uv__backend_free_texture(ctx->gfx_data, atlas->handle);
+    vecfree(atlas->cells);
+    vecfree(atlas->outline.points);
+    vecfree(atlas->outline.flags);
+    vecfree(atlas->outline.ends);
+    vecfree(atlas->coverage);
+    vecfree(atlas->pixels);
+    UV_FREE(atlas, allocator_udata);
+    ctx->glyph_atlas = NULL;
+}
+
+static void uv__glyph_lru_unlink(uv__glyph_atlas_t *atlas, u32 c) {
+    uv__glyph_cell_t *cell = &atlas->cells[c];
+    uv__glyph_class_t *cls = &atlas->classes[cell->size_class];
+    if (cell->prev != UV_GLYPH_NONE) atlas->cells[cell->prev].next = cell->next;
+    else                             cls->head = cell->next;
+    if (cell->next != UV_GLYPH_NONE) atlas->cells[cell->next].prev = cell->prev;
+    else                             cls->tail = cell->prev;
+}
+
+static void uv__glyph_lru_push(uv__glyph_atlas_t *atlas, u32 c) {
+    uv__glyph_cell_t *cell = &atlas->cells[c];
+    uv__glyph_class_t *cls = &atlas->classes[cell->size_class];
+    cell->prev = UV_GLYPH_NONE;
+    cell->next = cls->head;
+    if (cls->head != UV_GLYPH_NONE) atlas->cells[cls->head].prev = c;
+    else                            cls->tail = c;
+    cls->head = c;
+}
+
+// a free cell, a new one, or the one of the least recently used glyph. glyphs drawn in this
+// frame are never evicted, their uvs are already in the draw list
+static u32 uv__glyph_cell_alloc(uv_context_t *ctx, uv__glyph_atlas_t *atlas, u32 k) {
+    uv__glyph_class_t *cls = &atlas->classes[k];
+    u32 side = uv__glyph_cell_sizes[k];
+
+    if (cls->free != UV_GLYPH_NONE) {
+        u32 c = cls->free;
+        cls->free = atlas->cells[c].next;
+        return c;
+    }
+
+    if (cls->shelf_x + side > atlas->size && atlas->top + side <= atlas->size) {
+        cls->shelf_x = 0;
+        cls->shelf_y = atlas->top;
+        atlas->top += side;
+    }
+
+    if (cls->shelf_x + side <= atlas->size) {
+        vecpush(atlas->cells, (uv__glyph_cell_t){ .x = cls->shelf_x, .y = cls->shelf_y, .size_class = k });
+        cls->shelf_x += side;
+        return veclen(atlas->cells) - 1;
+    }
+
+    u32 c = cls->tail;
+    if (c == UV_GLYPH_NONE || atlas->cells[c].frame == ctx->frame_count) {
+        return UV_GLYPH_NONE;
+    }
+
+    uv__glyph_cell_t *cell = &atlas->cells[c];
+    uv__glyph_lru_unlink(atlas, c);
+    cell->font->glyphs[cell->glyph].cell = UV_GLYPH_NONE;
+    cell->font = NULL;
+    return c;
+}
+
+// rasterizes the glyph in its cell, with the cell cleared around it
+static void uv__glyph_upload(uv_context_t *ctx, uv__glyph_atlas_t *atlas, const uv__font_t *font, const uv__glyph_t *glyph, const uv__glyph_cell_t *cell) {
+    u32 side = uv__glyph_cell_sizes[cell->size_class];
+    u32 stride = glyph->width + 2;
+
+    vecclear(atlas->coverage);
+    float *acc = vecadd(atlas->coverage, stride * glyph->height);
+    for (u32 i = 0; i < stride * glyph->height; ++i) acc[i] = 0.f;
+
+    uv__raster_t r = {
+        .acc = acc,
+        .width = glyph->width,
+        .height = glyph->height,
+        .m = { font->scale, 0.f, (float)-glyph->x, 0.f, -font->scale, (float)-glyph->y },
+    };
+    uv__outline_t *outline = &atlas->outline;
+    vecclear(outline->points);
+    vecclear(outline->flags);
+    vecclear(outline->ends);
+    outline->components = 0;
+    // a broken glyph is left empty
+    if (uv__outline_glyph(font, outline, glyph->id, 0)) {
+        uv__raster_outline(&r, outline);
+    }
+
+    vecclear(atlas->pixels);
+    u8 *pixels = vecadd(atlas->pixels, side * side * 4);
+    for (u32 i = 0; i < side * side; ++i) {
+        pixels[i * 4 + 0] = pixels[i * 4 + 1] = pixels[i * 4 + 2] = 255;
+        pixels[i * 4 + 3] = 0;
+    }
+
+    for (u32 y = 0; y < glyph->height; ++y) {
+        const float *row = acc + y * stride;
+        u8 *out = pixels + ((y + UV_GLYPH_PADDING) * side + UV_GLYPH_PADDING) * 4;
+        float sum = 0.f;
+        for (u32 x = 0; x < glyph->width; ++x) {
+            sum += row[x];
+            float a = fabsf(sum);
+            out[x * 4 + 3] = (u8)((a < 1.f ? a : 1.f) * 255.f + 0.5f);
+        }
+    }
+
+    image_t img = { .data = pixels, .width = side, .height = side };
+    uv__backend_update_texture(ctx->gfx_data, atlas->handle, &img, cell->x, cell->y);
+    // the texture changed under the frames that used the cell before
+    ctx->frame_epoch++;
+}
+
+// the glyph's cell in the atlas, rasterized if it isn't there. UV_GLYPH_NONE if it doesn't fit
+static u32 uv__glyph_cell(uv_context_t *ctx, uv__glyph_atlas_t *atlas, uv__font_t *font, u32 index) {
+    uv__glyph_t *glyph = &font->glyphs[index];
+    u32 c = glyph->cell;
+
+    if (c != UV_GLYPH_NONE) {
+        uv__glyph_cell_t *cell = &atlas->cells[c];
+        // moved to the front once per frame
+        if (cell->frame != ctx->frame_count) {
+            cell->frame = ctx->frame_count;
+            uv__glyph_lru_unlink(atlas, c);
+            uv__glyph_lru_push(atlas, c);
+        }
+        return c;
+    }
+
+    u32 need = (glyph->width > glyph->height ? glyph->width : glyph->height) + UV_GLYPH_PADDING * 2;
+    u32 k = 0;
+    while (k < UV_GLYPH_CLASSES && uv__glyph_cell_sizes[k] < need) ++k;
+    if (k == UV_GLYPH_CLASSES) return UV_GLYPH_NONE;
+
+    c = uv__glyph_cell_alloc(ctx, atlas, k);
+    if (c == UV_GLYPH_NONE) return UV_GLYPH_NONE;
+
+    uv__glyph_cell_t *cell = &atlas->cells[c];
+    cell->font = font;
+    cell->glyph = index;
+    cell->frame = ctx->frame_count;
+    uv__glyph_lru_push(atlas, c);
+    glyph->cell = c;
+
+    uv__glyph_upload(ctx, atlas, font, glyph, cell);
+    return c;
+}
+
+// -- layout --
+
+static u32 uv__utf8_next(const char **text) {
+    const u8 *s = (const u8 *)*text;
+    u32 cp = s[0];
+    u32 len = cp < 0x80 ? 1 : (cp & 0xe0) == 0xc0 ? 2 : (cp & 0xf0) == 0xe0 ? 3 : (cp & 0xf8) == 0xf0 ? 4 : 0;
+    if (!len) {
+        *text += 1;
+        return 0xfffd;
+    }
+
+    if (len > 1) {
+        cp &= 0x7f >> len;
+        for (u32 i = 1; i < len; ++i) {
+            if ((s[i] & 0xc0) != 0x80) {
+                *text += i;
+                return 0xfffd;
+            }
+            cp = cp << 6 | (s[i] & 0x3f);
+        }
+    }
+    *text += len;
+    return cp;
+}
+
+// the layout of text, from the cache when the same string was drawn with the font before
+static const uv__text_run_t *uv__text_run(uv__font_t *font, const char *text) {
+    u32 len = (u32)strlen(text);
+    u64 hash = uv__hash(UV_HASH_SEED, text, len);
+
+    if (!font->runs) {
+        font->runs = UV_CALLOC(UV_TEXT_RUNS, sizeof(uv__text_run_t), allocator_udata);
+        UV_ASSERT(font->runs);
+    }
+
+    uv__text_run_t *run = &font->runs[hash & (UV_TEXT_RUNS - 1)];
+    if (run->hash == hash && veclen(run->text) == len && memcmp(run->text, text, len) == 0) {
+        return run;
+    }
+
+    // a different string in the same slot is replaced
+    run->hash = hash;
+    vecclear(run->text);
+    UV_MEMCPY(vecadd(run->text, len), text, len);
+    vecclear(run->glyphs);
+
+    vec2 pen = v2(0.f, font->ascent);
+    float width = 0.f;
+    u32 prev = 0;
+    const char *end = text + len;
+    while (text < end) {
+        u32 cp = uv__utf8_next(&text);
+        if (cp == '\n') {
+            pen = v2(0.f, pen.y + font->line_height);
+            prev = 0;
+            continue;
+        }
+
+        u32 id = uv__ttf_glyph_id(font, cp);
+        if (prev) pen.x += uv__ttf_kern(font, prev, id);
+        u32 index = uv__font_glyph(font, id);
+        const uv__glyph_t *glyph = &font->glyphs[index];
+        if (glyph->width) {
+            vecpush(run->glyphs, (uv__run_glyph_t){ index, pen });
+        }
+        pen.x += glyph->advance;
+        width = pen.x > width ? pen.x : width;
+        prev = id;
+    }
+
+    run->size = v2(width, pen.y - font->ascent + font->line_height);
+    return run;
+}
+
+// -- fonts --
+
+font_t uvCtxLoadFont(uv_context_t *ctx, const char *filename, float pixel_size) {
+    FILE *fp = fopen(filename, "rb");
+    if (!fp) return 0;
+
+    font_t font = 0;
+    u8 *data = NULL;
+    if (fseek(fp, 0, SEEK_END) == 0) {
+        long len = ftell(fp);
+        if (len > 0 && fseek(fp, 0, SEEK_SET) == 0) {
+            data = UV_REALLOC(NULL, (usize)len, allocator_udata);
+            if (data && fread(data, 1, (usize)len, fp) == (usize)len) {
+                font = uvCtxLoadFontFromMemory(ctx, data, (usize)len, pixel_size);
+            }
+        }
+    }
+
+    fclose(fp);
+    UV_FREE(data, allocator_udata);
+    return font;
+}
+
+font_t uvCtxLoadFontFromMemory(uv_context_t *ctx, const u8 *buffer, size_t buflen, float pixel_size) {
+    if (!buffer || buflen < 12 || buflen > UINT32_MAX || pixel_size <= 0.f) return 0;
+
+    uv__font_t *font = UV_CALLOC(1, sizeof(uv__font_t), allocator_udata);
+    if (!font) return 0;
+
+    font->ctx = ctx;
+    font->size = (u32)buflen;
+    font->data = UV_REALLOC(NULL, buflen, allocator_udata);
+    if (font->data) {
+        UV_MEMCPY(font->data, buffer, buflen);
+        if (uv__font_parse(font, pixel_size)) {
+            font->glyph_map = UV_CALLOC(font->glyph_count, sizeof(u32), allocator_udata);
+        }
+    }
+
+    if (!font->glyph_map) {
+        UV_FREE(font->data, allocator_udata);
+        UV_FREE(font, allocator_udata);
+        return 0;
+    }
+    return (font_t)font;
+}
+
+void uvCtxFreeFont(uv_context_t *ctx, font_t font_handle) {
+    uv__font_t *font = (uv__font_t *)font_handle;
+    if (!font) return;
+
+    // its cells can be taken by any other glyph
+    uv__glyph_atlas_t *atlas = ctx->glyph_atlas;
+    for (u32 i = 0; atlas && i < veclen(font->glyphs); ++i) {
+        u32 c = font->glyphs[i].cell;
+        if (c == UV_GLYPH_NONE) continue;
+        uv__glyph_cell_t *cell = &atlas->cells[c];
+        uv__glyph_lru_unlink(atlas, c);
+        cell->font = NULL;
+        cell->next = atlas->classes[cell->size_class].free;
+        atlas->classes[cell->size_class].free = c;
+    }
+
+    if (font->runs) {
+        for (u32 i = 0; i < UV_TEXT_RUNS; ++i) {
+            vecfree(font->runs[i].text);
+            vecfree(font->runs[i].glyphs);
+        }
+        UV_FREE(font->runs, allocator_udata);
+    }
+    vecfree(font->glyphs);
+    UV_FREE(font->glyph_map, allocator_udata);
+    UV_FREE(font->data, allocator_udata);
+    UV_FREE(font, allocator_udata);
+}
+
+vec2 uvMeasureText(font_t font, const char *text) {
+    if (!font || !text) return v2(0, 0);
+    return uv__text_run((uv__font_t *)font, text)->size;
+}
+
+void uvCtxDrawText(uv_context_t *ctx, font_t font_handle, const char *text, vec2 position, colour_t colour) {
+    uv__font_t *font = (uv__font_t *)font_handle;
+    if (!font || !text || !*text) return;
+    // the glyph atlas and the layout cache belong to the context, fragments run on other threads.
+    // release builds skip the text
+    UV_ASSERT(!ctx->parent && "fragments can't draw text");
+    if (ctx->parent) return;
+    UV_ASSERT(font->ctx == ctx && "fonts are drawn with the context that loaded them");
+
+    const uv__text_run_t *run = uv__text_run(font, text);
+    u32 count = veclen(run->glyphs);
+    if (!count) return;
+    if (uv__culling(ctx) && uv__culled(ctx, position.x, position.y, position.x + run->size.x, position.y + run->size.y)) return;
+
+    uv__glyph_atlas_t *atlas = uv__glyph_atlas(ctx);
+    if (!atlas) return;
+
+    // on whole pixels the glyphs are sampled one to one
+    if (!ctx->transformed) {
+        position = v2(floorf(position.x + 0.5f), floorf(position.y + 0.5f));
+    }
+
+    // the string is drawn from the glyph atlas, then the texture in use is back
+    texture_t prev_texture = uv__get_texture(ctx);
+    vec4 prev_uv = ctx->cur_uv;
+    uv__set_texture(ctx, atlas->handle, v4(0, 0, 1, 1));
+
+    vec4 clip_rect;
+    bool clip = uv__clip_local(ctx, &clip_rect);
+
+    uv__chunk_t *chunk = uv__drawlist_reserve(ctx, count * 4, count * 6);
+    uv_vertex_t *vtx = chunk->data.vertices + chunk->data.vtx_count;
+    uv__colour_t col = uv__pack_colour(colour);
+    float texel = 1.f / (float)atlas->size;
+    u32 written = 0;
+
+    for (u32 i = 0; i < count; ++i) {
+        const uv__run_glyph_t *rg = &run->glyphs[i];
+        u32 c = uv__glyph_cell(ctx, atlas, font, rg->glyph);
+        if (c == UV_GLYPH_NONE) continue;
+
+        const uv__glyph_t *glyph = &font->glyphs[rg->glyph];
+        const uv__glyph_cell_t *cell = &atlas->cells[c];
+        float u = (float)(cell->x + UV_GLYPH_PADDING) * texel;
+        float v = (float)(cell->y + UV_GLYPH_PADDING) * texel;
+
+        vec2 pos = v2(
+            position.x + floorf(rg->pen.x + 0.5f) + (float)glyph->x,
+            position.y + floorf(rg->pen.y + 0.5f) + (float)glyph->y
+        );
+        vec2 size = v2((float)glyph->width, (float)glyph->height);
+        vec4 uv = v4(u, v, u + size.x * texel, v + size.y * texel);
+        if (clip) {
+            uv__clip_rect(clip_rect, &pos, &size, &uv);
+            if (size.x <= 0.f || size.y <= 0.f) continue;
+        }
+
+        uv_vertex_t *out = vtx + written * 4;
+        out[0] = uv__vertex(ctx, pos, v2(uv.x, uv.y), col);
+        out[1] = uv__vertex(ctx, v2(pos.x, pos.y + size.y), v2(uv.x, uv.w), col);
+        out[2] = uv__vertex(ctx, v2(pos.x + size.x, pos.y), v2(uv.z, uv.y), col);
+        out[3] = uv__vertex(ctx, v2(pos.x + size.x, pos.y + size.y), v2(uv.z, uv.w), col);
+        written++;
+    }
+
+    uv__commit_quads(ctx, chunk, written);
+    uv__set_texture(ctx, prev_texture, prev_uv);
+}
+
+// == default context =================================
+// the uvXxx functions are the same as uvCtxXxx on a context that always exists
+
+uv_context_t *uvCreateContext(void) {
+    uv_context_t *ctx = UV_CALLOC(1, sizeof(uv_context_t), allocator_udata);
+    if (ctx) {
+        *ctx = (uv_context_t)UV_CONTEXT_INIT;
+    }
+    return ctx;
+}
+
+void uvDestroyContext(uv_context_t *ctx) {
+    if (!ctx) {
+        return;
+    }
+    uvCtxCleanup(ctx);
+    if (ctx != &default_context) {
+        UV_FREE(ctx, allocator_udata);
+    }
+}
+
+uv_context_t *uvGetDefaultContext(void) {
+    return &default_context;
+}
+
+uv_context_t *uvCreateFragment(void) {
+    return uvCtxCreateFragment(&default_context);
+}
+
+void *uv__context_gfx(uv_context_t *ctx) {
+    return ctx->gfx_data;
+}
+
+void uvCreateWindow(const char *name, int width, int height, const uv_options_t *opts) {
+    uvCtxCreateWindow(&default_context, name, width, height, opts);
+}
+
+void uvCloseWindow(void) {
+    uvCtxCloseWindow(&default_context);
+}
+
+void uvOnWindowResize(int new_width, int new_height) {
+    uvCtxOnWindowResize(&default_context, new_width, new_height);
+}
+
+void uvCleanup(void) {
+    uvCtxCleanup(&default_context);
+}
+
+bool uvIsOpen(void) {
+    return uvCtxIsOpen(&default_context);
+}
+
+vec2i uvGetWindowSize(void) {
+    return uvCtxGetWindowSize(&default_context);
+}
+
+float uvGetDeltaTime(void) {
+    return uvCtxGetDeltaTime(&default_context);
+}
+
+void uvSetClearColour(colour_t colour) {
+    uvCtxSetClearColour(&default_context, colour);
+}
+
+void uvEndFrame(void) {
+    uvCtxEndFrame(&default_context);
+}
+
+bool uvReadPixelsAsync(void) {
+    return uvCtxReadPixelsAsync(&default_context);
+}
+
+bool uvPollReadPixels(image_t *image) {
+    return uvCtxPollReadPixels(&default_context, image);
+}
+
+bool uvIsKeyDown(int key) {
+    return uvCtxIsKeyDown(&default_context, key);
+}
+
+bool uvIsKeyUp(int key) {
+    return uvCtxIsKeyUp(&default_context, key);
+}
+
+bool uvIsKeyPressed(int key) {
+    return uvCtxIsKeyPressed(&default_context, key);
+}
+
+bool uvIsMouseDown(int mouse) {
+    return uvCtxIsMouseDown(&default_context, mouse);
+}
+
+bool uvIsMouseUp(int mouse) {
+    return uvCtxIsMouseUp(&default_context, mouse);
+}
+
+vec2i uvGetMousePos(void) {
+    return uvCtxGetMousePos(&default_context);
+}
+
+vec2i uvGetMousePosRel(void) {
+    return uvCtxGetMousePosRel(&default_context);
+}
+
+float uvGetMouseWheel(void) {
+    return uvCtxGetMouseWheel(&default_context);
+}
+
+texture_t uvLoadTexture(const char *filename) {
+    return uvCtxLoadTexture(&default_context, filename);
+}
+
+texture_t uvLoadTextureFromImage(const image_t *img) {
+    return uvCtxLoadTextureFromImage(&default_context, img);
+}
+
+void uvFreeTexture(texture_t texture) {
+    uvCtxFreeTexture(&default_context, texture);
+}
+
+texture_t uvCreateRenderTexture(u32 width, u32 height) {
+    return uvCtxCreateRenderTexture(&default_context, width, height);
+}
+
+void uvBeginRenderTexture(texture_t target, colour_t clear_colour) {
+    uvCtxBeginRenderTexture(&default_context, target, clear_colour);
+}
+
+void uvEndRenderTexture(void) {
+    uvCtxEndRenderTexture(&default_context);
+}
+
+void uvSetKeyState(int key, bool state) {
+    uvCtxSetKeyState(&default_context, key, state);
+}
+
+void uvSetMouseState(int btn, bool state) {
+    uvCtxSetMouseState(&default_context, btn, state);
+}
+
+void uvSetMousePosition(vec2i position) {
+    uvCtxSetMousePosition(&default_context, position);
+}
+
+void uvSetTexture(texture_t texture) {
+    uvCtxSetTexture(&default_context, texture);
+}
+
+void uvClearTexture(void) {
+    uvCtxClearTexture(&default_context);
+}
+
+void uvSetLayer(u16 layer) {
+    uvCtxSetLayer(&default_context, layer);
+}
+
+u16 uvGetLayer(void) {
+    return uvCtxGetLayer(&default_context);
+}
+
+void uvSetCulling(bool enabled) {
+    uvCtxSetCulling(&default_context, enabled);
+}
+
+u32 uvGetCulledCount(void) {
+    return uvCtxGetCulledCount(&default_context);
+}
+
+void uvSetSdfShapes(bool enabled) {
+    uvCtxSetSdfShapes(&default_context, enabled);
+}
+
+void uvPushClipRect(vec2 position, vec2 size) {
+    uvCtxPushClipRect(&default_context, position, size);
+}
+
+void uvPopClipRect(void) {
+    uvCtxPopClipRect(&default_context);
+}
+
+void uvPushTransform(void) {
+    uvCtxPushTransform(&default_context);
+}
+
+void uvPopTransform(void) {
+    uvCtxPopTransform(&default_context);
+}
+
+void uvTranslate(vec2 offset) {
+    uvCtxTranslate(&default_context, offset);
+}
+
+void uvRotate(float angle) {
+    uvCtxRotate(&default_context, angle);
+}
+
+void uvScale(vec2 scale) {
+    uvCtxScale(&default_context, scale);
+}
+
+void uvDrawVertices(uv_vertex_t *vertices, u32 count) {
+    uvCtxDrawVertices(&default_context, vertices, count);
+}
+
+void uvDrawIndices(uv_vertex_t *vertices, u32 vtx_count, uv_index_t *indices, u32 idx_count) {
+    uvCtxDrawIndices(&default_context, vertices, vtx_count, indices, idx_count);
+}
+
+void uvDrawLine(vec2 start, vec2 end, float thickness, colour_t colour) {
+    uvCtxDrawLine(&default_context, start, end, thickness, colour);
+}
+
+void uvDrawLineBezier(vec2 start, vec2 end, float thickness, colour_t colour) {
+    uvCtxDrawLineBezier(&default_context, start, end, thickness, colour);
+}
+
+void uvDrawLineBezierQuad(vec2 start, vec2 end, vec2 control_point, float thickness, colour_t colour) {
+    uvCtxDrawLineBezierQuad(&default_context, start, end, control_point, thickness, colour);
+}
+
+void uvDrawLineBeziercubic(vec2 start, vec2 end, vec2 start_control, vec2 end_control, float thickness, colour_t colour) {
+    uvCtxDrawLineBeziercubic(&default_context, start, end, start_control, end_control, thickness, colour);
+}
+
+void uvDrawCircle(vec2 centre, float radius, colour_t colour) {
+    uvCtxDrawCircle(&default_context, centre, radius, colour);
+}
+
+void uvDrawCircleEx(vec2 centre, float radius, colour_t colour, uint segments) {
+    uvCtxDrawCircleEx(&default_context, centre, radius, colour, segments);
+}
+
+void uvDrawArc(vec2 centre, float radius, float start_angle, float end_angle, uint segments, colour_t colour) {
+    uvCtxDrawArc(&default_context, centre, radius, start_angle, end_angle, segments, colour);
+}
+
+void uvDrawArcLines(vec2 centre, float radius, float start_angle, float end_angle, uint segments, colour_t colour, float thickness) {
+    uvCtxDrawArcLines(&default_context, centre, radius, start_angle, end_angle, segments, colour, thickness);
+}
+
+void uvDrawRing(vec2 centre, float inner_radius, float outer_radius, float start_angle, float end_angle, uint segments, colour_t colour) {
+    uvCtxDrawRing(&default_context, centre, inner_radius, outer_radius, start_angle, end_angle, segments, colour);
+}
+
+void uvDrawQuad(vec2 pos, vec2 sz, colour_t colour) {
+    uvCtxDrawQuad(&default_context, pos, sz, colour);
+}
+
+void uvDrawQuadRot(vec2 position, vec2 size, colour_t colour, float rotation) {
+    uvCtxDrawQuadRot(&default_context, position, size, colour, rotation);
+}
+
+void uvDrawQuadLines(vec2 position, vec2 size, colour_t colour, float rotation, float thickness) {
+    uvCtxDrawQuadLines(&default_context, position, size, colour, rotation, thickness);
+}
+
+void uvDrawQuadRounded(vec2 position, vec2 size, colour_t colour, float rotation, float roundness, uint segments) {
+    uvCtxDrawQuadRounded(&default_context, position, size, colour, rotation, roundness, segments);
+}
+
+void uvDrawQuadRoundedLines(vec2 position, vec2 size, colour_t colour, float rotation, float roundness, uint segments, float thickness) {
+    uvCtxDrawQuadRoundedLines(&default_context, position, size, colour, rotation, roundness, segments, thickness);
+}
+
+void uvDrawTriangle(vec2 v1, vec2 v2, vec2 v3, colour_t colour) {
+    uvCtxDrawTriangle(&default_context, v1, v2, v3, colour);
+}
+
+void uvDrawTriangleLines(vec2 v1, vec2 v2, vec2 v3, colour_t colour, float thickness) {
+    uvCtxDrawTriangleLines(&default_context, v1, v2, v3, colour, thickness);
+}
+
+void uvDrawPolyline(const vec2 *points, u32 count, float thickness, colour_t colour, uv_line_join_e join, uv_line_cap_e cap) {
+    uvCtxDrawPolyline(&default_context, points, count, thickness, colour, join, cap);
+}
+
+void uvDrawQuads(const uv_quad_t *quads, u32 count) {
+    uvCtxDrawQuads(&default_context, quads, count);
+}
+
+void uvDrawLines(const uv_line_t *lines, u32 count) {
+    uvCtxDrawLines(&default_context, lines, count);
+}
+
+void uvDrawTriangles(const uv_triangle_t *triangles, u32 count) {
+    uvCtxDrawTriangles(&default_context, triangles, count);
+}
+
+void uvDrawSprites(const uv_sprite_t *sprites, u32 count) {
+    uvCtxDrawSprites(&default_context, sprites, count);
+}
+
+mesh_t uvCreateMesh(const vec2 *positions, const vec2 *uvs, const colour_t *colours, u32 vtx_count, const u32 *indices, u32 idx_count) {
+    return uvCtxCreateMesh(&default_context, positions, uvs, colours, vtx_count, indices, idx_count);
+}
+
+void uvFreeMesh(mesh_t mesh) {
+    uvCtxFreeMesh(&default_context, mesh);
+}
+
+void uvDrawMesh(mesh_t mesh, vec2 position, float rotation, vec2 scale, colour_t tint) {
+    uvCtxDrawMesh(&default_context, mesh, position, rotation, scale, tint);
+}
+
+font_t uvLoadFont(const char *filename, float pixel_size) {
+    return uvCtxLoadFont(&default_context, filename, pixel_size);
+}
+
+font_t uvLoadFontFromMemory(const u8 *buffer, size_t buflen, float pixel_size) {
+    return uvCtxLoadFontFromMemory(&default_context, buffer, buflen, pixel_size);
+}
+
+void uvFreeFont(font_t font) {
+    uvCtxFreeFont(&default_context, font);
+}
+
+void uvDrawText(font_t font, const char *text, vec2 position, colour_t colour) {
+    uvCtxDrawText(&default_context, font, text, position, colour);
 }
 
 // ====================================================================================
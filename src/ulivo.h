@@ -71,14 +71,97 @@ typedef struct { uint x, y, z, w; } vec4u;
 
 typedef vec4 colour_t;
 typedef uptr texture_t;
+typedef uptr mesh_t;
+typedef uptr font_t;
 
 typedef struct {
 	u8 *data;
 	u32 width, height;
 } image_t;
 
+// primitives for the bulk draw functions (uvDrawQuads, uvDrawLines, uvDrawTriangles)
 typedef struct {
-    int nothing;
+    vec2 position;
+    vec2 size;
+    colour_t colour;
+} uv_quad_t;
+
+typedef struct {
+    vec2 start, end;
+    float thickness;
+    colour_t colour;
+} uv_line_t;
+
+typedef struct {
+    vec2 v1, v2, v3;
+    colour_t colour;
+} uv_triangle_t;
+
+// sprites for uvDrawSprites, drawn with instancing when the backend supports it
+typedef struct {
+    // top left corner before the rotation
+    vec2 position;
+    vec2 size;
+    // radians, clockwise around the centre of the sprite
+    float rotation;
+    // part of the current texture, xy: top left, zw: bottom right. (0, 0, 1, 1) is all of it
+    vec4 uv;
+    colour_t colour;
+} uv_sprite_t;
+
+// how uvDrawPolyline connects its segments
+typedef enum {
+    // sharp corners, bevelled where the miter would be longer than 4 times the thickness
+    UV_LINE_JOIN_MITER,
+    UV_LINE_JOIN_BEVEL,
+    UV_LINE_JOIN_ROUND,
+} uv_line_join_e;
+
+// how uvDrawPolyline ends its first and last segment
+typedef enum {
+    UV_LINE_CAP_BUTT,
+    // extended by half the thickness
+    UV_LINE_CAP_SQUARE,
+    UV_LINE_CAP_ROUND,
+} uv_line_cap_e;
+
+typedef struct {
+    // never move or copy vertices and indices once they are emitted: when the draw list is
+    // full a bigger block is chained after it, and the next frame starts with a single block
+    // as big as all of them together
+    bool frame_arena;
+    // initial size of the draw list, 0 to grow on demand
+    u32 arena_vertices;
+    u32 arena_indices;
+    // pack small textures in shared pages, so drawing different sprites doesn't break the
+    // batch. textures in the atlas don't wrap, use uvGetTextureUV for their uv rectangle
+    bool texture_atlas;
+    // size of the atlas pages (default 2048) and of the biggest image that goes in them (default 256,
+    // never more than the page size minus the 1 pixel border around every image)
+    u32 atlas_page_size;
+    u32 atlas_max_size;
+    // sort the frame by layer and texture in uvEndFrame, to get as few batches as possible.
+    // only the order of the layers is kept: on the same layer primitives with different
+    // textures can be drawn in any order, use uvSetLayer where it matters
+    bool deferred;
+    // hash the draw list while it's emitted, when a frame is the same as the previous one
+    // the backend is told so, and can skip uploading or even drawing it again
+    bool skip_unchanged;
+    // how far, in pixels, circles, arcs and rounded corners can be from their segments when
+    // the number of segments is picked from their size (default 0.25)
+    float tess_tolerance;
+    // skip the primitives that are entirely outside of the window (and of the clip rect)
+    // before they are emitted, uvGetCulledCount says how many were. meshes and raw vertices
+    // are never culled
+    bool cull;
+    // circles, rings, arc outlines and rounded quads (filled or not) are a single instance each,
+    // with their signed distance evaluated and anti-aliased in the pixel stage, segments are
+    // ignored. only used when the backend has UV_CAP_SHAPES, partial arcs and transforms that
+    // aren't a rotation with a uniform scale are still tessellated
+    bool sdf_shapes;
+    // size of the texture with the glyphs of all the fonts (default 1024). once it's full the
+    // glyphs that weren't drawn for the longest time make room for new ones
+    u32 glyph_atlas_size;
 } uv_options_t;
 
 void uvCreateWindow(const char *name, int width, int height, const uv_options_t *options);
@@ -90,6 +173,13 @@ float uvGetDeltaTime(void);
 
 void uvSetClearColour(colour_t colour);
 void uvEndFrame(void);
+// asks for the pixels of the window as drawn by the next uvEndFrame that has anything to draw.
+// the copy doesn't wait for the frame to be done, uvPollReadPixels returns it once it's ready
+// (usually one or two frames later), in the order they were asked for. false if the backend
+// doesn't have UV_CAP_READBACK or UV_READBACK_SLOTS copies are already on their way
+bool uvReadPixelsAsync(void);
+// true if the oldest copy is ready, image is RGBA8 and valid until the next uvPollReadPixels
+bool uvPollReadPixels(image_t *image);
 
 bool uvIsKeyDown(int key);
 bool uvIsKeyUp(int key);
@@ -107,30 +197,202 @@ void uvFreeImage(image_t *image);
 texture_t uvLoadTexture(const char *filename);
 texture_t uvLoadTextureFromImage(const image_t *img);
 void uvFreeTexture(texture_t texture);
+vec2i uvGetTextureSize(texture_t texture);
+// uv rectangle of the texture in the texture it's drawn from, xy: top left, zw: bottom right.
+// it's always (0, 0, 1, 1) unless the texture is in the atlas
+vec4 uvGetTextureUV(texture_t texture);
+
+// render textures can be drawn into, then drawn with like any other texture and freed with
+// uvFreeTexture. 0 if the backend doesn't have UV_CAP_RENDER_TEXTURES.
+// everything drawn between uvBeginRenderTexture and uvEndRenderTexture goes to the texture
+// instead of the frame, starting without a clip rect or a transform and with (0, 0) at its top
+// left. it's drawn right away in uvEndRenderTexture, so it can be kept for as many frames as it
+// doesn't change. they can't be nested and a render texture can't be drawn into itself
+texture_t uvCreateRenderTexture(u32 width, u32 height);
+void uvBeginRenderTexture(texture_t target, colour_t clear_colour);
+void uvEndRenderTexture(void);
+
+// retained meshes are uploaded once and can be drawn any number of times per frame.
+// uvs and colours can be NULL (uv 0, 0 and white), without indices every 3 vertices are a triangle.
+// the positions are kept as they are, the transform is only applied when the mesh is drawn.
+// a mesh must not be freed before the uvEndFrame of the frames it's drawn in
+mesh_t uvCreateMesh(const vec2 *positions, const vec2 *uvs, const colour_t *colours, u32 vtx_count, const u32 *indices, u32 idx_count);
+void uvFreeMesh(mesh_t mesh);
+// scaled, rotated (radians, clockwise) around its origin, moved to position and multiplied by tint.
+// it uses the current texture, its uvs are relative to it like for the other primitives
+void uvDrawMesh(mesh_t mesh, vec2 position, float rotation, vec2 scale, colour_t tint);
+
+// TrueType fonts (glyf outlines, kerning from the kern table), rasterized at pixel_size: the
+// distance from the highest ascender to the lowest descender. glyphs are rasterized the first
+// time they are drawn, and kept while there's room for them (see uv_options_t.glyph_atlas_size).
+// a font belongs to the context that loaded it, fragments can't draw text
+font_t uvLoadFont(const char *filename, float pixel_size);
+font_t uvLoadFontFromMemory(const u8 *buffer, size_t buflen, float pixel_size);
+void uvFreeFont(font_t font);
+// utf-8 text with its top left at position, '\n' starts a new line. the layout of the last
+// strings is cached and every glyph of a string is drawn in the same batch
+void uvDrawText(font_t font, const char *text, vec2 position, colour_t colour);
+// size of the box uvDrawText would fill
+vec2 uvMeasureText(font_t font, const char *text);
 
 void uvSetTexture(texture_t texture);
 void uvClearTexture(void);
+// lower layers are drawn first, every frame starts on layer 0. only used in deferred mode
+void uvSetLayer(u16 layer);
+u16 uvGetLayer(void);
+// turns uv_options_t.cull on or off, from the next primitive
+void uvSetCulling(bool enabled);
+// primitives culled since the frame started, fragments included
+u32 uvGetCulledCount(void);
+// turns uv_options_t.sdf_shapes on or off, from the next primitive
+void uvSetSdfShapes(bool enabled);
+// only the pixels inside of the rectangle are drawn until the matching uvPopClipRect.
+// a clip rect is always inside of the previous one, every frame starts without any
+void uvPushClipRect(vec2 position, vec2 size);
+void uvPopClipRect(void);
+// the points of everything drawn are transformed, every frame starts with the identity.
+// each call applies before the ones already made, angles are radians clockwise
+void uvPushTransform(void);
+void uvPopTransform(void);
+void uvTranslate(vec2 offset);
+void uvRotate(float angle);
+void uvScale(vec2 scale);
 // void uvDrawVertices(vertex_t *vertices, u32 count);
 // void uvDrawIndices(vertex_t *vertices, u32 vtx_count, index_t *indices, u32 idx_count);
 void uvDrawLine(vec2 start, vec2 end, float thichness, colour_t colour);
 void uvDrawLineBezier(vec2 start, vec2 end, float thickness, colour_t colour);
 void uvDrawLineBezierQuad(vec2 start, vec2 end, vec2 control_point, float thickness, colour_t colour);
 void uvDrawLineBeziercubic(vec2 start, vec2 end, vec2 start_control, vec2 end_control, float thickness, colour_t colour);
+// angles are in radians, clockwise from the x axis. with segments 0 their number is picked from
+// the size on screen (see uv_options_t.tess_tolerance), otherwise it's how many the arc has at
+// least. the current texture is mapped on the bounding box of the whole circle
 void uvDrawCircle(vec2 centre, float radius, colour_t colour);
 void uvDrawCircleEx(vec2 centre, float radius, colour_t colour, uint segments);
 void uvDrawArc(vec2 centre, float radius, float start_angle, float end_angle, uint segments, colour_t colour);
+// the outline of the arc, thickness is centred on the radius
 void uvDrawArcLines(vec2 centre, float radius, float start_angle, float end_angle, uint segments, colour_t colour, float thickness);
 void uvDrawRing(vec2 centre, float inner_radius, float outer_radius, float start_angle, float end_angle, uint segments, colour_t colour);
 void uvDrawQuad(vec2 position, vec2 size, colour_t colour);
+// radians, clockwise around the centre of the quad
 void uvDrawQuadRot(vec2 position, vec2 size, colour_t colour, float rotation);
 void uvDrawQuadLines(vec2 position, vec2 size, colour_t colour, float rotation, float thickness);
+// roundness goes from 0 (sharp corners) to 1 (the shorter side is a half circle), segments are
+// for each corner. rotated clockwise around the centre of the quad like sprites
 void uvDrawQuadRounded(vec2 position, vec2 size, colour_t colour, float rotation, float roundness, uint segments);
 void uvDrawQuadRoundedLines(vec2 position, vec2 size, colour_t colour, float rotation, float roundness, uint segments, float thickness);
 void uvDrawTriangle(vec2 v1, vec2 v2, vec2 v3, colour_t colour);
 void uvDrawTriangleLines(vec2 v1, vec2 v2, vec2 v3, colour_t colour, float thickness);
+// a single strip through all the points, with the thickness centred on them. consecutive
+// segments share their vertices, about 2 per point with miter joins. uvDrawQuadLines and
+// uvDrawTriangleLines are closed polylines with miter joins
+void uvDrawPolyline(const vec2 *points, u32 count, float thickness, colour_t colour, uv_line_join_e join, uv_line_cap_e cap);
+
+// same as calling uvDrawQuad/uvDrawLine/uvDrawTriangle for each element, but much faster
+void uvDrawQuads(const uv_quad_t *quads, u32 count);
+void uvDrawLines(const uv_line_t *lines, u32 count);
+void uvDrawTriangles(const uv_triangle_t *triangles, u32 count);
+// one instance per sprite, backends without instancing get 4 vertices and 6 indices each
+void uvDrawSprites(const uv_sprite_t *sprites, u32 count);
 
 // void gfxDrawSprite(gfx_t *ctx);
 
+// == CONTEXT ============================================================================
+
+// all the state of the functions above lives in a context, they use the default one.
+// more contexts can be used at the same time (e.g. an offscreen renderer next to the window),
+// each one from a single thread at a time. textures and meshes belong to the context that
+// created them. the default context can be cleaned up but not destroyed
+typedef struct uv_context_t uv_context_t;
+
+uv_context_t *uvCreateContext(void);
+void uvDestroyContext(uv_context_t *ctx);
+uv_context_t *uvGetDefaultContext(void);
+
+// a fragment records primitives for its context, so other threads can draw with the uvCtx
+// functions without locking (one thread per fragment). the context's uvEndFrame draws its own
+// primitives first, then the ones of each fragment in the order they were created.
+// fragments start every frame in the context's uvIsOpen, recording has to be done before its
+// uvEndFrame. they only draw: textures and meshes are created with the context, and the
+// fragments are destroyed with it
+uv_context_t *uvCreateFragment(void);
+uv_context_t *uvCtxCreateFragment(uv_context_t *ctx);
+
+void uvCtxCreateWindow(uv_context_t *ctx, const char *name, int width, int height, const uv_options_t *options);
+void uvCtxCloseWindow(uv_context_t *ctx);
+void uvCtxCleanup(uv_context_t *ctx);
+bool uvCtxIsOpen(uv_context_t *ctx);
+vec2i uvCtxGetWindowSize(uv_context_t *ctx);
+float uvCtxGetDeltaTime(uv_context_t *ctx);
+
+void uvCtxSetClearColour(uv_context_t *ctx, colour_t colour);
+void uvCtxEndFrame(uv_context_t *ctx);
+bool uvCtxReadPixelsAsync(uv_context_t *ctx);
+bool uvCtxPollReadPixels(uv_context_t *ctx, image_t *image);
+
+bool uvCtxIsKeyDown(uv_context_t *ctx, int key);
+bool uvCtxIsKeyUp(uv_context_t *ctx, int key);
+bool uvCtxIsKeyPressed(uv_context_t *ctx, int key);
+bool uvCtxIsMouseDown(uv_context_t *ctx, int mouse);
+bool uvCtxIsMouseUp(uv_context_t *ctx, int mouse);
+vec2i uvCtxGetMousePos(uv_context_t *ctx);
+vec2i uvCtxGetMousePosRel(uv_context_t *ctx);
+float uvCtxGetMouseWheel(uv_context_t *ctx);
+
+texture_t uvCtxLoadTexture(uv_context_t *ctx, const char *filename);
+texture_t uvCtxLoadTextureFromImage(uv_context_t *ctx, const image_t *img);
+void uvCtxFreeTexture(uv_context_t *ctx, texture_t texture);
+texture_t uvCtxCreateRenderTexture(uv_context_t *ctx, u32 width, u32 height);
+void uvCtxBeginRenderTexture(uv_context_t *ctx, texture_t target, colour_t clear_colour);
+void uvCtxEndRenderTexture(uv_context_t *ctx);
+
+mesh_t uvCtxCreateMesh(uv_context_t *ctx, const vec2 *positions, const vec2 *uvs, const colour_t *colours, u32 vtx_count, const u32 *indices, u32 idx_count);
+void uvCtxFreeMesh(uv_context_t *ctx, mesh_t mesh);
+void uvCtxDrawMesh(uv_context_t *ctx, mesh_t mesh, vec2 position, float rotation, vec2 scale, colour_t tint);
+
+font_t uvCtxLoadFont(uv_context_t *ctx, const char *filename, float pixel_size);
+font_t uvCtxLoadFontFromMemory(uv_context_t *ctx, const u8 *buffer, size_t buflen, float pixel_size);
+void uvCtxFreeFont(uv_context_t *ctx, font_t font);
+// asserts with a fragment (and does nothing in release builds), text is drawn with the context
+// that loaded the font
+void uvCtxDrawText(uv_context_t *ctx, font_t font, const char *text, vec2 position, colour_t colour);
+
+void uvCtxSetTexture(uv_context_t *ctx, texture_t texture);
+void uvCtxClearTexture(uv_context_t *ctx);
+void uvCtxSetLayer(uv_context_t *ctx, u16 layer);
+u16 uvCtxGetLayer(uv_context_t *ctx);
+void uvCtxSetCulling(uv_context_t *ctx, bool enabled);
+u32 uvCtxGetCulledCount(uv_context_t *ctx);
+void uvCtxSetSdfShapes(uv_context_t *ctx, bool enabled);
+void uvCtxPushClipRect(uv_context_t *ctx, vec2 position, vec2 size);
+void uvCtxPopClipRect(uv_context_t *ctx);
+void uvCtxPushTransform(uv_context_t *ctx);
+void uvCtxPopTransform(uv_context_t *ctx);
+void uvCtxTranslate(uv_context_t *ctx, vec2 offset);
+void uvCtxRotate(uv_context_t *ctx, float angle);
+void uvCtxScale(uv_context_t *ctx, vec2 scale);
+void uvCtxDrawLine(uv_context_t *ctx, vec2 start, vec2 end, float thickness, colour_t colour);
+void uvCtxDrawLineBezier(uv_context_t *ctx, vec2 start, vec2 end, float thickness, colour_t colour);
+void uvCtxDrawLineBezierQuad(uv_context_t *ctx, vec2 start, vec2 end, vec2 control_point, float thickness, colour_t colour);
+void uvCtxDrawLineBeziercubic(uv_context_t *ctx, vec2 start, vec2 end, vec2 start_control, vec2 end_control, float thickness, colour_t colour);
+void uvCtxDrawCircle(uv_context_t *ctx, vec2 centre, float radius, colour_t colour);
+void uvCtxDrawCircleEx(uv_context_t *ctx, vec2 centre, float radius, colour_t colour, uint segments);
+void uvCtxDrawArc(uv_context_t *ctx, vec2 centre, float radius, float start_angle, float end_angle, uint segments, colour_t colour);
+void uvCtxDrawArcLines(uv_context_t *ctx, vec2 centre, float radius, float start_angle, float end_angle, uint segments, colour_t colour, float thickness);
+void uvCtxDrawRing(uv_context_t *ctx, vec2 centre, float inner_radius, float outer_radius, float start_angle, float end_angle, uint segments, colour_t colour);
+void uvCtxDrawQuad(uv_context_t *ctx, vec2 position, vec2 size, colour_t colour);
+void uvCtxDrawQuadRot(uv_context_t *ctx, vec2 position, vec2 size, colour_t colour, float rotation);
+void uvCtxDrawQuadLines(uv_context_t *ctx, vec2 position, vec2 size, colour_t colour, float rotation, float thickness);
+void uvCtxDrawQuadRounded(uv_context_t *ctx, vec2 position, vec2 size, colour_t colour, float rotation, float roundness, uint segments);
+void uvCtxDrawQuadRoundedLines(uv_context_t *ctx, vec2 position, vec2 size, colour_t colour, float rotation, float roundness, uint segments, float thickness);
+void uvCtxDrawTriangle(uv_context_t *ctx, vec2 v1, vec2 v2, vec2 v3, colour_t colour);
+void uvCtxDrawTriangleLines(uv_context_t *ctx, vec2 v1, vec2 v2, vec2 v3, colour_t colour, float thickness);
+void uvCtxDrawPolyline(uv_context_t *ctx, const vec2 *points, u32 count, float thickness, colour_t colour, uv_line_join_e join, uv_line_cap_e cap);
+
+void uvCtxDrawQuads(uv_context_t *ctx, const uv_quad_t *quads, u32 count);
+void uvCtxDrawLines(uv_context_t *ctx, const uv_line_t *lines, u32 count);
+void uvCtxDrawTriangles(uv_context_t *ctx, const uv_triangle_t *triangles, u32 count);
+void uvCtxDrawSprites(uv_context_t *ctx, const uv_sprite_t *sprites, u32 count);
+
 // == USEFUL MATH STUFF ==================================================================
 
 #define v2(x, y)       (vec2){ x, y }
@@ -302,46 +564,226 @@ enum Keys {
 	UV_KEY__COUNT,
 };
 
+// == BACKEND ==========================================================================
+
+// define one of these to choose a backend, otherwise the platform default is used
+// -> UV_BACKEND_D3D11: win32 window + direct3d 11 renderer (default on windows)
+// -> UV_BACKEND_SOFT:  headless window + multi-threaded software rasterizer (default everywhere else)
+// -> UV_BACKEND_NULL:  headless window, draw data is only counted and checksummed
+#if !defined(UV_BACKEND_D3D11) && !defined(UV_BACKEND_SOFT) && !defined(UV_BACKEND_NULL)
+    #ifdef _WIN32
+        #define UV_BACKEND_D3D11
+    #else
+        #define UV_BACKEND_SOFT
+    #endif
+#endif
+
+#ifdef UV_BACKEND_SOFT
+image_t uvSoftGetFramebuffer(void);
+image_t uvCtxSoftGetFramebuffer(uv_context_t *ctx);
+#endif
+
+#ifdef UV_BACKEND_NULL
+typedef struct {
+    u64 frames;
+    // uv_drawdata_t drawn to a render texture, they aren't frames
+    u64 target_draws;
+    u64 batches;
+    u64 vertices;
+    u64 indices;
+    u64 instances;
+    u64 mesh_draws;
+    // frames that were the same as the previous one (uv_options_t.skip_unchanged)
+    u64 skipped;
+    u64 bytes;
+    u64 checksum;
+} uv_null_stats_t;
+
+uv_null_stats_t uvNullGetStats(void);
+void uvNullResetStats(void);
+uv_null_stats_t uvCtxNullGetStats(uv_context_t *ctx);
+void uvCtxNullResetStats(uv_context_t *ctx);
+#endif
+
 #ifdef ULIVO_BACKEND_DATA
+
+// vertex format, these must be defined the same way for the frontend and the backend
+// -> UV_PACKED_VERTEX: colour is stored as RGBA8 (20 bytes per vertex instead of 32)
+// -> UV_PACKED_UV:     uvs are stored as 16 bit normalized values, so they must be in [0, 1]
+// -> UV_TEXTURE_SLOTS: 8 or 16, a batch can use that many textures at once and every vertex
+//                      gets the slot of the one it samples (4 more bytes per vertex)
+#ifndef UV_TEXTURE_SLOTS
+#define UV_TEXTURE_SLOTS 1
+#endif
+
+#if UV_TEXTURE_SLOTS != 1 && UV_TEXTURE_SLOTS != 8 && UV_TEXTURE_SLOTS != 16
+#error "UV_TEXTURE_SLOTS must be 1, 8 or 16"
+#endif
+
+// staging buffers for uvReadPixelsAsync, the most copies that can be in flight at once
+#ifndef UV_READBACK_SLOTS
+#define UV_READBACK_SLOTS 3
+#endif
+
 typedef struct {
     vec2 pos;
+#ifdef UV_PACKED_UV
+    u16 uv[2];
+#else
     vec2 uv;
+#endif
+#ifdef UV_PACKED_VERTEX
+    u32 col;
+#else
     colour_t col;
+#endif
+#if UV_TEXTURE_SLOTS > 1
+    // index in the batch's textures, the same for all vertices of a triangle
+    u32 slot;
+#endif
 } uv_vertex_t;
 
 typedef u32 uv_index_t;
 
+// a sprite from uvDrawSprites, the backend expands it to a quad.
+// uv is already inside of the batch's texture (e.g. the atlas page)
+typedef struct {
+    vec2 pos;
+    vec2 size;
+    float rotation;
+    // with UV_CAP_SHAPES, when radius >= 0: a box of size with corners rounded by radius, or
+    // only a band of thickness inside of its border when thickness isn't 0. the edges are
+    // anti-aliased, so the quad is a pixel bigger on every side (uv stays on size).
+    // sprites have radius -1
+    float radius;
+    float thickness;
+    vec4 uv;
+#ifdef UV_PACKED_VERTEX
+    u32 col;
+#else
+    colour_t col;
+#endif
+#if UV_TEXTURE_SLOTS > 1
+    u32 slot;
+#endif
+} uv_instance_t;
+
+// one uvDrawMesh
+typedef struct {
+    // as returned by uv__backend_create_mesh
+    mesh_t mesh;
+    // x' = m[0]*x + m[1]*y + m[2], y' = m[3]*x + m[4]*y + m[5]
+    float transform[6];
+    // the mesh's uvs are mapped to this rectangle of the texture, like uvGetTextureUV
+    vec4 uv;
+    colour_t tint;
+} uv_mesh_draw_t;
+
+// what the backend supports, returned by uv__backend_get_caps
+enum {
+    UV_CAP_INDEX_U16 = 1 << 0,
+    UV_CAP_INDEX_U32 = 1 << 1,
+    // draws batches of uv_instance_t, otherwise sprites are expanded on the cpu
+    UV_CAP_INSTANCES = 1 << 2,
+    // only draws inside of uv_batch_t.clip. otherwise the frontend clips the quads and
+    // drops what is entirely outside, anything else that crosses the clip rect is drawn whole
+    UV_CAP_SCISSOR = 1 << 3,
+    // evaluates uv_instance_t.radius and thickness, needs UV_CAP_INSTANCES
+    UV_CAP_SHAPES = 1 << 4,
+    // has uv__backend_create_render_texture and uv__backend_set_target
+    UV_CAP_RENDER_TEXTURES = 1 << 5,
+    // has uv__backend_read_pixels, uv__backend_poll_pixels and uv__backend_get_pixels
+    UV_CAP_READBACK = 1 << 6,
+};
+
+// indices in a batch are relative to vtx_start, backends pass it as the base vertex.
+// a batch with inst_count draws that many instances from inst_start and nothing else,
+// the same for mesh_count and the mesh draws from mesh_start (their vertices use slot 0)
 typedef struct {
     u32 vtx_start, vtx_count;
     u32 idx_start, idx_count;
+    u32 inst_start, inst_count;
+    u32 mesh_start, mesh_count;
+    // as returned by uv__backend_load_texture
     texture_t texture;
+#if UV_TEXTURE_SLOTS > 1
+    // textures picked by the vertices' slot, textures[0] is always the same as texture
+    texture_t textures[UV_TEXTURE_SLOTS];
+    u32 texture_count;
+#endif
+    // scissor in pixels, xy: top left, zw: bottom right (exclusive). always inside of the
+    // window, it's all of it unless a clip rect was pushed
+    vec4i clip;
 } uv_batch_t;
 
-typedef struct {
+// a frame can be split in more than one uv_drawdata_t, linked with next.
+// batch offsets are always relative to their own uv_drawdata_t.
+// indices are u16 (index_size == 2) unless a single batch needs more than 65536 vertices
+typedef struct uv_drawdata_t {
     uv_batch_t *batches;
     u32 batch_count;
     uv_vertex_t *vertices;
-    uv_index_t *indices;
+    void *indices;
+    u32 index_size;
     u32 vtx_count;
     u32 idx_count;
+    uv_instance_t *instances;
+    u32 inst_count;
+    uv_mesh_draw_t *meshes;
+    u32 mesh_count;
+    // only on the first uv_drawdata_t of a frame: the whole frame is the same as the
+    // previous one, textures and meshes included (see uv_options_t.skip_unchanged)
+    bool unchanged;
+    struct uv_drawdata_t *next;
 } uv_drawdata_t;
 
-extern void *uv__backend_create_window(const char *name, int width, int height);
+// every window and gfx belongs to one context: the window reports its events to ctx with
+// the uvCtx callbacks below, the frontend passes the gfx from uv__backend_init_gfx back to
+// every other gfx function. there is no state shared between them
+extern void *uv__backend_create_window(uv_context_t *ctx, const char *name, int width, int height);
 extern void uv__backend_destroy_window(void *win_data);
 
 extern bool uv__backend_poll_input(void *win_data);
 extern float uv__backend_get_delta_time(void *win_data);
 
-extern void uv__backend_init_gfx(void);
-extern void uv__backend_cleanup_gfx(void);
-extern void uv__backend_resize_gfx(int new_width, int new_height);
-extern void uv__backend_draw(colour_t colour, uv_drawdata_t *data);
-extern texture_t uv__backend_load_texture(const image_t *image);
-extern void uv__backend_free_texture(texture_t texture);
+extern void *uv__backend_init_gfx(void *win_data, int width, int height);
+extern u32 uv__backend_get_caps(void *gfx);
+extern void uv__backend_cleanup_gfx(void *gfx);
+extern void uv__backend_resize_gfx(void *gfx, int new_width, int new_height);
+extern void uv__backend_draw(void *gfx, colour_t colour, uv_drawdata_t *data);
+extern texture_t uv__backend_load_texture(void *gfx, const image_t *image);
+extern void uv__backend_free_texture(void *gfx, texture_t texture);
+// copies image in the texture, with its top left corner at x, y
+extern void uv__backend_update_texture(void *gfx, texture_t texture, const image_t *image, u32 x, u32 y);
+// a texture like the ones of uv__backend_load_texture (transparent black) that can be a target
+extern texture_t uv__backend_create_render_texture(void *gfx, u32 width, u32 height);
+// uv__backend_draw draws to target instead of the window until it's set back to 0.
+// nothing is presented while there's a target
+extern void uv__backend_set_target(void *gfx, texture_t target);
+// the window's pixels drawn by the next uv__backend_draw (unchanged or not) are copied to the
+// staging buffer slot, which is < UV_READBACK_SLOTS. nothing waits for the copy
+extern void uv__backend_read_pixels(void *gfx, u32 slot);
+// true once the copy to slot is done, with the size of its pixels. doesn't wait either
+extern bool uv__backend_poll_pixels(void *gfx, u32 slot, u32 *width, u32 *height);
+// after uv__backend_poll_pixels returned true: copies the pixels of slot (RGBA8, rows of
+// width * 4 bytes) and makes the slot free again
+extern void uv__backend_get_pixels(void *gfx, u32 slot, u8 *pixels);
+// the mesh is immutable, index_size is 2 or 4
+extern mesh_t uv__backend_create_mesh(void *gfx, const uv_vertex_t *vertices, u32 vtx_count, const void *indices, u32 index_size, u32 idx_count);
+// draws the mesh draws of a batch with mesh_count, called by uv__backend_draw
+extern void uv__backend_draw_mesh(void *gfx, const uv_drawdata_t *list, const uv_batch_t *batch);
+extern void uv__backend_free_mesh(void *gfx, mesh_t mesh);
 
 void uvOnWindowResize(int new_width, int new_height);
 void uvSetKeyState(int key, bool state);
 void uvSetMouseState(int btn, bool state);
 void uvSetMousePosition(vec2i position);
 
+void uvCtxOnWindowResize(uv_context_t *ctx, int new_width, int new_height);
+void uvCtxSetKeyState(uv_context_t *ctx, int key, bool state);
+void uvCtxSetMouseState(uv_context_t *ctx, int btn, bool state);
+void uvCtxSetMousePosition(uv_context_t *ctx, vec2i position);
+// gfx of the context, as returned by uv__backend_init_gfx
+void *uv__context_gfx(uv_context_t *ctx);
+
 #endif
\ No newline at end of file
@@ -0,0 +1,285 @@
+/* Text rasterizer test
+ * Draws glyphs with the soft backend and checks the coverage they leave in its framebuffer.
+ * The first part loads a small font built here, with a compound glyph whose second component
+ * is placed by matching its points to the first one, and another with the same components
+ * placed by an offset: both have to draw the same pixels. A compound glyph that uses its
+ * components 16 times on 8 levels, a square 16^8 times, has to be left empty without
+ * rasterizing them all.
+ * The second part rasterizes a real TrueType font: every printable ASCII and Latin-1
+ * character has to draw something, and nothing outside of the box uvMeasureText gives it.
+ * Build with the soft backend, e.g.
+ *     cc -O2 -Isrc -Ilibs/colla/colla tests/uv_text_test.c src/ulivo.c src/backend/uv_backend_soft.c \
+ *        libs/colla/colla/jobpool.c libs/colla/colla/cthreads.c libs/colla/colla/tracelog.c -lpthread -lm
+ * usage: uv_text_test font.ttf
+ */
+
+#include "ulivo.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define TEST_WIDTH  256
+#define TEST_HEIGHT 128
+
+typedef struct {
+    u8 data[2048];
+    u32 len;
+} test_buf_t;
+
+static int failures = 0;
+
+static void testCheck(bool ok, const char *what) {
+    printf("%s %s\n", ok ? "ok  " : "FAIL", what);
+    if (!ok) failures++;
+}
+
+static void bufU16(test_buf_t *b, u32 v) {
+    b->data[b->len++] = (u8)(v >> 8);
+    b->data[b->len++] = (u8)v;
+}
+
+static void bufU32(test_buf_t *b, u32 v) {
+    bufU16(b, v >> 16);
+    bufU16(b, v & 0xffff);
+}
+
+static void bufU8(test_buf_t *b, u32 v) {
+    b->data[b->len++] = (u8)v;
+}
+
+// -- synthetic font --
+
+// glyph 1 is a 500 units square, 'A' maps to glyph 1, 'B' to 2 and so on
+static void fontSquare(test_buf_t *g) {
+    bufU16(g, 1);
+    bufU16(g, 0); bufU16(g, 0); bufU16(g, 500); bufU16(g, 500);
+    bufU16(g, 3);
+    bufU16(g, 0);
+    // on curve, the coordinates are 16 bit deltas
+    for (int i = 0; i < 4; ++i) bufU8(g, 1);
+    bufU16(g, 0); bufU16(g, 500); bufU16(g, 0); bufU16(g, (u16)-500);
+    bufU16(g, 0); bufU16(g, 0); bufU16(g, 500); bufU16(g, 0);
+}
+
+// two squares on the diagonal, the second one placed by its first point on the third of the first
+static void fontMatched(test_buf_t *g) {
+    bufU16(g, (u16)-1);
+    bufU16(g, 0); bufU16(g, 0); bufU16(g, 1000); bufU16(g, 1000);
+    // more components and xy values, byte arguments
+    bufU16(g, 0x22); bufU16(g, 1); bufU8(g, 0); bufU8(g, 0);
+    // point numbers
+    bufU16(g, 0x00); bufU16(g, 1); bufU8(g, 2); bufU8(g, 0);
+}
+
+// the same squares, placed with an offset
+static void fontOffset(test_buf_t *g) {
+    bufU16(g, (u16)-1);
+    bufU16(g, 0); bufU16(g, 0); bufU16(g, 1000); bufU16(g, 1000);
+    bufU16(g, 0x22); bufU16(g, 1); bufU8(g, 0); bufU8(g, 0);
+    // xy values, word arguments
+    bufU16(g, 0x03); bufU16(g, 1); bufU16(g, 500); bufU16(g, 500);
+}
+
+// the next glyph 16 times
+static void fontFanout(test_buf_t *g, u32 next) {
+    bufU16(g, (u16)-1);
+    bufU16(g, 0); bufU16(g, 0); bufU16(g, 500); bufU16(g, 500);
+    for (int i = 0; i < 16; ++i) {
+        bufU16(g, i < 15 ? 0x22 : 0x02); bufU16(g, next); bufU8(g, 0); bufU8(g, 0);
+    }
+}
+
+static u32 fontBuild(u8 *out) {
+    test_buf_t glyf = {0};
+    u32 offsets[13] = {0};
+    // glyph 0 is empty
+    offsets[1] = glyf.len;
+    fontSquare(&glyf);
+    offsets[2] = glyf.len;
+    fontMatched(&glyf);
+    offsets[3] = glyf.len;
+    fontOffset(&glyf);
+    // 'D' to 'K' fan out down to the square
+    for (u32 i = 4; i < 12; ++i) {
+        offsets[i] = glyf.len;
+        fontFanout(&glyf, i < 11 ? i + 1 : 1);
+    }
+    offsets[12] = glyf.len;
+    u32 glyph_count = 12;
+
+    test_buf_t head = {0};
+    for (int i = 0; i < 50; ++i) bufU8(&head, 0);
+    // long loca
+    bufU16(&head, 1);
+    bufU16(&head, 0);
+
+    test_buf_t hhea = {0};
+    bufU32(&hhea, 0x00010000);
+    bufU16(&hhea, 1000); bufU16(&hhea, 0); bufU16(&hhea, 0);
+    for (int i = 0; i < 24; ++i) bufU8(&hhea, 0);
+    bufU16(&hhea, glyph_count);
+
+    test_buf_t maxp = {0};
+    bufU32(&maxp, 0x00005000);
+    bufU16(&maxp, glyph_count);
+
+    test_buf_t hmtx = {0};
+    for (u32 i = 0; i < glyph_count; ++i) {
+        bufU16(&hmtx, 1100);
+        bufU16(&hmtx, 0);
+    }
+
+    test_buf_t loca = {0};
+    for (u32 i = 0; i <= glyph_count; ++i) bufU32(&loca, offsets[i]);
+
+    // format 12 with one group, 'A' onwards
+    test_buf_t cmap = {0};
+    bufU16(&cmap, 0); bufU16(&cmap, 1);
+    bufU16(&cmap, 3); bufU16(&cmap, 10); bufU32(&cmap, 12);
+    bufU16(&cmap, 12); bufU16(&cmap, 0); bufU32(&cmap, 28); bufU32(&cmap, 0); bufU32(&cmap, 1);
+    bufU32(&cmap, 'A'); bufU32(&cmap, 'A' + glyph_count - 2); bufU32(&cmap, 1);
+
+    struct { const char *tag; test_buf_t *buf; } tables[] = {
+        { "cmap", &cmap }, { "glyf", &glyf }, { "head", &head }, { "hhea", &hhea },
+        { "hmtx", &hmtx }, { "loca", &loca }, { "maxp", &maxp },
+    };
+    u32 table_count = sizeof(tables) / sizeof(*tables);
+
+    test_buf_t dir = {0};
+    bufU32(&dir, 0x00010000);
+    bufU16(&dir, table_count);
+    bufU16(&dir, 0); bufU16(&dir, 0); bufU16(&dir, 0);
+
+    u32 at = 12 + table_count * 16;
+    for (u32 i = 0; i < table_count; ++i) {
+        const char *tag = tables[i].tag;
+        bufU32(&dir, (u32)tag[0] << 24 | (u32)tag[1] << 16 | (u32)tag[2] << 8 | (u32)tag[3]);
+        bufU32(&dir, 0);
+        bufU32(&dir, at);
+        bufU32(&dir, tables[i].buf->len);
+        at += (tables[i].buf->len + 3) & ~3u;
+    }
+
+    memcpy(out, dir.data, dir.len);
+    u32 len = dir.len;
+    for (u32 i = 0; i < table_count; ++i) {
+        memset(out + len, 0, (tables[i].buf->len + 3) & ~3u);
+        memcpy(out + len, tables[i].buf->data, tables[i].buf->len);
+        len += (tables[i].buf->len + 3) & ~3u;
+    }
+    return len;
+}
+
+// -- drawing --
+
+// draws the text alone and counts the lit pixels, and the ones outside of the box
+static u32 testDraw(font_t font, const char *text, vec2 pos, vec2 box, u32 *outside, u8 *copy) {
+    uvIsOpen();
+    uvSetClearColour(v4(0, 0, 0, 1));
+    uvDrawText(font, text, pos, UV_WHITE);
+    uvEndFrame();
+
+    image_t fb = uvSoftGetFramebuffer();
+    u32 lit = 0, out = 0;
+    for (u32 y = 0; y < fb.height; ++y) {
+        for (u32 x = 0; x < fb.width; ++x) {
+            u8 g = fb.data[(y * fb.width + x) * 4 + 1];
+            if (g < 16) continue;
+            lit++;
+            // a pixel of slack for the rounding of the pen
+            bool inside = (float)x + 1.f >= pos.x && (float)x <= pos.x + box.x + 1.f &&
+                          (float)y + 1.f >= pos.y && (float)y <= pos.y + box.y + 1.f;
+            if (!inside) out++;
+        }
+    }
+    if (outside) *outside = out;
+    if (copy) memcpy(copy, fb.data, fb.width * fb.height * 4);
+    return lit;
+}
+
+static void testSynthetic(void) {
+    static u8 data[4096];
+    u32 len = fontBuild(data);
+    font_t font = uvLoadFontFromMemory(data, len, 40.f);
+    testCheck(font != 0, "synthetic font loads");
+    if (!font) return;
+
+    static u8 matched[TEST_WIDTH * TEST_HEIGHT * 4];
+    static u8 offset[TEST_WIDTH * TEST_HEIGHT * 4];
+    u32 square = testDraw(font, "A", v2(10, 10), v2(0, 0), NULL, NULL);
+    u32 lit_matched = testDraw(font, "B", v2(10, 10), v2(0, 0), NULL, matched);
+    u32 lit_offset = testDraw(font, "C", v2(10, 10), v2(0, 0), NULL, offset);
+
+    testCheck(square >= 380 && square <= 460, "square is 20x20 pixels");
+    testCheck(lit_offset >= square * 2 - 40, "offset components don't overlap");
+    testCheck(lit_matched == lit_offset && memcmp(matched, offset, sizeof(matched)) == 0, "matched points place the component like its offset");
+
+    u32 fanout = testDraw(font, "D", v2(10, 10), v2(0, 0), NULL, NULL);
+    testCheck(fanout == 0, "too many components leave the glyph empty");
+    u32 leaf = testDraw(font, "K", v2(10, 10), v2(0, 0), NULL, NULL);
+    testCheck(leaf == square, "a few components are still drawn");
+
+    uvFreeFont(font);
+}
+
+static void testRealFont(const char *filename) {
+    font_t font = uvLoadFont(filename, 24.f);
+    testCheck(font != 0, "font loads");
+    if (!font) return;
+
+    u32 empty = 0, escaped = 0;
+    char text[8];
+    // printable ASCII and Latin-1, the accented letters are compound glyphs in most fonts
+    for (u32 c = 33; c < 256; ++c) {
+        if (c >= 127 && c < 161) continue;
+        if (c == 173) continue;
+        if (c < 128) {
+            text[0] = (char)c;
+            text[1] = 0;
+        }
+        else {
+            text[0] = (char)(0xc0 | c >> 6);
+            text[1] = (char)(0x80 | (c & 0x3f));
+            text[2] = 0;
+        }
+
+        vec2 box = uvMeasureText(font, text);
+        u32 outside = 0;
+        u32 lit = testDraw(font, text, v2(20, 20), box, &outside, NULL);
+        if (!lit) {
+            printf("     U+%04X draws nothing\n", c);
+            empty++;
+        }
+        if (outside) {
+            printf("     U+%04X has %u pixels outside of its box\n", c, outside);
+            escaped++;
+        }
+    }
+    testCheck(empty == 0, "every character draws something");
+    testCheck(escaped == 0, "nothing is drawn outside of the measured box");
+
+    u32 e = testDraw(font, "e", v2(20, 20), v2(0, 0), NULL, NULL);
+    u32 e_acute = testDraw(font, "\xc3\xa9", v2(20, 20), v2(0, 0), NULL, NULL);
+    testCheck(e_acute > e, "e acute is e and its accent");
+
+    vec2 size = uvMeasureText(font, "Hello\nWorld");
+    testCheck(size.y >= 2.f * 24.f, "a new line moves down a line");
+
+    uvFreeFont(font);
+}
+
+int main(int argc, char **argv) {
+    if (argc < 2) {
+        fprintf(stderr, "usage: uv_text_test font.ttf\n");
+        return 1;
+    }
+
+    uvCreateWindow("ulivo text test", TEST_WIDTH, TEST_HEIGHT, NULL);
+    testSynthetic();
+    testRealFont(argv[1]);
+    uvCleanup();
+
+    printf("%s\n", failures ? "FAILED" : "passed");
+    return failures ? 1 : 0;
+}